@@ -1,6 +1,15 @@
+#define _GNU_SOURCE  // fallocate, mremap
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
 
 // ---------------------------------------------------
 // 📌 Чтение текстового файла построчно
@@ -93,6 +102,431 @@ long file_size(const char *path) {
     return size;
 }
 
+// ---------------------------------------------------
+// 📌 Файл записей фиксированного размера через mmap
+// ---------------------------------------------------
+// save_records/load_records: fread по одной записи = вызов libc и копия на запись.
+// RecFile: заголовок (magic, version, count, record_size) + массив записей,
+// отображённый в память. Чтение без копий, append с предвыделением через fallocate,
+// параллельный проход по диапазонам и отсортированный индекс для поиска за O(log n).
+#define RECFILE_MAGIC 0x46434552u  // "RECF"
+#define RECFILE_VERSION 1
+#define RECFILE_HEADER_SIZE 64     // Записи начинаются с выровненного смещения
+#define RECFILE_GROW_MIN (1u << 20)
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t count;  // Обновляется ПОСЛЕ записи данных - обрыв не даёт мусорных записей
+} RecFileHeader;
+
+typedef struct {
+    int fd;
+    int writable;
+    unsigned char *map;
+    size_t map_size;  // = размер файла (включая предвыделенный хвост)
+    size_t record_size;
+} RecFile;
+
+static RecFileHeader *recfile_header(const RecFile *rf) {
+    return (RecFileHeader *)rf->map;
+}
+
+size_t recfile_count(const RecFile *rf) {
+    return (size_t)recfile_header(rf)->count;
+}
+
+const void *recfile_get(const RecFile *rf, size_t index) {
+    if (index >= recfile_count(rf)) {
+        return NULL;
+    }
+    return rf->map + RECFILE_HEADER_SIZE + index * rf->record_size;
+}
+
+static int recfile_map(RecFile *rf, size_t size) {
+    int prot = PROT_READ | (rf->writable ? PROT_WRITE : 0);
+    void *map = rf->map ? mremap(rf->map, rf->map_size, size, MREMAP_MAYMOVE)
+                        : mmap(NULL, size, prot, MAP_SHARED, rf->fd, 0);
+    if (map == MAP_FAILED) {
+        perror(rf->map ? "mremap" : "mmap");
+        return -1;
+    }
+    rf->map = map;
+    rf->map_size = size;
+    return 0;
+}
+
+int recfile_create(RecFile *rf, const char *path, size_t record_size) {
+    memset(rf, 0, sizeof(*rf));
+    rf->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (rf->fd < 0) {
+        perror("open");
+        return -1;
+    }
+    rf->writable = 1;
+    rf->record_size = record_size;
+
+    RecFileHeader header = {
+        .magic = RECFILE_MAGIC,
+        .version = RECFILE_VERSION,
+        .header_size = RECFILE_HEADER_SIZE,
+        .record_size = (uint32_t)record_size,
+        .count = 0,
+    };
+    if (ftruncate(rf->fd, RECFILE_HEADER_SIZE) != 0 ||
+        pwrite(rf->fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+        perror("recfile_create");
+        close(rf->fd);
+        return -1;
+    }
+    return recfile_map(rf, RECFILE_HEADER_SIZE);
+}
+
+int recfile_open(RecFile *rf, const char *path, int writable) {
+    memset(rf, 0, sizeof(*rf));
+    rf->fd = open(path, writable ? O_RDWR : O_RDONLY);
+    if (rf->fd < 0) {
+        perror("open");
+        return -1;
+    }
+    rf->writable = writable;
+
+    struct stat st;  // Размер без fseek/ftell
+    if (fstat(rf->fd, &st) != 0 || (size_t)st.st_size < RECFILE_HEADER_SIZE) {
+        fprintf(stderr, "recfile_open: %s: too small\n", path);
+        close(rf->fd);
+        return -1;
+    }
+    if (recfile_map(rf, (size_t)st.st_size) != 0) {
+        close(rf->fd);
+        return -1;
+    }
+
+    const RecFileHeader *h = recfile_header(rf);
+    if (h->magic != RECFILE_MAGIC || h->version != RECFILE_VERSION ||
+        h->header_size != RECFILE_HEADER_SIZE || h->record_size == 0 ||
+        h->count > (rf->map_size - RECFILE_HEADER_SIZE) / h->record_size) {
+        fprintf(stderr, "recfile_open: %s: bad header\n", path);
+        munmap(rf->map, rf->map_size);
+        close(rf->fd);
+        return -1;
+    }
+    rf->record_size = h->record_size;
+    madvise(rf->map, rf->map_size, MADV_SEQUENTIAL);
+    return 0;
+}
+
+// Рост файла крупными шагами: fallocate резервирует блоки заранее
+// (нет фрагментации и SIGBUS при записи в отображение на полном диске)
+static int recfile_reserve(RecFile *rf, size_t records) {
+    size_t need = RECFILE_HEADER_SIZE + records * rf->record_size;
+    if (need <= rf->map_size) {
+        return 0;
+    }
+    size_t size = rf->map_size * 2;
+    if (size < need) {
+        size = need;
+    }
+    if (size < RECFILE_GROW_MIN) {
+        size = RECFILE_GROW_MIN;
+    }
+    if (fallocate(rf->fd, 0, 0, (off_t)size) != 0) {
+        perror("fallocate");
+        return -1;
+    }
+    return recfile_map(rf, size);
+}
+
+int recfile_append(RecFile *rf, const void *records, size_t count) {
+    if (!rf->writable) {
+        return -1;
+    }
+    size_t have = recfile_count(rf);
+    if (recfile_reserve(rf, have + count) != 0) {
+        return -1;
+    }
+    memcpy(rf->map + RECFILE_HEADER_SIZE + have * rf->record_size, records, count * rf->record_size);
+    __atomic_store_n(&recfile_header(rf)->count, (uint64_t)(have + count), __ATOMIC_RELEASE);
+    return 0;
+}
+
+// Обрезаем предвыделенный хвост, чтобы файл занимал ровно header + count записей
+int recfile_close(RecFile *rf) {
+    int rc = 0;
+    size_t used = RECFILE_HEADER_SIZE + recfile_count(rf) * rf->record_size;
+    if (rf->writable) {
+        if (msync(rf->map, rf->map_size, MS_SYNC) != 0) {
+            perror("msync");
+            rc = -1;
+        }
+    }
+    munmap(rf->map, rf->map_size);
+    if (rf->writable && ftruncate(rf->fd, (off_t)used) != 0) {
+        perror("ftruncate");
+        rc = -1;
+    }
+    close(rf->fd);
+    rf->map = NULL;
+    return rc;
+}
+
+// Параллельный проход: файл делится на threads диапазонов,
+// fn(first, n, ctx) получает свой ctx (массив ctxs с шагом ctx_size)
+typedef void (*RecFileScanFn)(const void *first, size_t n, size_t record_size, void *ctx);
+
+typedef struct {
+    const unsigned char *first;
+    size_t n;
+    size_t record_size;
+    RecFileScanFn fn;
+    void *ctx;
+    int started;
+} RecFileScanTask;
+
+static void *recfile_scan_worker(void *arg) {
+    RecFileScanTask *task = arg;
+    task->fn(task->first, task->n, task->record_size, task->ctx);
+    return NULL;
+}
+
+int recfile_scan_parallel(const RecFile *rf, size_t threads, RecFileScanFn fn, void *ctxs, size_t ctx_size) {
+    size_t count = recfile_count(rf);
+    if (threads == 0) {
+        threads = 1;
+    }
+    pthread_t *ids = calloc(threads, sizeof(pthread_t));
+    RecFileScanTask *tasks = calloc(threads, sizeof(RecFileScanTask));
+    if (!ids || !tasks) {
+        free(ids);
+        free(tasks);
+        return -1;
+    }
+
+    int rc = 0;
+    for (size_t t = 0; t < threads; ++t) {
+        size_t begin = count * t / threads;
+        size_t end = count * (t + 1) / threads;
+        tasks[t] = (RecFileScanTask){
+            .first = rf->map + RECFILE_HEADER_SIZE + begin * rf->record_size,
+            .n = end - begin,
+            .record_size = rf->record_size,
+            .fn = fn,
+            .ctx = (unsigned char *)ctxs + t * ctx_size,
+        };
+        if (t + 1 == threads) {
+            recfile_scan_worker(&tasks[t]);  // Последний диапазон - в текущем потоке
+        } else if (pthread_create(&ids[t], NULL, recfile_scan_worker, &tasks[t]) == 0) {
+            tasks[t].started = 1;
+        } else {
+            perror("pthread_create");
+            recfile_scan_worker(&tasks[t]);  // Не удалось - считаем сами
+            rc = -1;
+        }
+    }
+    for (size_t t = 0; t + 1 < threads; ++t) {
+        if (tasks[t].started) {
+            pthread_join(ids[t], NULL);
+        }
+    }
+    free(ids);
+    free(tasks);
+    return rc;
+}
+
+// Отсортированный индекс ключ → номер записи; поиск бинарный
+typedef struct {
+    int64_t key;
+    uint64_t index;
+} RecIndexEntry;
+
+typedef struct {
+    RecIndexEntry *entries;
+    size_t count;
+} RecIndex;
+
+typedef int64_t (*RecKeyFn)(const void *record);
+
+static int rec_index_compare(const void *a, const void *b) {
+    const RecIndexEntry *x = a;
+    const RecIndexEntry *y = b;
+    if (x->key != y->key) {
+        return x->key < y->key ? -1 : 1;
+    }
+    return x->index < y->index ? -1 : (x->index > y->index);  // Стабильно: первая по порядку
+}
+
+int recfile_build_index(const RecFile *rf, RecKeyFn key_of, RecIndex *index) {
+    size_t count = recfile_count(rf);
+    index->entries = malloc((count ? count : 1) * sizeof(RecIndexEntry));
+    if (!index->entries) {
+        return -1;
+    }
+    index->count = count;
+    for (size_t i = 0; i < count; ++i) {
+        index->entries[i] = (RecIndexEntry){.key = key_of(recfile_get(rf, i)), .index = i};
+    }
+    qsort(index->entries, count, sizeof(RecIndexEntry), rec_index_compare);
+    return 0;
+}
+
+// Первая запись с данным ключом или NULL
+const void *recfile_find(const RecFile *rf, const RecIndex *index, int64_t key) {
+    size_t lo = 0;
+    size_t hi = index->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (index->entries[mid].key < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == index->count || index->entries[lo].key != key) {
+        return NULL;
+    }
+    return recfile_get(rf, (size_t)index->entries[lo].index);
+}
+
+void rec_index_free(RecIndex *index) {
+    free(index->entries);
+    index->entries = NULL;
+    index->count = 0;
+}
+
+// ---------------------------------------------------
+// 📌 RecFile: использование и сравнение с fread
+// ---------------------------------------------------
+static int64_t record_key(const void *record) {
+    return ((const Record *)record)->id;
+}
+
+typedef struct {
+    double sum;
+    char pad[64 - sizeof(double)];  // Свой cache line на поток - без false sharing
+} ScanSum;
+
+static void sum_values(const void *first, size_t n, size_t record_size, void *ctx) {
+    const Record *records = first;  // record_size == sizeof(Record)
+    (void)record_size;
+    double sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += records[i].value;
+    }
+    ((ScanSum *)ctx)->sum = sum;
+}
+
+static double elapsed_ms(struct timespec start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start.tv_sec) * 1e3 + (double)(now.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+void recfile_example(void) {
+    RecFile rf;
+    if (recfile_create(&rf, "records.rec", sizeof(Record)) != 0) {
+        return;
+    }
+    Record batch[] = {{.id = 30, .value = 3.0}, {.id = 10, .value = 1.0}, {.id = 20, .value = 2.0}};
+    recfile_append(&rf, batch, 3);
+    recfile_close(&rf);
+
+    if (recfile_open(&rf, "records.rec", 0) != 0) {
+        return;
+    }
+    RecIndex index;
+    if (recfile_build_index(&rf, record_key, &index) == 0) {
+        const Record *found = recfile_find(&rf, &index, 20);
+        printf("recfile: %zu records, id=20 -> %.2f\n", recfile_count(&rf), found ? found->value : -1.0);
+        rec_index_free(&index);
+    }
+    recfile_close(&rf);
+    remove("records.rec");
+}
+
+void recfile_benchmark(size_t count) {
+    Record *records = malloc(count * sizeof(Record));
+    if (!records) {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        records[i] = (Record){.id = (int)(count - i), .value = (double)(i % 100)};
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    save_records("bench.bin", records, count);
+    printf("fwrite:          %8.1f ms\n", elapsed_ms(start));
+
+    // Append по 4096 записей: fallocate растит файл шагами, а не на каждый вызов
+    RecFile rf;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (recfile_create(&rf, "bench.rec", sizeof(Record)) != 0) {
+        free(records);
+        return;
+    }
+    for (size_t i = 0; i < count; i += 4096) {
+        size_t n = count - i < 4096 ? count - i : 4096;
+        recfile_append(&rf, records + i, n);
+    }
+    recfile_close(&rf);
+    printf("recfile_append:  %8.1f ms (вместе с msync)\n", elapsed_ms(start));
+
+    // Базовая линия: цикл fread по одной записи (как в load_records, без printf)
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    double fread_sum = 0;
+    FILE *file = fopen("bench.bin", "rb");
+    if (file) {
+        Record record;
+        while (fread(&record, sizeof(record), 1, file) == 1) {
+            fread_sum += record.value;
+        }
+        fclose(file);
+    }
+    printf("fread loop:      %8.1f ms (sum %.0f)\n", elapsed_ms(start), fread_sum);
+
+    if (recfile_open(&rf, "bench.rec", 0) == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        size_t threads_list[] = {1, cpus > 1 ? (size_t)cpus : 1};
+        for (size_t k = 0; k < 2; ++k) {
+            size_t threads = threads_list[k];
+            if (k == 1 && threads == 1) {
+                break;
+            }
+            ScanSum *sums = calloc(threads, sizeof(ScanSum));
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            recfile_scan_parallel(&rf, threads, sum_values, sums, sizeof(ScanSum));
+            double sum = 0;
+            for (size_t t = 0; t < threads; ++t) {
+                sum += sums[t].sum;
+            }
+            printf("mmap scan x%-3zu   %8.1f ms (sum %.0f)\n", threads, elapsed_ms(start), sum);
+            free(sums);
+        }
+
+        RecIndex index;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        recfile_build_index(&rf, record_key, &index);
+        printf("build index:     %8.1f ms\n", elapsed_ms(start));
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        size_t hits = 0;
+        for (size_t i = 0; i < 1000000; ++i) {
+            hits += recfile_find(&rf, &index, (int64_t)(i % count) + 1) != NULL;
+        }
+        printf("1M lookups:      %8.1f ms (%zu hits)\n", elapsed_ms(start), hits);
+
+        rec_index_free(&index);
+        recfile_close(&rf);
+    }
+
+    remove("bench.bin");
+    remove("bench.rec");
+    free(records);
+}
+
 int main(void) {
     write_report("report.txt", "Metrics", "CPU usage: 15%\nMemory: 128MB");
     read_lines("report.txt");
@@ -107,5 +541,8 @@ int main(void) {
     long size = file_size("data.bin");
     printf("data.bin size: %ld bytes\n", size);
 
+    recfile_example();
+    recfile_benchmark(5 * 1000 * 1000);
+
     return 0;
 }
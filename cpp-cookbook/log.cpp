@@ -104,6 +104,8 @@ void example_test_data() {
 // ---------------------------------------------------
 // 📌 Запись логов в файл
 // ---------------------------------------------------
+// Открытие файла и форматирование на каждый вызов - только для редких событий;
+// для горячих путей см. AsyncLogger в cpp-modern/testing_debugging.cpp
 void example_file_log() {
     std::ofstream logFile("app.log", std::ios::app);
     if (logFile.is_open()) {
@@ -401,6 +401,7 @@ void timed_worker(int id) {
 // PRODUCER-CONSUMER с condition_variable
 // ────────────────────────────────────────────────────────────────────────────────────
 
+// Ограниченные lock-free варианты для hot path - ring::SpscRing/MpmcRing ниже
 class ThreadSafeQueue {
 private:
     mutable std::mutex mutex_;
@@ -523,6 +524,582 @@ void good_wait_example() {
     // Гарантированно ready == true
 }
 
+// ════════════════════════════════════════════════════════════════════════════════════
+// 📌 LOCK-FREE RING QUEUES - SPSC / MPMC / BLOCKING
+// ════════════════════════════════════════════════════════════════════════════════════
+
+/*
+ * ThreadSafeQueue выше: только int, std::queue (аллокации чанков deque),
+ * один мьютекс на всех и condition_variable на каждый push.
+ *
+ * Ограниченные кольца фиксированной ёмкости (степень двойки), без аллокаций
+ * после конструктора:
+ *
+ * SpscRing<T>   - один producer, один consumer. head/tail на разных cache line,
+ *                 каждая сторона кэширует чужой индекс и читает его только
+ *                 когда кольцо "кажется" полным/пустым
+ * MpmcRing<T>   - Vyukov: у каждой ячейки sequence, producer'ы и consumer'ы
+ *                 занимают позиции CAS'ом по head/tail, не мешая друг другу
+ * BlockingRing  - обёртка над любым из них: сначала короткий спин,
+ *                 потом засыпание на std::atomic::wait (futex), будят только
+ *                 если кто-то действительно спит
+ *
+ * push_n/pop_n - пачкой: один CAS (MPMC) или одна публикация индекса (SPSC)
+ * на несколько элементов.
+ */
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace ring {
+
+inline constexpr size_t CACHE_LINE = 64;
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// Сырая ячейка под T: конструируем при push, разрушаем при pop
+template<typename T>
+struct Storage {
+    alignas(T) std::byte bytes[sizeof(T)];
+
+    template<typename U>
+    void construct(U&& value) { new (bytes) T(std::forward<U>(value)); }
+
+    T take() {
+        T* p = std::launder(reinterpret_cast<T*>(bytes));
+        T value = std::move(*p);
+        p->~T();
+        return value;
+    }
+};
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// SpscRing: один producer + один consumer
+// ────────────────────────────────────────────────────────────────────────────────────
+
+template<typename T>
+class SpscRing {
+    const size_t mask_;
+    std::unique_ptr<Storage<T>[]> slots_;
+
+    // Сторона producer'а
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
+
+    // Сторона consumer'а
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
+
+public:
+    using value_type = T;
+
+    explicit SpscRing(size_t capacity)
+        : mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+          slots_(std::make_unique<Storage<T>[]>(mask_ + 1)) {}
+
+    ~SpscRing() {
+        T value;
+        while (try_pop(value)) {}
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    template<typename U>
+    bool try_push(U&& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - cached_tail_ > mask_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head - cached_tail_ > mask_) return false;   // Полон
+        }
+        slots_[head & mask_].construct(std::forward<U>(value));
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cached_head_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail == cached_head_) return false;   // Пуст
+        }
+        out = slots_[tail & mask_].take();
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Сколько влезло - столько и положили; индекс публикуется один раз
+    template<typename It>
+    size_t push_n(It first, size_t n) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t free = capacity() - (head - cached_tail_);
+        if (free < n) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            free = capacity() - (head - cached_tail_);
+        }
+        n = std::min(n, free);
+        for (size_t i = 0; i < n; ++i, ++first) {
+            slots_[(head + i) & mask_].construct(*first);
+        }
+        if (n) head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    template<typename OutIt>
+    size_t pop_n(OutIt out, size_t max) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t available = cached_head_ - tail;
+        if (available < max) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            available = cached_head_ - tail;
+        }
+        size_t n = std::min(max, available);
+        for (size_t i = 0; i < n; ++i) {
+            *out++ = slots_[(tail + i) & mask_].take();
+        }
+        if (n) tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+};
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// MpmcRing: Vyukov bounded queue
+// ────────────────────────────────────────────────────────────────────────────────────
+
+/*
+ * sequence ячейки i на круге k:
+ *   == pos       - свободна, её может занять producer с позицией pos
+ *   == pos + 1   - заполнена, её может забрать consumer с позицией pos
+ * Пачка: проверяем подряд идущие ячейки и занимаем их одним CAS.
+ * Ячейки [pos, pos + n) после CAS принадлежат только нам: чужой producer
+ * туда уже не попадёт (head ушёл дальше), consumer - пока не опубликуем.
+ */
+template<typename T>
+class MpmcRing {
+    struct alignas(CACHE_LINE) Cell {
+        std::atomic<size_t> sequence;
+        Storage<T> storage;
+    };
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0};   // Следующая позиция для push
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0};   // Следующая позиция для pop
+
+    // Сколько ячеек подряд от pos в нужном состоянии (offset: 0 - свободна, 1 - заполнена)
+    size_t ready_run(size_t pos, size_t max, size_t offset) const {
+        size_t n = 0;
+        while (n < max &&
+               cells_[(pos + n) & mask_].sequence.load(std::memory_order_acquire) == pos + n + offset) {
+            ++n;
+        }
+        return n;
+    }
+
+public:
+    using value_type = T;
+
+    explicit MpmcRing(size_t capacity)
+        : mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+          cells_(std::make_unique<Cell[]>(mask_ + 1)) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpmcRing() {
+        T value;
+        while (try_pop(value)) {}
+    }
+
+    MpmcRing(const MpmcRing&) = delete;
+    MpmcRing& operator=(const MpmcRing&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    template<typename U>
+    bool try_push(U&& value) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(seq) - intptr_t(pos);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.storage.construct(std::forward<U>(value));
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // Полон
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(T& out) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(seq) - intptr_t(pos + 1);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = cell.storage.take();
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // Пуст
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template<typename It>
+    size_t push_n(It first, size_t n) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        size_t run;
+        do {
+            run = ready_run(pos, n, 0);
+            if (run == 0) {
+                // Первая ячейка занята: либо кольцо полно, либо head устарел
+                size_t seq = cells_[pos & mask_].sequence.load(std::memory_order_acquire);
+                if (intptr_t(seq) - intptr_t(pos) < 0) return 0;
+                pos = head_.load(std::memory_order_relaxed);
+                continue;
+            }
+        } while (run == 0 || !head_.compare_exchange_weak(pos, pos + run, std::memory_order_relaxed));
+
+        for (size_t i = 0; i < run; ++i, ++first) {
+            Cell& cell = cells_[(pos + i) & mask_];
+            cell.storage.construct(*first);
+            cell.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        return run;
+    }
+
+    template<typename OutIt>
+    size_t pop_n(OutIt out, size_t max) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        size_t run;
+        do {
+            run = ready_run(pos, max, 1);
+            if (run == 0) {
+                size_t seq = cells_[pos & mask_].sequence.load(std::memory_order_acquire);
+                if (intptr_t(seq) - intptr_t(pos + 1) < 0) return 0;
+                pos = tail_.load(std::memory_order_relaxed);
+                continue;
+            }
+        } while (run == 0 || !tail_.compare_exchange_weak(pos, pos + run, std::memory_order_relaxed));
+
+        for (size_t i = 0; i < run; ++i) {
+            Cell& cell = cells_[(pos + i) & mask_];
+            *out++ = cell.storage.take();
+            cell.sequence.store(pos + i + mask_ + 1, std::memory_order_release);
+        }
+        return run;
+    }
+};
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// BlockingRing: спин → atomic::wait
+// ────────────────────────────────────────────────────────────────────────────────────
+
+/*
+ * Ожидание - eventcount на одном 32-битном слове (futex):
+ * младший бит = "кто-то спит", остальные - номер эпохи.
+ * Засыпающий: выставить бит → fence → ещё одна попытка → wait(epoch).
+ * Будящий:    операция над кольцом → fence → бит стоит? сбросить,
+ *             сдвинуть эпоху и notify_all - один syscall на эпизод сна,
+ *             а не на каждый push. Никто не спит - ни RMW, ни futex.
+ */
+template<typename Ring>
+class BlockingRing {
+public:
+    using T = typename Ring::value_type;
+
+private:
+    // На одном ядре спин только мешает тому, кого мы ждём
+    static int spin_limit() {
+        static const int limit = std::thread::hardware_concurrency() > 1 ? 128 : 0;
+        return limit;
+    }
+
+    struct alignas(CACHE_LINE) WaitPoint {
+        std::atomic<uint32_t> epoch{0};
+
+        void notify() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            uint32_t current = epoch.load(std::memory_order_relaxed);
+            if ((current & 1) == 0) return;
+            if (epoch.compare_exchange_strong(current, (current + 2) & ~1u)) {
+                epoch.notify_all();
+            }
+        }
+
+        void notify_all() {
+            epoch.fetch_add(2);
+            epoch.notify_all();
+        }
+
+        // Ждать, пока attempt() не вернёт true (или stop() не скажет "хватит")
+        template<typename Attempt, typename Stop>
+        bool wait_until(Attempt&& attempt, Stop&& stop) {
+            for (int spin = 0; spin < spin_limit(); ++spin) {
+                if (attempt()) return true;
+                cpu_relax();
+            }
+            while (true) {
+                uint32_t seen = epoch.fetch_or(1) | 1;
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (attempt()) return true;
+                if (stop()) return attempt();   // Последний шанс после close()
+                epoch.wait(seen);
+            }
+        }
+    };
+
+    Ring ring_;
+    WaitPoint not_empty_;   // Здесь спят consumer'ы
+    WaitPoint not_full_;    // Здесь спят producer'ы
+    std::atomic<bool> closed_{false};
+
+public:
+    explicit BlockingRing(size_t capacity) : ring_(capacity) {}
+
+    Ring& ring() { return ring_; }
+
+    template<typename U>
+    bool try_push(U&& value) {
+        if (!ring_.try_push(std::forward<U>(value))) return false;
+        not_empty_.notify();
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        if (!ring_.try_pop(out)) return false;
+        not_full_.notify();
+        return true;
+    }
+
+    // false - очередь закрыта
+    template<typename U>
+    bool push(U&& value) {
+        return not_full_.wait_until(
+            [&] { return !closed() && try_push(std::forward<U>(value)); },
+            [&] { return closed(); });
+    }
+
+    // false - очередь закрыта и пуста
+    bool pop(T& out) {
+        return not_empty_.wait_until(
+            [&] { return try_pop(out); },
+            [&] { return closed(); });
+    }
+
+    // Кладёт все n (может уснуть посередине); возвращает, сколько успел до close()
+    template<typename It>
+    size_t push_n(It first, size_t n) {
+        size_t done = 0;
+        while (done < n) {
+            bool ok = not_full_.wait_until(
+                [&] {
+                    if (closed()) return false;
+                    size_t pushed = ring_.push_n(first, n - done);
+                    std::advance(first, pushed);
+                    done += pushed;
+                    return pushed != 0;
+                },
+                [&] { return closed(); });
+            if (!ok) break;
+            not_empty_.notify();
+        }
+        return done;
+    }
+
+    // Ждёт хотя бы один элемент, забирает до max; 0 - закрыта и пуста
+    template<typename OutIt>
+    size_t pop_n(OutIt out, size_t max) {
+        size_t taken = 0;
+        not_empty_.wait_until(
+            [&] { return (taken = ring_.pop_n(out, max)) != 0; },
+            [&] { return closed(); });
+        if (taken) not_full_.notify();
+        return taken;
+    }
+
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+};
+
+} // namespace ring
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Бенчмарк: ThreadSafeQueue vs кольца
+// ────────────────────────────────────────────────────────────────────────────────────
+
+/*
+ * Пропускная способность: N producer'ов / N consumer'ов, 1..32.
+ * Латентность: ping-pong между двумя потоками через пару очередей,
+ * p50/p99 времени круга.
+ */
+
+#include <algorithm>
+#include <numeric>
+
+template<typename Push, typename Pop, typename Finish>
+double queue_throughput(int threads, int items_per_producer, Push push, Pop pop, Finish finish) {
+    std::atomic<int64_t> consumed_sum{0};
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> consumers;
+        for (int c = 0; c < threads; ++c) {
+            consumers.emplace_back([&] {
+                int64_t local = 0;
+                int value;
+                while (pop(value)) local += value;
+                consumed_sum.fetch_add(local, std::memory_order_relaxed);
+            });
+        }
+        {
+            std::vector<std::jthread> producers;
+            for (int p = 0; p < threads; ++p) {
+                producers.emplace_back([&] {
+                    for (int i = 1; i <= items_per_producer; ++i) push(i);
+                });
+            }
+        }   // join producers
+        finish();
+    }   // join consumers
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int64_t expected = int64_t(threads) * items_per_producer * (items_per_producer + 1) / 2;
+    if (consumed_sum.load() != expected) std::cout << "  LOST ITEMS!\n";
+    return double(threads) * items_per_producer / seconds / 1e6;
+}
+
+template<typename Queue>
+void queue_pingpong(const char* name, int rounds) {
+    Queue ping(64);
+    Queue pong(64);
+    std::vector<int64_t> samples;
+    samples.reserve(rounds);
+
+    std::jthread echo([&] {
+        int value = 0;
+        for (int i = 0; i < rounds; ++i) {
+            ping.pop(value);
+            pong.push(value);
+        }
+    });
+
+    int value = 0;
+    for (int i = 0; i < rounds; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        ping.push(i);
+        pong.pop(value);
+        samples.push_back((std::chrono::steady_clock::now() - start) / 1ns);
+    }
+
+    std::sort(samples.begin(), samples.end());
+    std::cout << name << " round-trip: p50 " << samples[samples.size() / 2]
+              << " ns, p99 " << samples[samples.size() * 99 / 100] << " ns\n";
+}
+
+// ThreadSafeQueue с тем же интерфейсом для ping-pong (ёмкость не ограничена)
+struct CvQueueAdapter {
+    ThreadSafeQueue queue;
+    explicit CvQueueAdapter(size_t) {}
+    void push(int value) { queue.push(value); }
+    bool pop(int& value) { return queue.pop(value); }
+};
+
+void ring_queue_benchmark() {
+    constexpr int total_items = 2'000'000;
+    constexpr size_t capacity = 4096;
+    constexpr size_t batch = 32;
+
+    std::cout << "threads(P=C)  ThreadSafeQueue  BlockingRing<Mpmc>  Mpmc push_n/pop_n   [M items/s]\n";
+    for (int threads : {1, 2, 4, 8, 16, 32}) {
+        int per_producer = total_items / threads;
+
+        ThreadSafeQueue cv_queue;
+        double cv = queue_throughput(threads, per_producer,
+            [&](int v) { cv_queue.push(v); },
+            [&](int& v) { return cv_queue.pop(v); },
+            [&] { cv_queue.finish(); });
+
+        ring::BlockingRing<ring::MpmcRing<int>> mpmc(capacity);
+        double lock_free = queue_throughput(threads, per_producer,
+            [&](int v) { mpmc.push(v); },
+            [&](int& v) { return mpmc.pop(v); },
+            [&] { mpmc.close(); });
+
+        // Пачки: producer копит batch значений, consumer разбирает локальный буфер
+        ring::BlockingRing<ring::MpmcRing<int>> batched(capacity);
+        struct Batch {
+            std::array<int, batch> items{};
+            size_t size = 0;
+            size_t next = 0;
+        };
+        double batch_rate = queue_throughput(threads, per_producer,
+            [&](int v) {
+                thread_local Batch out;
+                out.items[out.size++] = v;
+                if (out.size == batch || v == per_producer) {   // v == per_producer - последний
+                    batched.push_n(out.items.begin(), out.size);
+                    out.size = 0;
+                }
+            },
+            [&](int& v) {
+                thread_local Batch in;
+                if (in.next == in.size) {
+                    in.size = batched.pop_n(in.items.begin(), batch);
+                    in.next = 0;
+                    if (in.size == 0) return false;
+                }
+                v = in.items[in.next++];
+                return true;
+            },
+            [&] { batched.close(); });
+
+        std::cout << "    " << threads << "\t\t" << cv << "\t\t" << lock_free << "\t\t" << batch_rate << '\n';
+    }
+
+    // SPSC: 1 producer + 1 consumer, без CAS вовсе
+    ring::BlockingRing<ring::SpscRing<int>> spsc(capacity);
+    double spsc_rate = queue_throughput(1, total_items,
+        [&](int v) { spsc.push(v); },
+        [&](int& v) { return spsc.pop(v); },
+        [&] { spsc.close(); });
+    std::cout << "SPSC 1:1: " << spsc_rate << " M items/s\n";
+
+    queue_pingpong<CvQueueAdapter>("ThreadSafeQueue", 20'000);
+    queue_pingpong<ring::BlockingRing<ring::MpmcRing<int>>>("BlockingRing<Mpmc>", 20'000);
+    queue_pingpong<ring::BlockingRing<ring::SpscRing<int>>>("BlockingRing<Spsc>", 20'000);
+}
+
+ring_queue_benchmark();
+
 // ════════════════════════════════════════════════════════════════════════════════════
 // 📌 SEMAPHORES (C++20) - ОГРАНИЧЕНИЕ ДОСТУПА
 // ════════════════════════════════════════════════════════════════════════════════════
@@ -1007,6 +1584,12 @@ public:
             stop_ = true;
         }
         cv_.notify_all();
+        
+        // join здесь, а не в ~jthread: workers_ объявлен первым и разрушается
+        // последним - уже после cv_/queue_mutex_/tasks_, которые потоки ещё используют
+        for (auto& worker : workers_) {
+            worker.join();
+        }
     }
 };
 
@@ -1020,102 +1603,1507 @@ for (int i = 0; i < 8; ++i) {
         pool.enqueue([i] {
             std::cout << \"Task \" << i << \"\\n\";\n            std::this_thread::sleep_for(100ms);\n            return i * i;\n        })\n    );\n}\n\nfor (auto& res : pool_results) {\n    std::cout << \"Result: \" << res.get() << '\\n';\n}\n\n// ════════════════════════════════════════════════════════════════════════════════════\n// 📌 std::osyncstream (C++20) - СИНХРОНИЗИРОВАННЫЙ ВЫВОД\n// ════════════════════════════════════════════════════════════════════════════════════\n\n/*\n * std::osyncstream - атомарный вывод в std::cout без перемешивания\n * \n * ❌ БЕЗ osyncstream:\n * Thread 1Thread 2: output\n * : output  ← Перемешано!\n * \n * ✅ С osyncstream:\n * Thread 1: output\n * Thread 2: output  ← Атомарно!\n */\n\nauto sync_worker = [](int id) {\n    std::osyncstream(std::cout) << \"Thread \" << id << \" output\\n\";\n    // Весь вывод атомарен, не перемешается с другими потоками\n};\n\nstd::jthread sync_t1(sync_worker, 1);\nstd::jthread sync_t2(sync_worker, 2);\n\n/*\n * ════════════════════════════════════════════════════════════════════════════════════\n * 🎯 BEST PRACTICES - ЛУЧШИЕ ПРАКТИКИ МНОГОПОТОЧНОСТИ\n * ════════════════════════════════════════════════════════════════════════════════════\n * \n * 1️⃣  Предпочитайте std::jthread вместо std::thread\n *     ✓ Автоматический join в деструкторе\n *     ✓ Встроенная поддержка stop_token\n *     → Нет риска забыть join/detach\n * \n * 2️⃣  ВСЕГДА используйте RAII locks\n *     ✓ std::lock_guard для простых случаев\n *     ✓ std::unique_lock когда нужна гибкость\n *     ✓ std::scoped_lock для НЕСКОЛЬКИХ мьютексов\n *     ❌ НИКОГДА не вызывайте mutex.lock()/unlock() вручную\n * \n * 3️⃣  std::scoped_lock для множественных мьютексов\n *     ✓ Автоматически предотвращает deadlock\n *     ✓ Атомарная блокировка всех мьютексов\n *     → Порядок блокировки не важен\n * \n * 4️⃣  Предпочитайте message passing вместо shared state\n *     ✓ ThreadSafeQueue вместо shared переменных\n *     ✓ Меньше синхронизации → меньше ошибок\n *     → \"Don't communicate by sharing memory, share memory by communicating\"\n * \n * 5️⃣  Используйте atomic для ПРОСТЫХ операций\n *     ✓ Счетчики, флаги\n *     ✓ Lock-free → быстрее\n *     ❌ Для сложных операций → используйте mutex\n * \n * 6️⃣  Минимизируйте критические секции\n *     ✓ Держите lock минимальное время\n *     ✓ Выносите медленные операции ЗА пределы lock\n *     → Меньше contention → лучше производительность\n * \n * 7️⃣  ПРОФИЛИРУЙТЕ перед оптимизацией\n *     - Измеряйте реальную производительность\n *     - Bottleneck часто не там где вы думаете\n *     → \"Premature optimization is the root of all evil\"\n * \n * 8️⃣  ТЕСТИРУЙТЕ с ThreadSanitizer (TSan)\n *     Компиляция: g++ -fsanitize=thread -g program.cpp\n *     ✓ Находит data races\n *     ✓ Находит deadlocks\n *     ✓ Находит использование после освобождения\n *     → Используйте ВСЕГДА для многопоточного кода!\n * \n * 9️⃣  Используйте C++20 примитивы\n *     ✓ std::jthread вместо thread\n *     ✓ std::latch/barrier для синхронизации фаз\n *     ✓ std::counting_semaphore для rate limiting\n *     ✓ atomic::wait/notify вместо condition_variable (где подходит)\n *     ✓ std::osyncstream для синхронизированного вывода\n * \n * 🔟 Избегайте recursive_mutex\n *     ⚠️ Обычно признак плохого дизайна\n *     → Лучше переделать архитектуру\n *     → Используйте только если действительно нужен\n * \n * ══════════════════════════════════════════════════════════════════════════════════\n * \n * ДОПОЛНИТЕЛЬНЫЕ РЕКОМЕНДАЦИИ:\n * \n * • const correctness - помогает компилятору найти race conditions\n * • Используйте thread_local для thread-specific данных\n * • Избегайте глобальных переменных\n * • Документируйте threading requirements (какие методы thread-safe)\n * • Рассмотрите lock-free структуры данных для hot paths\n * • Для I/O bound задач рассмотрите async I/O вместо потоков\n * \n * ИНСТРУМЕНТЫ:\n * - Valgrind/Helgrind - для поиска race conditions\n * - ThreadSanitizer (TSan) - лучший инструмент для C++\n * - Intel Inspector - коммерческий инструмент\n * \n * ══════════════════════════════════════════════════════════════════════════════════\n */
 
-// ============================================
-// 📌 LOCK-FREE PROGRAMMING
-// ============================================
+// ════════════════════════════════════════════════════════════════════════════════════
+// 📌 WORK-STEALING SCHEDULER - ЗАДАЧИ, ПРОДОЛЖЕНИЯ, PARALLEL_FOR
+// ════════════════════════════════════════════════════════════════════════════════════
+
+/*
+ * ThreadPool выше на задачу в ~1 мкс тратит больше, чем сама задача:
+ * make_shared<packaged_task> + std::function + std::future (3 аллокации),
+ * один мьютекс и notify_one на каждый enqueue.
+ *
+ * sched::TaskScheduler:
+ * - у каждого worker'а своя Chase-Lev deque: задачи, порождённые внутри пула,
+ *   кладутся к себе без блокировок; простаивающие worker'ы воруют с другого конца
+ *   (та же схема, что WorkStealingExecutor в cpp-web-network/async_io.cpp)
+ * - мьютекс - только у очереди задач, пришедших снаружи пула
+ * - Future<T>: одна аллокация на задачу - общее состояние само и есть задача,
+ *   интрузивный счётчик ссылок, без мьютекса и condition_variable
+ * - then(): продолжение запускается планировщиком, когда значение готово,
+ *   блокирующего get() в цепочке нет
+ * - parallel_for/parallel_reduce: lazy binary splitting - диапазон делится
+ *   пополам, только когда в своей deque пусто (воры её разобрали);
+ *   иначе обрабатываем кусками grain без лишних задач
+ * - деструктор дожидается выполнения всех поставленных задач и join'ит потоки
+ */
+
+#include <cmath>
+#include <deque>
+#include <optional>
+#include <random>
+#include <type_traits>
+#include <variant>
+
+namespace sched {
+
+class TaskScheduler;
+
+// Базовый узел задачи: всё, что кладётся в deque
+struct Job {
+    void (*execute)(Job*) = nullptr;
+};
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Chase-Lev deque фиксированной ёмкости (переполнение - в общую очередь)
+// ────────────────────────────────────────────────────────────────────────────────────
+
+class WorkDeque {
+    static constexpr int64_t CAPACITY = 4096;
+
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    std::unique_ptr<std::atomic<Job*>[]> slots_{new std::atomic<Job*>[CAPACITY]};
 
-// Простой lock-free stack
-template<typename T>
-class LockFreeStack {
-private:
-    struct Node {
-        T data;
-        Node* next;
-        Node(T d) : data(std::move(d)), next(nullptr) {}
-    };
-    
-    std::atomic<Node*> head_{nullptr};
-    
 public:
-    void push(T data) {
-        Node* new_node = new Node(std::move(data));
-        new_node->next = head_.load();
-        
-        // CAS loop - повторяем пока не успешно
-        while (!head_.compare_exchange_weak(new_node->next, new_node)) {
-            // new_node->next обновлен текущим head_, повторяем
-        }
+    // Владелец: false - deque полна
+    bool push(Job* job) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t >= CAPACITY) return false;
+        slots_[b & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+        bottom_.store(b + 1, std::memory_order_release);
+        return true;
     }
-    
-    bool pop(T& result) {
-        Node* old_head = head_.load();
-        
-        while (old_head && 
-               !head_.compare_exchange_weak(old_head, old_head->next)) {
-            // Повторяем если другой поток изменил head
+
+    // Владелец: LIFO
+    Job* pop() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
         }
-        
-        if (!old_head) {
-            return false;  // Стек пуст
+        Job* job = slots_[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (t == b) {
+            // Последний элемент - спор с ворами решает CAS
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
         }
-        
-        result = std::move(old_head->data);
-        delete old_head;  // ВНИМАНИЕ: проблема ABA!
-        return true;
+        return job;
     }
-    
-    ~LockFreeStack() {
-        T dummy;
-        while (pop(dummy)) {}
-    }
-};
 
-// ════════════════════════════════════════════════════════════════════════════════════
-// 📌 STOP TOKENS (C++20) - КООПЕРАТИВНАЯ ОСТАНОВКА
-// ════════════════════════════════════════════════════════════════════════════════════
+    // Кто угодно: FIFO
+    Job* steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
 
-// jthread автоматически предоставляет stop_token
-std::jthread stop_t([](std::stop_token stoken) {
-    int count = 0;
-    while (!stoken.stop_requested()) {
-        std::cout << "Iteration " << count++ << '\n';
-        std::this_thread::sleep_for(100ms);
-        
-        if (count >= 5) break;
+        Job* job = slots_[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
     }
-    
-    if (stoken.stop_requested()) {
-        std::cout << "Stop requested!\n";
+
+    bool empty() const {
+        return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
     }
-});
+};
 
-std::this_thread::sleep_for(250ms);
-stop_t.request_stop();  // Кооперативная остановка
+// ────────────────────────────────────────────────────────────────────────────────────
+// TaskScheduler
+// ────────────────────────────────────────────────────────────────────────────────────
 
-// stop_source и stop_token независимо
-std::stop_source source;
-std::stop_token token = source.get_token();
+template<typename T> class Future;
 
-// Callback при остановке
-std::stop_callback callback(token, [] {
-    std::cout << "Stop callback invoked!\n";
-});
+class TaskScheduler {
+    struct alignas(64) Worker {
+        WorkDeque deque;
+        std::minstd_rand rng;
+    };
 
-source.request_stop();  // Вызовет callback
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
 
-// ════════════════════════════════════════════════════════════════════════════════════
-// 📌 COMMON PATTERNS - ТИПИЧНЫЕ ПАТТЕРНЫ
-// ════════════════════════════════════════════════════════════════════════════════════
+    std::mutex inject_mutex_;
+    std::deque<Job*> injected_;
+    std::atomic<size_t> injected_size_{0};
+
+    // Парковка: eventcount на epoch_, будим только если кто-то спит
+    alignas(64) std::atomic<uint32_t> epoch_{0};
+    std::atomic<int> sleepers_{0};
+    std::atomic<bool> stop_{false};
+
+    static inline thread_local TaskScheduler* tls_owner_ = nullptr;
+    static inline thread_local size_t tls_index_ = 0;
 
-// Thread-safe Singleton (C++11 гарантирует thread-safety)
-class Singleton {
-private:
-    Singleton() = default;
-    
 public:
-    static Singleton& instance() {
-        static Singleton inst;  // ✅ Thread-safe с C++11
-        return inst;
+    explicit TaskScheduler(size_t threads = std::thread::hardware_concurrency()) {
+        threads = std::max<size_t>(1, threads);
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.push_back(std::make_unique<Worker>());
+            workers_.back()->rng.seed(unsigned(i + 1));
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    // Все уже поставленные задачи (и порождённые ими) выполнятся до join
+    ~TaskScheduler() {
+        stop_.store(true);
+        epoch_.fetch_add(1);
+        epoch_.notify_all();
+        for (auto& t : threads_) t.join();
+    }
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    size_t worker_count() const { return workers_.size(); }
+
+    // Индекс worker'а текущего потока или -1, если поток не из этого пула
+    ptrdiff_t current_worker() const { return tls_owner_ == this ? ptrdiff_t(tls_index_) : -1; }
+
+    void schedule(Job* job) {
+        if (tls_owner_ != this || !workers_[tls_index_]->deque.push(job)) {
+            if (stop_.load(std::memory_order_relaxed) && tls_owner_ != this) {
+                throw std::runtime_error("TaskScheduler stopped");
+            }
+            std::lock_guard lock(inject_mutex_);
+            injected_.push_back(job);
+            injected_size_.fetch_add(1, std::memory_order_relaxed);
+        }
+        wake_one();
+    }
+
+    // Без результата: одна аллокация под лямбду
+    template<typename F>
+    void post(F&& f) {
+        struct FnJob : Job {
+            std::decay_t<F> fn;
+            explicit FnJob(F&& f) : fn(std::forward<F>(f)) {
+                execute = [](Job* job) {
+                    auto* self = static_cast<FnJob*>(job);
+                    self->fn();
+                    delete self;
+                };
+            }
+        };
+        auto* job = new FnJob(std::forward<F>(f));
+        try {
+            schedule(job);
+        } catch (...) {
+            delete job;
+            throw;
+        }
+    }
+
+    template<typename F>
+    auto submit(F&& f) -> Future<std::invoke_result_t<std::decay_t<F>&>>;
+
+    // Выполнять задачи, пока done() не станет true (только из worker'а этого пула:
+    // вложенный parallel_for или get() внутри задачи не блокирует поток)
+    template<typename Pred>
+    void help_until(Pred&& done) {
+        size_t self = tls_index_;
+        while (!done()) {
+            if (Job* job = find_task(self)) {
+                job->execute(job);
+            } else {
+                cpu_relax();
+            }
+        }
+    }
+
+    bool local_queue_empty() const {
+        return tls_owner_ != this || workers_[tls_index_]->deque.empty();
+    }
+
+private:
+    void wake_one() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_relaxed) > 0) {
+            epoch_.fetch_add(1, std::memory_order_release);
+            epoch_.notify_one();
+        }
+    }
+
+    Job* take_injected() {
+        if (injected_size_.load(std::memory_order_relaxed) == 0) return nullptr;
+        std::lock_guard lock(inject_mutex_);
+        if (injected_.empty()) return nullptr;
+        Job* job = injected_.front();
+        injected_.pop_front();
+        injected_size_.fetch_sub(1, std::memory_order_relaxed);
+        return job;
+    }
+
+    Job* find_task(size_t self) {
+        if (Job* job = workers_[self]->deque.pop()) return job;
+        if (Job* job = take_injected()) return job;
+
+        size_t n = workers_.size();
+        size_t start = workers_[self]->rng() % n;
+        for (size_t i = 0; i < n; ++i) {
+            size_t victim = (start + i) % n;
+            if (victim == self) continue;
+            if (Job* job = workers_[victim]->deque.steal()) return job;
+        }
+        return nullptr;
+    }
+
+    void worker_loop(size_t self) {
+        tls_owner_ = this;
+        tls_index_ = self;
+
+        while (true) {
+            Job* job = find_task(self);
+            for (int spin = 0; !job && spin < 64; ++spin) {
+                cpu_relax();
+                job = find_task(self);
+            }
+            if (job) {
+                job->execute(job);
+                continue;
+            }
+
+            // Засыпаем: регистрация → перепроверка → wait (пара к fence в wake_one)
+            sleepers_.fetch_add(1, std::memory_order_relaxed);
+            uint32_t epoch = epoch_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            job = find_task(self);
+            bool stopping = stop_.load();
+            if (!job && !stopping) epoch_.wait(epoch, std::memory_order_acquire);
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+
+            if (job) {
+                job->execute(job);
+            } else if (stopping) {
+                return;   // stop + пустой полный обход = работы больше нет
+            }
+        }
+    }
+};
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Future<T>: общее состояние с интрузивным счётчиком ссылок
+// ────────────────────────────────────────────────────────────────────────────────────
+
+/*
+ * continuation_ - единственная точка синхронизации:
+ *   nullptr        - значения нет, продолжения нет
+ *   Job*           - значения нет, then() зарегистрировал продолжение
+ *   READY (1)      - значение (или исключение) опубликовано
+ * Производитель делает exchange(READY) и, если там было продолжение,
+ * отдаёт его планировщику; then() делает CAS nullptr → Job* и, если
+ * проиграл (уже READY), ставит продолжение сам.
+ */
+template<typename T>
+class FutureState : public Job {
+public:
+    using Stored = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    static Job* ready_tag() { return reinterpret_cast<Job*>(uintptr_t(1)); }
+
+    explicit FutureState(TaskScheduler& scheduler, uint32_t refs) : scheduler_(scheduler), refs_(refs) {}
+    virtual ~FutureState() = default;
+
+    void release() {
+        if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+    }
+
+    template<typename F, typename... Args>
+    void complete_with(F& f, Args&&... args) {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                f(std::forward<Args>(args)...);
+                value_.emplace();
+            } else {
+                value_.emplace(f(std::forward<Args>(args)...));
+            }
+        } catch (...) {
+            error_ = std::current_exception();
+        }
+        publish();
+    }
+
+    void fail(std::exception_ptr error) {
+        error_ = std::move(error);
+        publish();
+    }
+
+    bool ready() const { return continuation_.load(std::memory_order_acquire) == ready_tag(); }
+
+    void wait() {
+        if (scheduler_.current_worker() >= 0) {
+            scheduler_.help_until([this] { return ready(); });   // Worker не простаивает
+            return;
+        }
+        for (Job* c = continuation_.load(std::memory_order_acquire); c != ready_tag();
+             c = continuation_.load(std::memory_order_acquire)) {
+            continuation_.wait(c, std::memory_order_acquire);
+        }
+    }
+
+    // false - значение уже готово, продолжение нужно запускать самим
+    bool set_continuation(Job* job) {
+        Job* expected = nullptr;
+        return continuation_.compare_exchange_strong(expected, job, std::memory_order_acq_rel);
+    }
+
+    TaskScheduler& scheduler_;
+    std::optional<Stored> value_;
+    std::exception_ptr error_;
+
+private:
+    void publish() {
+        Job* continuation = continuation_.exchange(ready_tag(), std::memory_order_acq_rel);
+        if (continuation) {
+            scheduler_.schedule(continuation);
+        } else {
+            continuation_.notify_all();
+        }
+    }
+
+    std::atomic<uint32_t> refs_;
+    std::atomic<Job*> continuation_{nullptr};
+};
+
+// submit(): состояние и задача - один объект (ссылки: задача + Future)
+template<typename T, typename F>
+class TaskState final : public FutureState<T> {
+    F fn_;
+
+public:
+    TaskState(TaskScheduler& scheduler, F fn) : FutureState<T>(scheduler, 2), fn_(std::move(fn)) {
+        this->execute = [](Job* job) {
+            auto* self = static_cast<TaskState*>(job);
+            self->complete_with(self->fn_);
+            self->release();
+        };
+    }
+};
+
+// then(): продолжение держит ссылку на родителя до своего запуска
+template<typename T, typename U, typename F>
+class ContinuationState final : public FutureState<T> {
+    F fn_;
+    FutureState<U>* parent_;
+
+public:
+    ContinuationState(TaskScheduler& scheduler, F fn, FutureState<U>* parent)
+        : FutureState<T>(scheduler, 2), fn_(std::move(fn)), parent_(parent) {
+        this->execute = [](Job* job) {
+            auto* self = static_cast<ContinuationState*>(job);
+            FutureState<U>* parent = self->parent_;
+            if (parent->error_) {
+                self->fail(parent->error_);   // Исключение проходит по цепочке мимо fn
+            } else if constexpr (std::is_void_v<U>) {
+                self->complete_with(self->fn_);
+            } else {
+                self->complete_with(self->fn_, std::move(*parent->value_));
+            }
+            parent->release();
+            self->release();
+        };
+    }
+};
+
+// Тип результата f в then(): f(T) или f() для Future<void>
+template<typename F, typename T>
+struct continuation_result {
+    using type = std::invoke_result_t<F&, T>;
+};
+
+template<typename F>
+struct continuation_result<F, void> {
+    using type = std::invoke_result_t<F&>;
+};
+
+template<typename T>
+class Future {
+    FutureState<T>* state_ = nullptr;
+
+public:
+    Future() = default;
+    explicit Future(FutureState<T>* state) : state_(state) {}
+    Future(Future&& other) noexcept : state_(std::exchange(other.state_, nullptr)) {}
+    Future& operator=(Future&& other) noexcept {
+        if (this != &other) {
+            if (state_) state_->release();
+            state_ = std::exchange(other.state_, nullptr);
+        }
+        return *this;
+    }
+    ~Future() {
+        if (state_) state_->release();
+    }
+
+    bool valid() const { return state_ != nullptr; }
+    bool ready() const { return state_->ready(); }
+
+    // Из worker'а пула - выполняет другие задачи, пока ждёт
+    T get() {
+        state_->wait();
+        if (state_->error_) std::rethrow_exception(state_->error_);
+        if constexpr (!std::is_void_v<T>) return std::move(*state_->value_);
+    }
+
+    // f(T) (или f() для void) запустится на пуле после готовности значения
+    template<typename F>
+    auto then(F&& f) && {
+        using Fn = std::decay_t<F>;
+        using Result = typename continuation_result<Fn, T>::type;
+
+        FutureState<T>* parent = std::exchange(state_, nullptr);
+        TaskScheduler& scheduler = parent->scheduler_;
+        // До передачи планировщику child принадлежит нам: если schedule() бросит,
+        // unique_ptr освободит его, а ссылку на parent отпускаем сами
+        std::unique_ptr<ContinuationState<Result, T, Fn>> child;
+        try {
+            child = std::make_unique<ContinuationState<Result, T, Fn>>(scheduler, std::forward<F>(f), parent);
+            if (!parent->set_continuation(child.get())) scheduler.schedule(child.get());
+        } catch (...) {
+            parent->release();
+            throw;
+        }
+        return Future<Result>(child.release());
+    }
+};
+
+template<typename F>
+auto TaskScheduler::submit(F&& f) -> Future<std::invoke_result_t<std::decay_t<F>&>> {
+    using T = std::invoke_result_t<std::decay_t<F>&>;
+    auto* state = new TaskState<T, std::decay_t<F>>(*this, std::forward<F>(f));
+    try {
+        schedule(state);
+    } catch (...) {
+        delete state;
+        throw;
+    }
+    return Future<T>(state);
+}
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// parallel_for / parallel_reduce
+// ────────────────────────────────────────────────────────────────────────────────────
+
+namespace detail {
+
+// Счётчик необработанных индексов; последний обнулитель будит внешнего ждущего.
+// std::latch, а не atomic + notify_all: после fetch_sub ждущий может вернуться
+// и уничтожить счётчик (он на его стеке) раньше, чем обнулитель вызовет notify
+class LoopCounter {
+    std::latch remaining_;
+
+public:
+    explicit LoopCounter(size_t n) : remaining_(ptrdiff_t(n)) {}
+
+    void done(size_t n) { remaining_.count_down(ptrdiff_t(n)); }
+
+    void wait(TaskScheduler& s) {
+        if (s.current_worker() >= 0) {
+            s.help_until([this] { return remaining_.try_wait(); });
+            return;
+        }
+        remaining_.wait();
+    }
+};
+
+// Lazy binary splitting: отдаём половину ворам, только когда своя deque пуста
+template<typename Chunk>
+void run_range(TaskScheduler& s, LoopCounter& counter, const Chunk& chunk, size_t grain, size_t begin, size_t end) {
+    while (begin < end) {
+        if (end - begin > grain && s.local_queue_empty()) {
+            size_t mid = begin + (end - begin) / 2;
+            s.post([&s, &counter, &chunk, grain, mid, end] { run_range(s, counter, chunk, grain, mid, end); });
+            end = mid;
+            continue;
+        }
+        size_t stop = std::min(end, begin + grain);
+        chunk(begin, stop);
+        counter.done(stop - begin);
+        begin = stop;
+    }
+}
+
+inline size_t default_grain(TaskScheduler& s, size_t n) {
+    // Достаточно мелко для балансировки, достаточно крупно, чтобы атомик
+    // счётчика не стал узким местом
+    return std::max<size_t>(1, n / (s.worker_count() * 64));
+}
+
+template<typename Chunk>
+void run_loop(TaskScheduler& s, size_t begin, size_t end, size_t grain, const Chunk& chunk) {
+    if (begin >= end) return;
+    LoopCounter counter{end - begin};
+    if (s.current_worker() >= 0) {
+        run_range(s, counter, chunk, grain, begin, end);   // Вложенный цикл - сразу в своём потоке
+    } else {
+        s.post([&] { run_range(s, counter, chunk, grain, begin, end); });
+    }
+    counter.wait(s);
+}
+
+} // namespace detail
+
+template<typename F>
+void parallel_for(TaskScheduler& s, size_t begin, size_t end, F&& body, size_t grain = 0) {
+    if (grain == 0) grain = detail::default_grain(s, end - begin);
+    detail::run_loop(s, begin, end, grain, [&body](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) body(i);
+    });
+}
+
+// map(i) → T, combine(T, T) → T; combine ассоциативна и коммутативна
+// (частичные суммы копятся по worker'ам, порядок кусков не сохраняется)
+template<typename T, typename Map, typename Combine>
+T parallel_reduce(TaskScheduler& s, size_t begin, size_t end, T identity, Map&& map, Combine&& combine, size_t grain = 0) {
+    struct alignas(64) Partial {
+        T value;
+    };
+    std::vector<Partial> partials(s.worker_count(), Partial{identity});
+
+    if (grain == 0) grain = detail::default_grain(s, end - begin);
+    detail::run_loop(s, begin, end, grain, [&](size_t b, size_t e) {
+        T acc = identity;
+        for (size_t i = b; i < e; ++i) acc = combine(std::move(acc), map(i));
+        T& slot = partials[s.current_worker()].value;   // Куски выполняют только worker'ы
+        slot = combine(std::move(slot), std::move(acc));
+    });
+
+    T result = std::move(identity);
+    for (auto& partial : partials) result = combine(std::move(result), std::move(partial.value));
+    return result;
+}
+
+} // namespace sched
+
+// Использование TaskScheduler
+void task_scheduler_example() {
+    sched::TaskScheduler scheduler(4);
+
+    // Цепочка без блокировок: каждое звено запустится, когда готово предыдущее
+    auto chain = scheduler.submit([] { return 20; })
+                     .then([](int x) { return x + 1; })
+                     .then([](int x) { return std::to_string(x * 2); });
+    std::cout << "then chain: " << chain.get() << '\n';
+
+    // Исключение проходит по цепочке до get()
+    auto failing = scheduler.submit([]() -> int { throw std::runtime_error("boom"); })
+                       .then([](int x) { return x * 2; });
+    try {
+        failing.get();
+    } catch (const std::exception& e) {
+        std::cout << "then chain error: " << e.what() << '\n';
+    }
+
+    std::vector<double> data(1'000'000);
+    sched::parallel_for(scheduler, 0, data.size(), [&](size_t i) { data[i] = std::sqrt(double(i)); });
+
+    double sum = sched::parallel_reduce(scheduler, 0, data.size(), 0.0,
+        [&](size_t i) { return data[i]; },
+        [](double a, double b) { return a + b; });
+    std::cout << "parallel_reduce sum: " << sum << '\n';
+}
+
+task_scheduler_example();
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Бенчмарк: мелкие задачи (≤1 мкс) - ThreadPool vs TaskScheduler
+// ────────────────────────────────────────────────────────────────────────────────────
+
+#include <numeric>
+
+void task_scheduler_benchmark() {
+    const size_t threads = std::max(2u, std::thread::hardware_concurrency());
+    constexpr int tasks = 200'000;
+
+    auto report = [](const char* name, auto elapsed, long items) {
+        double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+        std::cout << name << ": " << ns / 1e6 << " ms, " << ns / items << " ns/item\n";
+    };
+
+    // Крошечная работа (~десятки нс)
+    auto work = [](int i) {
+        double x = i;
+        for (int k = 0; k < 16; ++k) x = std::sqrt(x + k);
+        return x;
+    };
+
+    // 1. Отдельные задачи с результатом
+    {
+        ThreadPool pool(threads);
+        std::vector<std::future<double>> futures;
+        futures.reserve(tasks);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < tasks; ++i) futures.push_back(pool.enqueue([i, &work] { return work(i); }));
+        double sum = 0;
+        for (auto& f : futures) sum += f.get();
+        report("ThreadPool::enqueue + future", std::chrono::steady_clock::now() - start, tasks);
+    }
+    {
+        sched::TaskScheduler scheduler(threads);
+        std::vector<sched::Future<double>> futures;
+        futures.reserve(tasks);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < tasks; ++i) futures.push_back(scheduler.submit([i, &work] { return work(i); }));
+        double sum = 0;
+        for (auto& f : futures) sum += f.get();
+        report("TaskScheduler::submit + Future", std::chrono::steady_clock::now() - start, tasks);
+    }
+
+    // 2. Задачи, порождённые изнутри пула (fan-out из одной задачи)
+    {
+        sched::TaskScheduler scheduler(threads);
+        sched::detail::LoopCounter pending{size_t(tasks)};
+        auto start = std::chrono::steady_clock::now();
+        scheduler.post([&] {
+            for (int i = 0; i < tasks; ++i) {
+                scheduler.post([&, i] {
+                    volatile double sink = work(i);
+                    (void)sink;
+                    pending.done(1);
+                });
+            }
+        });
+        pending.wait(scheduler);
+        report("TaskScheduler::post (fan-out inside pool)", std::chrono::steady_clock::now() - start, tasks);
+    }
+
+    // 3. Цепочка продолжений
+    {
+        constexpr int links = 100'000;
+        sched::TaskScheduler scheduler(threads);
+        auto start = std::chrono::steady_clock::now();
+        auto future = scheduler.submit([] { return 0; });
+        for (int i = 0; i < links; ++i) {
+            future = std::move(future).then([](int x) { return x + 1; });
+        }
+        int result = future.get();
+        report("then chain", std::chrono::steady_clock::now() - start, links);
+        if (result != links) std::cout << "  WRONG RESULT\n";
+    }
+
+    // 4. parallel_for: адаптивные куски vs ручная нарезка по 1000 на ThreadPool
+    constexpr size_t n = 10'000'000;
+    std::vector<double> data(n);
+    {
+        ThreadPool pool(threads);
+        std::vector<std::future<void>> futures;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t b = 0; b < n; b += 1000) {
+            futures.push_back(pool.enqueue([&, b] {
+                for (size_t i = b; i < std::min(n, b + 1000); ++i) data[i] = std::sqrt(double(i));
+            }));
+        }
+        for (auto& f : futures) f.get();
+        report("ThreadPool, chunks of 1000", std::chrono::steady_clock::now() - start, n);
+    }
+    {
+        sched::TaskScheduler scheduler(threads);
+        auto start = std::chrono::steady_clock::now();
+        sched::parallel_for(scheduler, 0, n, [&](size_t i) { data[i] = std::sqrt(double(i)); });
+        report("parallel_for (lazy splitting)", std::chrono::steady_clock::now() - start, n);
+
+        start = std::chrono::steady_clock::now();
+        double sum = sched::parallel_reduce(scheduler, 0, n, 0.0,
+            [&](size_t i) { return data[i]; },
+            [](double a, double b) { return a + b; });
+        report("parallel_reduce", std::chrono::steady_clock::now() - start, n);
+
+        start = std::chrono::steady_clock::now();
+        double sequential = std::accumulate(data.begin(), data.end(), 0.0);
+        report("std::accumulate", std::chrono::steady_clock::now() - start, n);
+        if (std::abs(sum - sequential) > 1e-6 * sequential) std::cout << "  SUM MISMATCH\n";
+    }
+}
+
+task_scheduler_benchmark();
+
+// ============================================
+// 📌 LOCK-FREE PROGRAMMING
+// ============================================
+
+/*
+ * Наивный Treiber stack (push: CAS head; pop: CAS head → head->next; delete)
+ * сломан дважды:
+ *
+ * 1. Use-after-free: поток A прочитал head, поток B снял этот узел и сделал
+ *    delete - A читает head->next из освобождённой памяти.
+ * 2. ABA: A прочитал head = X, next = Y; B снял X и Y, вернул X (тот же адрес
+ *    из аллокатора); CAS у A проходит (head снова X) и ставит head = Y,
+ *    которого в стеке уже нет.
+ *
+ * Оба лечатся отложенным освобождением (safe memory reclamation): узел,
+ * снятый со структуры, нельзя ни освободить, ни переиспользовать, пока на
+ * него может смотреть кто-то ещё.
+ *
+ * reclaim::HazardPointers - поток объявляет "смотрю на X" в своём слоте;
+ *   retire(X) откладывает X, пока X есть хоть в одном слоте.
+ *   Память под отложенные узлы ограничена (~ потоки × слоты).
+ * reclaim::EpochBased     - поток входит в эпоху на время операции;
+ *   узел, отложенный в эпоху e, освобождается, когда все активные потоки
+ *   дошли до e + 2. Чтение дешевле (без seq_cst на каждый указатель),
+ *   но зависший внутри операции поток задерживает всё освобождение.
+ *
+ * Освобождённые узлы не идут в delete, а возвращаются в NodePool<Node>
+ * (магазин на поток + общий список) - push не зовёт malloc.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace reclaim {
+
+inline constexpr size_t MAX_THREADS = 256;
+inline constexpr size_t HAZARDS_PER_THREAD = 2;   // Michael-Scott queue нужно два
+
+// Отложенный узел: указатель + как его вернуть (обычно в NodePool)
+struct Retired {
+    void* ptr;
+    void (*reclaim)(void*);
+    uint64_t epoch;   // Только для EpochBased
+};
+
+// Узлы, которые поток не успел освободить до выхода, - их доберут другие
+class Orphans {
+    std::mutex mutex_;
+    std::vector<Retired> items_;
+    std::atomic<bool> non_empty_{false};
+
+public:
+    void give(std::vector<Retired>& items) {
+        if (items.empty()) return;
+        std::lock_guard lock(mutex_);
+        items_.insert(items_.end(), items.begin(), items.end());
+        items.clear();
+        non_empty_.store(true, std::memory_order_release);
+    }
+
+    void adopt(std::vector<Retired>& into) {
+        if (!non_empty_.load(std::memory_order_acquire)) return;
+        std::lock_guard lock(mutex_);
+        into.insert(into.end(), items_.begin(), items_.end());
+        items_.clear();
+        non_empty_.store(false, std::memory_order_relaxed);
+    }
+};
+
+// Записи потоков: фиксированный массив, запись занимается при первой операции
+// потока и освобождается при его выходе
+template<typename Record>
+Record* acquire_record(Record* records, std::atomic<size_t>& high_water) {
+    for (size_t i = 0; i < MAX_THREADS; ++i) {
+        bool expected = false;
+        if (!records[i].in_use.load(std::memory_order_relaxed) &&
+            records[i].in_use.compare_exchange_strong(expected, true)) {
+            size_t count = high_water.load();
+            while (count < i + 1 && !high_water.compare_exchange_weak(count, i + 1)) {}
+            return &records[i];
+        }
+    }
+    throw std::runtime_error("reclaim: too many threads");
+}
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Hazard pointers
+// ────────────────────────────────────────────────────────────────────────────────────
+
+struct alignas(64) HazardRecord {
+    std::atomic<const void*> hazards[HAZARDS_PER_THREAD]{};
+    std::atomic<bool> in_use{false};
+};
+
+class HazardPointers {
+    using Record = HazardRecord;
+
+    static inline Record records_[MAX_THREADS];
+    static inline std::atomic<size_t> high_water_{0};
+
+    static Orphans& orphans() {
+        static Orphans* orphans = new Orphans;   // Не разрушается: потоки могут выходить после main
+        return *orphans;
+    }
+
+    struct ThreadState {
+        Record* record = nullptr;
+        std::vector<Retired> retired;
+
+        Record* get() {
+            if (!record) record = acquire_record(records_, high_water_);
+            return record;
+        }
+
+        ~ThreadState() {
+            scan(*this);
+            orphans().give(retired);
+            if (record) record->in_use.store(false, std::memory_order_release);
+        }
+    };
+
+    static ThreadState& local() {
+        thread_local ThreadState state;
+        return state;
+    }
+
+    // Освободить всё отложенное, на что не указывает ни один hazard-слот
+    static void scan(ThreadState& state) {
+        orphans().adopt(state.retired);
+
+        std::vector<const void*> hazards;
+        size_t count = high_water_.load(std::memory_order_acquire);
+        hazards.reserve(count * HAZARDS_PER_THREAD);
+        for (size_t i = 0; i < count; ++i) {
+            for (auto& slot : records_[i].hazards) {
+                if (const void* p = slot.load(std::memory_order_seq_cst)) hazards.push_back(p);
+            }
+        }
+        std::sort(hazards.begin(), hazards.end());
+
+        auto still_protected = std::partition(state.retired.begin(), state.retired.end(), [&](const Retired& r) {
+            return std::binary_search(hazards.begin(), hazards.end(), r.ptr);
+        });
+        for (auto it = still_protected; it != state.retired.end(); ++it) it->reclaim(it->ptr);
+        state.retired.erase(still_protected, state.retired.end());
+    }
+
+public:
+    // На время одной операции; вложенные Guard в одном потоке не поддерживаются
+    class Guard {
+        Record* record_;
+
+    public:
+        Guard() : record_(local().get()) {}
+
+        ~Guard() {
+            for (auto& slot : record_->hazards) slot.store(nullptr, std::memory_order_release);
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        // Прочитать указатель и опубликовать его в слоте; повторяем, пока
+        // src не подтвердит, что узел всё ещё достижим (иначе его могли уже retire)
+        template<typename T>
+        T* protect(size_t slot, const std::atomic<T*>& src) {
+            T* p = src.load(std::memory_order_relaxed);
+            while (true) {
+                record_->hazards[slot].store(p, std::memory_order_seq_cst);
+                T* again = src.load(std::memory_order_seq_cst);
+                if (again == p) return p;
+                p = again;
+            }
+        }
+    };
+
+    static void retire(void* p, void (*reclaim)(void*)) {
+        ThreadState& state = local();
+        state.retired.push_back({p, reclaim, 0});
+        // Порог пропорционален числу слотов: scan амортизированно O(1) на retire
+        size_t threshold = std::max<size_t>(64, 2 * HAZARDS_PER_THREAD * high_water_.load(std::memory_order_relaxed));
+        if (state.retired.size() >= threshold) scan(state);
+    }
+
+    // Принудительно (тесты, завершение)
+    static void collect() { scan(local()); }
+};
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Epoch-based reclamation
+// ────────────────────────────────────────────────────────────────────────────────────
+
+struct alignas(64) EpochRecord {
+    std::atomic<uint64_t> epoch{0};   // 0 - поток вне операции
+    std::atomic<bool> in_use{false};
+};
+
+class EpochBased {
+    using Record = EpochRecord;
+
+    static inline Record records_[MAX_THREADS];
+    static inline std::atomic<size_t> high_water_{0};
+    alignas(64) static inline std::atomic<uint64_t> global_epoch_{1};
+
+    static Orphans& orphans() {
+        static Orphans* orphans = new Orphans;
+        return *orphans;
+    }
+
+    struct ThreadState {
+        Record* record = nullptr;
+        unsigned nesting = 0;
+        std::vector<Retired> limbo;
+        size_t collect_at = 64;   // Растёт, пока эпоху держит медленный поток: без O(n) на каждый retire
+
+        ~ThreadState() {
+            collect(*this);
+            orphans().give(limbo);
+            if (record) record->in_use.store(false, std::memory_order_release);
+        }
+    };
+
+    static ThreadState& local() {
+        thread_local ThreadState state;
+        return state;
+    }
+
+    // Эпоху можно сдвинуть, только если все активные потоки уже в текущей
+    static void try_advance() {
+        uint64_t epoch = global_epoch_.load(std::memory_order_seq_cst);
+        size_t count = high_water_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t seen = records_[i].epoch.load(std::memory_order_seq_cst);
+            if (seen != 0 && seen != epoch) return;
+        }
+        global_epoch_.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+    static void collect(ThreadState& state) {
+        orphans().adopt(state.limbo);
+        try_advance();
+        uint64_t epoch = global_epoch_.load(std::memory_order_acquire);
+        auto not_yet = std::partition(state.limbo.begin(), state.limbo.end(), [&](const Retired& r) {
+            return r.epoch + 2 > epoch;
+        });
+        for (auto it = not_yet; it != state.limbo.end(); ++it) it->reclaim(it->ptr);
+        state.limbo.erase(not_yet, state.limbo.end());
+        state.collect_at = std::max<size_t>(64, 2 * state.limbo.size());
+    }
+
+public:
+    class Guard {
+        ThreadState& state_;
+
+    public:
+        Guard() : state_(local()) {
+            if (state_.nesting++ == 0) {
+                if (!state_.record) state_.record = acquire_record(records_, high_water_);
+                state_.record->epoch.store(global_epoch_.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+            }
+        }
+
+        ~Guard() {
+            if (--state_.nesting == 0) state_.record->epoch.store(0, std::memory_order_release);
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        // Внутри эпохи ничего не освободится - достаточно обычного acquire
+        template<typename T>
+        T* protect(size_t, const std::atomic<T*>& src) {
+            return src.load(std::memory_order_acquire);
+        }
+    };
+
+    static void retire(void* p, void (*reclaim)(void*)) {
+        ThreadState& state = local();
+        state.limbo.push_back({p, reclaim, global_epoch_.load(std::memory_order_relaxed)});
+        if (state.limbo.size() >= state.collect_at) collect(state);
+    }
+
+    static void collect() { collect(local()); }
+};
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// NodePool: переиспользование узлов без malloc
+// ────────────────────────────────────────────────────────────────────────────────────
+
+template<typename Node>
+class NodePool {
+    static_assert(alignof(Node) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    static constexpr size_t MAGAZINE = 64;
+
+    // Тривиально разрушаемый: узлы, освобождаемые при выходе потока после flush,
+    // уходят сразу в общий список
+    struct Magazine {
+        void* blocks[2 * MAGAZINE];
+        size_t count;
+        bool closed;
+    };
+
+    struct Shared {
+        std::mutex mutex;
+        std::vector<void*> blocks;
+    };
+
+    static inline thread_local constinit Magazine magazine_{};
+
+    static Shared& shared() {
+        static Shared* shared = new Shared;   // Не разрушается, как и Orphans
+        return *shared;
+    }
+
+    struct Flush {
+        ~Flush() {
+            Shared& s = shared();
+            std::lock_guard lock(s.mutex);
+            s.blocks.insert(s.blocks.end(), magazine_.blocks, magazine_.blocks + magazine_.count);
+            magazine_.count = 0;
+            magazine_.closed = true;
+        }
+    };
+
+    static Magazine& local() {
+        thread_local Flush flush;
+        (void)flush;
+        return magazine_;
+    }
+
+    static void* allocate() {
+        Magazine& m = local();
+        if (m.count == 0) {
+            Shared& s = shared();
+            std::lock_guard lock(s.mutex);
+            size_t take = std::min(MAGAZINE, s.blocks.size());
+            std::copy(s.blocks.end() - take, s.blocks.end(), m.blocks);
+            s.blocks.resize(s.blocks.size() - take);
+            m.count = take;
+        }
+        if (m.count == 0) return ::operator new(sizeof(Node));
+        return m.blocks[--m.count];
+    }
+
+    static void deallocate(void* block) {
+        Magazine& m = local();
+        if (m.closed || m.count == 2 * MAGAZINE) {
+            // Полный магазин: половину в общий список, чтобы не дёргать мьютекс на каждом узле
+            Shared& s = shared();
+            std::lock_guard lock(s.mutex);
+            if (m.closed) {
+                s.blocks.push_back(block);
+                return;
+            }
+            s.blocks.insert(s.blocks.end(), m.blocks + MAGAZINE, m.blocks + 2 * MAGAZINE);
+            m.count = MAGAZINE;
+        }
+        m.blocks[m.count++] = block;
+    }
+
+public:
+    template<typename... Args>
+    static Node* create(Args&&... args) {
+        void* block = allocate();
+        try {
+            return new (block) Node(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(block);
+            throw;
+        }
+    }
+
+    static void destroy(Node* node) {
+        node->~Node();
+        deallocate(node);
+    }
+
+    // Для retire(): узел уже снят со структуры
+    static void reclaim(void* node) { destroy(static_cast<Node*>(node)); }
+};
+
+} // namespace reclaim
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// LockFreeStack: Treiber stack + safe reclamation
+// ────────────────────────────────────────────────────────────────────────────────────
+
+template<typename T, typename Reclaimer = reclaim::HazardPointers>
+class LockFreeStack {
+private:
+    struct Node {
+        T data;
+        Node* next = nullptr;   // Пишется до публикации, дальше только читается
+        explicit Node(T d) : data(std::move(d)) {}
+    };
+
+    using Pool = reclaim::NodePool<Node>;
+
+    alignas(64) std::atomic<Node*> head_{nullptr};
+
+public:
+    LockFreeStack() = default;
+    LockFreeStack(const LockFreeStack&) = delete;
+    LockFreeStack& operator=(const LockFreeStack&) = delete;
+
+    void push(T data) {
+        Node* new_node = Pool::create(std::move(data));
+        new_node->next = head_.load(std::memory_order_relaxed);
+
+        // CAS loop - повторяем пока не успешно
+        while (!head_.compare_exchange_weak(new_node->next, new_node,
+                                            std::memory_order_release, std::memory_order_relaxed)) {
+            // new_node->next обновлен текущим head_, повторяем
+        }
+    }
+
+    bool pop(T& result) {
+        Node* old_head;
+        {
+            typename Reclaimer::Guard guard;
+            do {
+                old_head = guard.protect(0, head_);   // Пока узел в слоте - его не освободят и не переиспользуют
+                if (!old_head) {
+                    return false;  // Стек пуст
+                }
+            } while (!head_.compare_exchange_weak(old_head, old_head->next,
+                                                  std::memory_order_acquire, std::memory_order_relaxed));
+        }
+
+        result = std::move(old_head->data);
+        Reclaimer::retire(old_head, &Pool::reclaim);   // Вместо delete
+        return true;
+    }
+
+    bool empty() const { return head_.load(std::memory_order_acquire) == nullptr; }
+
+    ~LockFreeStack() {
+        // Других потоков уже нет - освобождаем напрямую
+        for (Node* node = head_.load(); node;) {
+            Node* next = node->next;
+            Pool::destroy(node);
+            node = next;
+        }
+    }
+};
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// LockFreeQueue: Michael-Scott queue
+// ────────────────────────────────────────────────────────────────────────────────────
+
+/*
+ * Односвязный список с фиктивным головным узлом: head_ - dummy,
+ * значения начинаются с head_->next. enqueue - CAS в tail->next,
+ * dequeue - CAS head_ на следующий узел, который становится новым dummy.
+ * Отстающий tail_ любой поток "догоняет" сам (helping).
+ */
+template<typename T, typename Reclaimer = reclaim::HazardPointers>
+class LockFreeQueue {
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        alignas(T) std::byte storage[sizeof(T)];   // Пусто у dummy
+
+        T* value() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    using Pool = reclaim::NodePool<Node>;
+
+    alignas(64) std::atomic<Node*> head_;
+    alignas(64) std::atomic<Node*> tail_;
+
+public:
+    LockFreeQueue() {
+        Node* dummy = Pool::create();
+        head_.store(dummy, std::memory_order_relaxed);
+        tail_.store(dummy, std::memory_order_relaxed);
+    }
+
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+    void enqueue(T value) {
+        Node* node = Pool::create();
+        new (node->storage) T(std::move(value));
+
+        typename Reclaimer::Guard guard;
+        while (true) {
+            Node* tail = guard.protect(0, tail_);
+            Node* next = tail->next.load(std::memory_order_acquire);
+            if (tail != tail_.load(std::memory_order_acquire)) continue;
+
+            if (next) {
+                tail_.compare_exchange_weak(tail, next);   // Помогаем отставшему tail
+                continue;
+            }
+            if (tail->next.compare_exchange_weak(next, node, std::memory_order_release, std::memory_order_relaxed)) {
+                tail_.compare_exchange_strong(tail, node);
+                return;
+            }
+        }
+    }
+
+    bool dequeue(T& result) {
+        Node* head;
+        Node* next;
+        {
+            typename Reclaimer::Guard guard;
+            while (true) {
+                head = guard.protect(0, head_);
+                Node* tail = tail_.load(std::memory_order_acquire);
+                next = guard.protect(1, head->next);
+                if (head != head_.load(std::memory_order_acquire)) continue;
+
+                if (!next) return false;   // Пусто
+                if (head == tail) {
+                    tail_.compare_exchange_weak(tail, next);   // tail отстал - помогаем
+                    continue;
+                }
+                if (head_.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_relaxed)) break;
+            }
+
+            // next - новый dummy; его значение забираем только мы (CAS выиграли),
+            // а узел всё ещё под hazard-слотом 1
+            result = std::move(*next->value());
+            next->value()->~T();
+        }
+
+        Reclaimer::retire(head, &Pool::reclaim);
+        return true;
+    }
+
+    ~LockFreeQueue() {
+        Node* node = head_.load();
+        Node* next = node->next.load();
+        Pool::destroy(node);   // dummy - без значения
+        for (node = next; node; node = next) {
+            next = node->next.load();
+            node->value()->~T();
+            Pool::destroy(node);
+        }
+    }
+};
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// LockFreeFreeList: пул переиспользуемых объектов (буферы, соединения)
+// ────────────────────────────────────────────────────────────────────────────────────
+
+/*
+ * Объекты хранятся как T* в LockFreeStack: ABA на узлах стека закрыта
+ * reclamation'ом, а сами объекты живут до разрушения free-list'а.
+ * acquire() берёт свободный объект или создаёт новый, release() возвращает.
+ */
+template<typename T, typename Reclaimer = reclaim::HazardPointers>
+class LockFreeFreeList {
+    LockFreeStack<T*, Reclaimer> free_;
+    std::atomic<size_t> created_{0};
+
+public:
+    ~LockFreeFreeList() {
+        // Выданные и не возвращённые объекты - на совести владельца
+        T* object;
+        while (free_.pop(object)) delete object;
+    }
+
+    template<typename... Args>
+    T* acquire(Args&&... args) {
+        T* object;
+        if (free_.pop(object)) return object;
+        created_.fetch_add(1, std::memory_order_relaxed);
+        return new T(std::forward<Args>(args)...);
+    }
+
+    void release(T* object) { free_.push(object); }
+
+    size_t created() const { return created_.load(std::memory_order_relaxed); }
+};
+
+// Для сравнения
+template<typename T>
+class MutexStack {
+    std::mutex mutex_;
+    std::vector<T> items_;
+
+public:
+    void push(T value) {
+        std::lock_guard lock(mutex_);
+        items_.push_back(std::move(value));
+    }
+
+    bool pop(T& result) {
+        std::lock_guard lock(mutex_);
+        if (items_.empty()) return false;
+        result = std::move(items_.back());
+        items_.pop_back();
+        return true;
+    }
+};
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Стресс-тест (собирать с -fsanitize=thread и -fsanitize=address)
+// ────────────────────────────────────────────────────────────────────────────────────
+
+/*
+ * Каждый поток кладёт свои уникальные значения и тут же снимает чужие.
+ * В конце: каждое значение снято ровно один раз, ничего не потеряно.
+ * TSan ловит гонки на узлах (use-after-free через переиспользование),
+ * ASan - обращение к уже освобождённым блокам.
+ */
+template<typename Container, typename Push, typename Pop>
+bool stress_container(const char* name, int threads, int per_thread, Push push, Pop pop) {
+    Container container;
+    std::vector<std::vector<int>> taken(threads);
+
+    {
+        std::vector<std::jthread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                int value;
+                for (int i = 0; i < per_thread; ++i) {
+                    push(container, t * per_thread + i);
+                    if (pop(container, value)) taken[t].push_back(value);
+                }
+            });
+        }
+    }
+
+    std::vector<int> all;
+    for (auto& part : taken) all.insert(all.end(), part.begin(), part.end());
+    int value;
+    while (pop(container, value)) all.push_back(value);
+
+    std::sort(all.begin(), all.end());
+    bool ok = all.size() == size_t(threads) * per_thread;
+    for (size_t i = 0; ok && i < all.size(); ++i) ok = all[i] == int(i);
+
+    std::cout << "stress " << name << ": " << (ok ? "OK" : "FAILED") << '\n';
+    return ok;
+}
+
+void lock_free_stress_test() {
+    constexpr int threads = 8;
+    constexpr int per_thread = 50'000;
+
+    auto stack_push = [](auto& s, int v) { s.push(v); };
+    auto stack_pop = [](auto& s, int& v) { return s.pop(v); };
+    auto queue_push = [](auto& q, int v) { q.enqueue(v); };
+    auto queue_pop = [](auto& q, int& v) { return q.dequeue(v); };
+
+    stress_container<LockFreeStack<int, reclaim::HazardPointers>>("stack/hazard", threads, per_thread, stack_push, stack_pop);
+    stress_container<LockFreeStack<int, reclaim::EpochBased>>("stack/epoch", threads, per_thread, stack_push, stack_pop);
+    stress_container<LockFreeQueue<int, reclaim::HazardPointers>>("queue/hazard", threads, per_thread, queue_push, queue_pop);
+    stress_container<LockFreeQueue<int, reclaim::EpochBased>>("queue/epoch", threads, per_thread, queue_push, queue_pop);
+
+    // Free-list: один объект не должен оказаться у двух потоков одновременно
+    struct Buffer {
+        std::atomic<int> owners{0};
+        std::array<char, 256> bytes{};
+    };
+    LockFreeFreeList<Buffer> buffers;
+    std::atomic<bool> double_owned{false};
+    {
+        std::vector<std::jthread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                for (int i = 0; i < per_thread; ++i) {
+                    Buffer* buffer = buffers.acquire();
+                    if (buffer->owners.fetch_add(1) != 0) double_owned = true;
+                    buffer->bytes[i % buffer->bytes.size()] = char(i);
+                    buffer->owners.fetch_sub(1);
+                    buffers.release(buffer);
+                }
+            });
+        }
+    }
+    std::cout << "stress free-list: " << (double_owned ? "FAILED" : "OK")
+              << " (" << buffers.created() << " buffers for " << threads << " threads)\n";
+}
+
+lock_free_stress_test();
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Бенчмарк: lock-free vs mutex stack
+// ────────────────────────────────────────────────────────────────────────────────────
+
+template<typename Container, typename Push, typename Pop>
+double container_throughput(int threads, int ops_per_thread, Push push, Pop pop) {
+    Container container;
+    for (int i = 0; i < 1024; ++i) push(container, i);   // Не пустой: pop не "промахивается"
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                int value;
+                for (int i = 0; i < ops_per_thread; ++i) {
+                    push(container, i);
+                    pop(container, value);
+                }
+            });
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return 2.0 * threads * ops_per_thread / seconds / 1e6;
+}
+
+void lock_free_benchmark() {
+    constexpr int total_ops = 2'000'000;
+
+    auto stack_push = [](auto& s, int v) { s.push(v); };
+    auto stack_pop = [](auto& s, int& v) { return s.pop(v); };
+    auto queue_push = [](auto& q, int v) { q.enqueue(v); };
+    auto queue_pop = [](auto& q, int& v) { return q.dequeue(v); };
+
+    std::cout << "threads  MutexStack  Stack/HP  Stack/EBR  Queue/HP  Queue/EBR   [M ops/s]\n";
+    for (int threads : {1, 2, 4, 8, 16}) {
+        int ops = total_ops / threads;
+        std::cout << "  " << threads
+                  << "\t " << container_throughput<MutexStack<int>>(threads, ops, stack_push, stack_pop)
+                  << "\t " << container_throughput<LockFreeStack<int, reclaim::HazardPointers>>(threads, ops, stack_push, stack_pop)
+                  << "\t " << container_throughput<LockFreeStack<int, reclaim::EpochBased>>(threads, ops, stack_push, stack_pop)
+                  << "\t " << container_throughput<LockFreeQueue<int, reclaim::HazardPointers>>(threads, ops, queue_push, queue_pop)
+                  << "\t " << container_throughput<LockFreeQueue<int, reclaim::EpochBased>>(threads, ops, queue_push, queue_pop)
+                  << '\n';
+    }
+}
+
+lock_free_benchmark();
+
+// ════════════════════════════════════════════════════════════════════════════════════
+// 📌 STOP TOKENS (C++20) - КООПЕРАТИВНАЯ ОСТАНОВКА
+// ════════════════════════════════════════════════════════════════════════════════════
+
+// jthread автоматически предоставляет stop_token
+std::jthread stop_t([](std::stop_token stoken) {
+    int count = 0;
+    while (!stoken.stop_requested()) {
+        std::cout << "Iteration " << count++ << '\n';
+        std::this_thread::sleep_for(100ms);
+        
+        if (count >= 5) break;
+    }
+    
+    if (stoken.stop_requested()) {
+        std::cout << "Stop requested!\n";
+    }
+});
+
+std::this_thread::sleep_for(250ms);
+stop_t.request_stop();  // Кооперативная остановка
+
+// stop_source и stop_token независимо
+std::stop_source source;
+std::stop_token token = source.get_token();
+
+// Callback при остановке
+std::stop_callback callback(token, [] {
+    std::cout << "Stop callback invoked!\n";
+});
+
+source.request_stop();  // Вызовет callback
+
+// ════════════════════════════════════════════════════════════════════════════════════
+// 📌 COMMON PATTERNS - ТИПИЧНЫЕ ПАТТЕРНЫ
+// ════════════════════════════════════════════════════════════════════════════════════
+
+// Thread-safe Singleton (C++11 гарантирует thread-safety)
+class Singleton {
+private:
+    Singleton() = default;
+    
+public:
+    static Singleton& instance() {
+        static Singleton inst;  // ✅ Thread-safe с C++11
+        return inst;
     }
     
     Singleton(const Singleton&) = delete;
@@ -1154,6 +3142,234 @@ auto size = mon.execute([](const auto& vec) {
     return vec.size();
 });
 
+// ────────────────────────────────────────────────────────────────────────────────────
+// Read-mostly состояние: RCU и seqlock
+// ────────────────────────────────────────────────────────────────────────────────────
+
+/*
+ * Monitor<T>::execute берёт эксклюзивный мьютекс даже в const-версии,
+ * SharedData (shared_mutex) - счётчик читателей, т.е. запись в общую cache
+ * line на КАЖДОЕ чтение. Для таблиц маршрутизации, конфига, списка
+ * сервисов (миллионы чтений, редкие записи) оба варианта не масштабируются.
+ *
+ * ReadMostly<T> (RCU):
+ * - читатель: войти в эпоху, загрузить указатель на неизменяемый снимок,
+ *   прочитать - запись только в свою запись эпохи, общих строк не трогает
+ * - писатель: скопировать, изменить копию, опубликовать exchange'ем;
+ *   старый снимок - в reclaim::EpochBased::retire (см. LOCK-FREE PROGRAMMING),
+ *   удалится, когда все читатели, которые могли его видеть, выйдут
+ *
+ * SeqLock<T> - для маленьких trivially copyable T (лимиты, версии, курсы):
+ * - читатель копирует значение и проверяет, что счётчик не изменился
+ *   (нечётный = идёт запись) - ни одной записи в память
+ * - без аллокаций и reclamation, но читатель может повторять копирование
+ */
+
+#include <bit>
+#include <cstring>
+
+template<typename T, typename Reclaimer = reclaim::EpochBased>
+class ReadMostly {
+private:
+    std::atomic<const T*> current_;
+    std::mutex write_mutex_;   // Писатели между собой
+
+    static void reclaim_snapshot(void* p) { delete static_cast<const T*>(p); }
+
+    void publish(std::unique_ptr<T> next) {
+        const T* old = current_.exchange(next.release(), std::memory_order_acq_rel);
+        Reclaimer::retire(const_cast<T*>(old), &reclaim_snapshot);
+        Reclaimer::collect();   // Записи редки - можно сразу подобрать старые версии
+    }
+
+public:
+    explicit ReadMostly(T initial = T{}) : current_(new T(std::move(initial))) {}
+    ~ReadMostly() { delete current_.load(); }
+
+    ReadMostly(const ReadMostly&) = delete;
+    ReadMostly& operator=(const ReadMostly&) = delete;
+
+    // Снимок держит эпоху: пока он жив, объект не удалят.
+    // Не держите его долго - это задерживает освобождение всех старых версий
+    class Snapshot {
+        typename Reclaimer::Guard guard_;
+        const T* value_;
+
+    public:
+        explicit Snapshot(const std::atomic<const T*>& source) : value_(guard_.protect(0, source)) {}
+
+        const T& operator*() const { return *value_; }
+        const T* operator->() const { return value_; }
+    };
+
+    Snapshot snapshot() const { return Snapshot(current_); }
+
+    template<typename F>
+    auto read(F&& f) const {
+        Snapshot snap(current_);
+        return f(*snap);
+    }
+
+    // Copy-on-write: f меняет копию, читатели видят либо старую, либо новую целиком
+    template<typename F>
+    void update(F&& f) {
+        std::lock_guard lock(write_mutex_);
+        auto next = std::make_unique<T>(*current_.load(std::memory_order_relaxed));
+        f(*next);
+        publish(std::move(next));
+    }
+
+    void store(T value) {
+        std::lock_guard lock(write_mutex_);
+        publish(std::make_unique<T>(std::move(value)));
+    }
+};
+
+template<typename T>
+    requires std::is_trivially_copyable_v<T>
+class SeqLock {
+private:
+    static constexpr size_t WORDS = (sizeof(T) + 7) / 8;
+    static_assert(WORDS <= 16, "SeqLock - для маленьких значений, большие - в ReadMostly");
+
+    // Данные - атомарные слова: одновременное чтение и запись формально не гонка
+    alignas(64) std::atomic<uint64_t> sequence_{0};
+    std::array<std::atomic<uint64_t>, WORDS> words_{};
+
+    void write_words(const T& value) {
+        std::array<uint64_t, WORDS> raw{};
+        std::memcpy(raw.data(), &value, sizeof(T));
+        for (size_t i = 0; i < WORDS; ++i) words_[i].store(raw[i], std::memory_order_relaxed);
+    }
+
+public:
+    explicit SeqLock(const T& initial = T{}) { write_words(initial); }
+
+    T load() const {
+        std::array<uint64_t, WORDS> raw;
+        while (true) {
+            uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();   // Писатель посередине записи
+                continue;
+            }
+            for (size_t i = 0; i < WORDS; ++i) raw[i] = words_[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) break;
+        }
+        T value;
+        std::memcpy(&value, raw.data(), sizeof(T));
+        return value;
+    }
+
+    void store(const T& value) {
+        // Нечётный счётчик = "идёт запись"; CAS заодно сериализует писателей
+        uint64_t seq = sequence_.load(std::memory_order_relaxed);
+        while ((seq & 1) || !sequence_.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire)) {
+            if (seq & 1) seq = sequence_.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        write_words(value);
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+};
+
+// Использование: таблица маршрутов и лимиты
+ReadMostly<std::vector<std::string>> backends(std::vector<std::string>{"10.0.0.1", "10.0.0.2"});
+
+auto chosen = backends.read([](const auto& list) { return list[0]; });
+
+backends.update([](auto& list) { list.push_back("10.0.0.3"); });   // Читатели не блокируются
+
+struct RateLimits {
+    int64_t requests_per_second;
+    int64_t burst;
+    int64_t version;
+};
+
+SeqLock<RateLimits> limits(RateLimits{1000, 100, 1});
+RateLimits current_limits = limits.load();
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Бенчмарк: масштабирование читателей (1 писатель раз в миллисекунду)
+// ────────────────────────────────────────────────────────────────────────────────────
+
+void read_mostly_benchmark() {
+    constexpr auto duration = std::chrono::milliseconds(100);
+    constexpr size_t table_size = 64;
+
+    // Прогон: readers потоков крутят read(i) около duration, один писатель.
+    // Делим на реально прошедшее время (запуск потоков → join), а не на duration:
+    // при 64 потоках на малом числе ядер старт и остановка занимают заметную долю
+    auto run = [&](int readers, auto&& read, auto&& write) {
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> total{0};
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::vector<std::jthread> threads;
+            for (int r = 0; r < readers; ++r) {
+                threads.emplace_back([&, r] {
+                    uint64_t count = 0;
+                    uint64_t sink = 0;
+                    for (size_t i = r; !stop.load(std::memory_order_relaxed); ++i) {
+                        sink += read(i);
+                        ++count;
+                    }
+                    total.fetch_add(count + (sink == 42), std::memory_order_relaxed);
+                });
+            }
+            threads.emplace_back([&] {
+                for (int v = 0; !stop.load(std::memory_order_relaxed); ++v) {
+                    write(v);
+                    std::this_thread::sleep_for(1ms);
+                }
+            });
+            std::this_thread::sleep_for(duration);
+            stop = true;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return double(total.load()) / elapsed.count() / 1e6;
+    };
+
+    std::cout << "readers  Monitor  shared_mutex  ReadMostly  SeqLock   [M reads/s]\n";
+    for (int readers : {1, 2, 4, 8, 16, 32, 64}) {
+        Monitor<std::vector<uint64_t>> monitor;
+        monitor.execute([&](auto& v) { v.assign(table_size, 1); });
+        double monitor_rate = run(readers,
+            [&](size_t i) { return monitor.execute([&](const auto& v) { return v[i % v.size()]; }); },
+            [&](int value) { monitor.execute([&](auto& v) { v[value % v.size()] = value; }); });
+
+        // Как SharedData, но писатель перезаписывает элемент на месте, как и в остальных
+        // вариантах (SharedData::write делает push_back - вектор рос бы весь прогон)
+        std::shared_mutex shared_mutex;
+        std::vector<uint64_t> shared(table_size, 1);
+        double shared_rate = run(readers,
+            [&](size_t i) {
+                std::shared_lock lock(shared_mutex);
+                return shared[i % table_size];
+            },
+            [&](int value) {
+                std::unique_lock lock(shared_mutex);
+                shared[value % table_size] = value;
+            });
+
+        ReadMostly<std::vector<uint64_t>> rcu(std::vector<uint64_t>(table_size, 1));
+        double rcu_rate = run(readers,
+            [&](size_t i) { return rcu.read([&](const auto& v) { return v[i % v.size()]; }); },
+            [&](int value) { rcu.update([&](auto& v) { v[value % v.size()] = value; }); });
+
+        SeqLock<RateLimits> seqlock(RateLimits{1000, 100, 0});
+        double seqlock_rate = run(readers,
+            [&](size_t) { return uint64_t(seqlock.load().requests_per_second); },
+            [&](int value) { seqlock.store(RateLimits{1000 + value, 100, value}); });
+
+        std::cout << "  " << readers << "\t " << monitor_rate << "\t " << shared_rate
+                  << "\t " << rcu_rate << "\t " << seqlock_rate << '\n';
+    }
+}
+
+read_mostly_benchmark();
+
 // Паттерн: Double-Checked Locking (правильная версия с C++11)
 class LazyInit {
 private:
@@ -1218,7 +3434,8 @@ struct GoodCounters {
  * 4. Read-write locks для read-heavy сценариев
  */
 
-// Sharding пример
+// Sharding пример (на этой идее построены metrics::Counter/Histogram в
+// cpp-web-network/http_server.cpp; шард по ядру/слоту потока - percpu::* ниже)
 template<size_t N = 16>
 class ShardedCounter {
 private:
@@ -1249,6 +3466,308 @@ public:
     }
 };
 
+// ────────────────────────────────────────────────────────────────────────────────────
+// Per-CPU шардированные примитивы
+// ────────────────────────────────────────────────────────────────────────────────────
+
+/*
+ * ShardedCounter выше выбирает шард по hash(thread::id) % N: два потока
+ * легко попадают в один шард (и снова делят cache line), только
+ * инкремент int, а total() читает seq_cst.
+ *
+ * percpu::*:
+ * - шард = текущее ядро (sched_getcpu, через rseq/vDSO - единицы нс)
+ *   или слот потока, выданный по кругу при регистрации: без коллизий,
+ *   пока потоков не больше шардов
+ * - все обновления relaxed: порядок между шардами не нужен, нужна только сумма
+ * - snapshot_and_reset(): exchange по шардам - для scrape'а метрик
+ *   "за интервал"; инкремент, пришедшийся на момент сброса, попадёт либо
+ *   в этот снимок, либо в следующий, но не потеряется
+ */
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <sched.h>
+
+namespace percpu {
+
+enum class ShardBy {
+    Cpu,          // sched_getcpu(): потоки одного ядра не мешают друг другу по кэшу
+    ThreadSlot,   // Слот при регистрации потока: стабилен при миграции между ядрами
+};
+
+inline size_t default_shards() {
+    return std::bit_ceil(std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 256));
+}
+
+// Слот выдаётся потоку один раз, по кругу
+inline size_t thread_slot() {
+    static std::atomic<size_t> next{0};
+    thread_local size_t slot = next.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+inline size_t shard_index(ShardBy by, size_t mask) {
+    if (by == ShardBy::Cpu) {
+        int cpu = sched_getcpu();
+        if (cpu >= 0) return size_t(cpu) & mask;
+    }
+    return thread_slot() & mask;
+}
+
+// Общая основа: массив выровненных ячеек + выбор шарда
+template<typename Cell>
+class Shards {
+protected:
+    struct alignas(64) Padded {
+        Cell cell;
+    };
+
+    std::unique_ptr<Padded[]> shards_;
+    size_t mask_;
+    ShardBy by_;
+
+    Cell& local() { return shards_[shard_index(by_, mask_)].cell; }
+
+public:
+    explicit Shards(ShardBy by = ShardBy::Cpu, size_t shards = default_shards())
+        : shards_(std::make_unique<Padded[]>(std::bit_ceil(shards))),
+          mask_(std::bit_ceil(shards) - 1),
+          by_(by) {}
+
+    size_t shard_count() const { return mask_ + 1; }
+};
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Counter / Reducer
+// ────────────────────────────────────────────────────────────────────────────────────
+
+// Операция свёртки: identity + как применить к атомику без блокировок
+template<typename T>
+struct Sum {
+    static constexpr T identity() { return T{}; }
+    static T combine(T a, T b) { return a + b; }
+    static void apply(std::atomic<T>& cell, T value) { cell.fetch_add(value, std::memory_order_relaxed); }
+};
+
+template<typename T>
+struct Min {
+    static constexpr T identity() { return std::numeric_limits<T>::max(); }
+    static T combine(T a, T b) { return std::min(a, b); }
+    static void apply(std::atomic<T>& cell, T value) {
+        // Пишем, только если улучшаем: после прогрева - почти одни чтения
+        T current = cell.load(std::memory_order_relaxed);
+        while (value < current && !cell.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+};
+
+template<typename T>
+struct Max {
+    static constexpr T identity() { return std::numeric_limits<T>::lowest(); }
+    static T combine(T a, T b) { return std::max(a, b); }
+    static void apply(std::atomic<T>& cell, T value) {
+        T current = cell.load(std::memory_order_relaxed);
+        while (value > current && !cell.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+};
+
+template<typename T, typename Op>
+class Reducer : public Shards<std::atomic<T>> {
+    using Base = Shards<std::atomic<T>>;
+
+public:
+    explicit Reducer(ShardBy by = ShardBy::Cpu, size_t shards = default_shards()) : Base(by, shards) {
+        for (size_t i = 0; i <= this->mask_; ++i) {
+            this->shards_[i].cell.store(Op::identity(), std::memory_order_relaxed);
+        }
+    }
+
+    void update(T value) { Op::apply(this->local(), value); }
+
+    // Приблизительно-текущее значение: шарды читаются не атомарно вместе
+    T value() const {
+        T result = Op::identity();
+        for (size_t i = 0; i <= this->mask_; ++i) {
+            result = Op::combine(result, this->shards_[i].cell.load(std::memory_order_relaxed));
+        }
+        return result;
+    }
+
+    // Значение за интервал с прошлого сброса
+    T snapshot_and_reset() {
+        T result = Op::identity();
+        for (size_t i = 0; i <= this->mask_; ++i) {
+            result = Op::combine(result, this->shards_[i].cell.exchange(Op::identity(), std::memory_order_relaxed));
+        }
+        return result;
+    }
+};
+
+template<typename T = int64_t>
+class Counter : public Reducer<T, Sum<T>> {
+public:
+    using Reducer<T, Sum<T>>::Reducer;
+
+    void add(T delta) { this->update(delta); }
+    void increment() { this->update(1); }
+};
+
+template<typename T> using MinReducer = Reducer<T, Min<T>>;
+template<typename T> using MaxReducer = Reducer<T, Max<T>>;
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// ApproxDistinct: HyperLogLog по шардам
+// ────────────────────────────────────────────────────────────────────────────────────
+
+/*
+ * 2^P регистров по байту: регистр = max(число ведущих нулей + 1) среди
+ * хэшей, попавших в него. Ошибка ≈ 1.04 / sqrt(2^P): для P = 12 ~1.6%
+ * при 4 КБ на шард. Оценка = слияние шардов (max по регистрам), так что
+ * шардирование не меняет результат. Регистр пишется только при росте -
+ * после прогрева обновление почти всегда одно чтение.
+ */
+template<unsigned P = 12>
+class ApproxDistinct : public Shards<std::array<std::atomic<uint8_t>, (1u << P)>> {
+    using Base = Shards<std::array<std::atomic<uint8_t>, (1u << P)>>;
+    static constexpr size_t REGISTERS = 1u << P;
+
+    static uint64_t mix(uint64_t x) {
+        // fmix64 из MurmurHash3: std::hash для целых - тождественная функция
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    double estimate(const std::array<uint8_t, REGISTERS>& registers) const {
+        double harmonic = 0;
+        size_t zeros = 0;
+        for (uint8_t r : registers) {
+            harmonic += std::ldexp(1.0, -int(r));
+            zeros += (r == 0);
+        }
+        double m = REGISTERS;
+        double alpha = 0.7213 / (1 + 1.079 / m);
+        double raw = alpha * m * m / harmonic;
+        if (raw <= 2.5 * m && zeros != 0) return m * std::log(m / double(zeros));   // Linear counting
+        return raw;
+    }
+
+    template<typename Read>
+    std::array<uint8_t, REGISTERS> merge(Read read) {
+        std::array<uint8_t, REGISTERS> merged{};
+        for (size_t s = 0; s <= this->mask_; ++s) {
+            for (size_t i = 0; i < REGISTERS; ++i) {
+                merged[i] = std::max(merged[i], read(this->shards_[s].cell[i]));
+            }
+        }
+        return merged;
+    }
+
+public:
+    using Base::Base;
+
+    template<typename T>
+    void add(const T& item) {
+        uint64_t h = mix(std::hash<T>{}(item));
+        size_t index = h >> (64 - P);
+        uint8_t rank = uint8_t(std::countl_zero((h << P) | (uint64_t(1) << (P - 1))) + 1);
+
+        std::atomic<uint8_t>& reg = this->local()[index];
+        uint8_t current = reg.load(std::memory_order_relaxed);
+        while (rank > current && !reg.compare_exchange_weak(current, rank, std::memory_order_relaxed)) {}
+    }
+
+    double value() {
+        return estimate(merge([](std::atomic<uint8_t>& r) { return r.load(std::memory_order_relaxed); }));
+    }
+
+    double snapshot_and_reset() {
+        return estimate(merge([](std::atomic<uint8_t>& r) { return r.exchange(0, std::memory_order_relaxed); }));
+    }
+};
+
+} // namespace percpu
+
+// Scrape метрик: значения за интервал, без остановки писателей
+void percpu_example() {
+    percpu::Counter<> requests;
+    percpu::MaxReducer<int64_t> max_latency_us;
+    percpu::ApproxDistinct<> unique_clients;
+
+    {
+        std::vector<std::jthread> workers;
+        for (int t = 0; t < 4; ++t) {
+            workers.emplace_back([&, t] {
+                for (int i = 0; i < 10'000; ++i) {
+                    requests.increment();
+                    max_latency_us.update((i * 37 + t) % 5000);
+                    unique_clients.add(i % 3000);   // 3000 разных клиентов
+                }
+            });
+        }
+    }
+
+    std::cout << "requests: " << requests.snapshot_and_reset()
+              << ", max latency: " << max_latency_us.snapshot_and_reset() << " us"
+              << ", ~unique clients: " << std::llround(unique_clients.snapshot_and_reset()) << '\n';
+    std::cout << "after reset: " << requests.value() << '\n';
+}
+
+percpu_example();
+
+// Бенчмарк: 64 потока инкрементируют один логический счётчик
+void percpu_counter_benchmark() {
+    constexpr int threads = 64;
+    constexpr int per_thread = 200'000;
+
+    auto run = [&](const char* name, auto&& increment, auto&& total) {
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::vector<std::jthread> workers;
+            for (int t = 0; t < threads; ++t) {
+                workers.emplace_back([&] {
+                    for (int i = 0; i < per_thread; ++i) increment();
+                });
+            }
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << ns / (double(threads) * per_thread) << " ns/increment"
+                  << (total() == int64_t(threads) * per_thread ? "" : "  WRONG TOTAL") << '\n';
+    };
+
+    std::atomic<int64_t> plain{0};
+    run("plain std::atomic (seq_cst)", [&] { ++plain; }, [&] { return plain.load(); });
+
+    std::atomic<int64_t> relaxed{0};
+    run("plain std::atomic (relaxed)", [&] { relaxed.fetch_add(1, std::memory_order_relaxed); },
+        [&] { return relaxed.load(); });
+
+    AlignedCounter aligned{};
+    run("AlignedCounter", [&] { ++aligned.value; }, [&] { return int64_t(aligned.value.load()); });
+
+    ShardedCounter<16> hashed;
+    run("ShardedCounter<16> (hash thread::id)", [&] { hashed.increment(); }, [&] { return int64_t(hashed.total()); });
+
+    percpu::Counter<> by_cpu(percpu::ShardBy::Cpu);
+    run("percpu::Counter (sched_getcpu)", [&] { by_cpu.increment(); }, [&] { return by_cpu.value(); });
+
+    percpu::Counter<> by_slot(percpu::ShardBy::ThreadSlot, threads);
+    run("percpu::Counter (thread slot)", [&] { by_slot.increment(); }, [&] { return by_slot.value(); });
+
+    // Точность ApproxDistinct
+    percpu::ApproxDistinct<> distinct;
+    for (uint64_t i = 0; i < 1'000'000; ++i) distinct.add(i);
+    std::cout << "ApproxDistinct(1e6 distinct): " << std::llround(distinct.value()) << '\n';
+}
+
+percpu_counter_benchmark();
+
 /*
  * DEBUGGING TIPS:
  * 
@@ -4,7 +4,8 @@
  * ============================================
  * 
  * Подробное руководство по корутинам C++20 с практическими
- * примерами generator<T>, task<T> и async операций.
+ * примерами generator<T>, task<T> и async операций,
+ * плюс runtime (epoll + таймеры) для исполнения task<T>.
  * 
  * Требования: C++20 или выше
  * Компиляция: g++ -std=c++20 -fcoroutines coroutines.cpp
@@ -34,6 +35,211 @@
  * становится корутиной.
  */
 
+// ============================================
+// 📌 FRAME ALLOCATOR - ПУЛ ФРЕЙМОВ КОРУТИН
+// ============================================
+
+/*
+ * Каждый вызов корутины = аллокация фрейма (HALO срабатывает редко).
+ * Размер фрейма известен компилятору, а promise_type может перегрузить
+ * operator new/delete - через это и подключаем пул:
+ *
+ * - size-классы (64 .. 2048 байт), у каждого потока свои free-list'ы:
+ *   освобождённый фрейм уходит в список текущего потока, без атомиков
+ * - фрейм больше 2048 байт - обычный ::operator new
+ * - per-request арена: корутина, объявленная как
+ *   task<T> f(std::allocator_arg_t, frame_alloc::FrameArena&, ...),
+ *   берёт фрейм из арены (operator new с allocator_arg); delete - no-op,
+ *   память возвращается разом через arena.reset() после запроса
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+namespace frame_alloc {
+
+// Заголовок перед фреймом: откуда память (пул / куча / арена).
+// 16 байт - сохраняем выравнивание фрейма под max_align_t
+struct alignas(16) FrameHeader {
+    uint32_t size_class;
+};
+
+inline constexpr uint32_t ARENA = 0xFFFFFFFE;
+inline constexpr uint32_t LARGE = 0xFFFFFFFF;
+
+inline constexpr std::array<size_t, 10> CLASS_SIZES = {64, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048};
+inline constexpr size_t MAX_CACHED_PER_CLASS = 1024;   // Больше - отдаём обратно в кучу
+
+inline uint32_t class_of(size_t bytes) {
+    for (uint32_t i = 0; i < CLASS_SIZES.size(); ++i) {
+        if (bytes <= CLASS_SIZES[i]) return i;
+    }
+    return LARGE;
+}
+
+struct Stats {
+    uint64_t frames = 0;           // Всего выделено фреймов
+    uint64_t heap_allocations = 0; // Из них пошли в ::operator new
+    uint64_t arena_frames = 0;     // Из них из арены запроса
+};
+
+// Free-list'ы потока: односвязные списки через сами свободные блоки.
+// Тривиально разрушаемый - фреймы, освобождаемые при выходе потока уже после
+// release(), корректно уходят в кучу
+class ThreadCache {
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    std::array<FreeBlock*, CLASS_SIZES.size()> heads_{};
+    std::array<size_t, CLASS_SIZES.size()> counts_{};
+
+public:
+    Stats stats;
+    bool enabled = true;   // false - каждый фрейм через кучу (для сравнения в бенчмарке)
+
+    void release() {
+        enabled = false;
+        for (uint32_t cls = 0; cls < heads_.size(); ++cls) {
+            while (void* block = pop(cls)) ::operator delete(block);
+        }
+    }
+
+    void* pop(uint32_t cls) {
+        FreeBlock* block = heads_[cls];
+        if (!block) return nullptr;
+        heads_[cls] = block->next;
+        --counts_[cls];
+        return block;
+    }
+
+    bool push(uint32_t cls, void* memory) {
+        if (!enabled || counts_[cls] >= MAX_CACHED_PER_CLASS) return false;
+        auto* block = static_cast<FreeBlock*>(memory);
+        block->next = heads_[cls];
+        heads_[cls] = block;
+        ++counts_[cls];
+        return true;
+    }
+};
+
+inline thread_local constinit ThreadCache tls_cache{};
+
+struct ThreadCacheGuard {
+    ~ThreadCacheGuard() { tls_cache.release(); }
+};
+
+inline ThreadCache& thread_cache() {
+    thread_local ThreadCacheGuard guard;   // Вернёт закэшированные блоки в кучу при выходе потока
+    (void)guard;
+    return tls_cache;
+}
+
+inline Stats stats() { return thread_cache().stats; }
+inline void reset_stats() { thread_cache().stats = {}; }
+inline void set_enabled(bool enabled) {
+    if (!enabled) thread_cache().release();
+    thread_cache().enabled = enabled;
+}
+
+// --- Арена запроса: bump-аллокатор блоками, освобождение разом ---
+class FrameArena {
+    static constexpr size_t BLOCK_SIZE = 16 * 1024;
+
+    std::vector<std::unique_ptr<std::byte[]>> blocks_;
+    size_t current_ = 0;   // Индекс блока, из которого режем
+    size_t offset_ = 0;
+
+public:
+    void* allocate(size_t bytes) {
+        bytes = (bytes + 15) & ~size_t(15);
+        if (bytes > BLOCK_SIZE) {
+            throw std::bad_alloc();   // Фрейм-гигант: такие корутины - не для арены
+        }
+        if (blocks_.empty() || offset_ + bytes > BLOCK_SIZE) {
+            if (!blocks_.empty()) ++current_;
+            if (current_ == blocks_.size()) {
+                blocks_.push_back(std::make_unique<std::byte[]>(BLOCK_SIZE));
+            }
+            offset_ = 0;
+        }
+        void* p = blocks_[current_].get() + offset_;
+        offset_ += bytes;
+        return p;
+    }
+
+    // Все фреймы запроса уже уничтожены - память переиспользуется, блоки остаются
+    void reset() {
+        current_ = 0;
+        offset_ = 0;
+    }
+
+    size_t capacity() const { return blocks_.size() * BLOCK_SIZE; }
+};
+
+inline void* allocate(size_t frame_size) {
+    ThreadCache& cache = thread_cache();
+    ++cache.stats.frames;
+
+    size_t total = sizeof(FrameHeader) + frame_size;
+    uint32_t cls = class_of(total);
+
+    void* memory = nullptr;
+    if (cls != LARGE && cache.enabled) memory = cache.pop(cls);
+    if (!memory) {
+        ++cache.stats.heap_allocations;
+        memory = ::operator new(cls == LARGE ? total : CLASS_SIZES[cls]);
+    }
+
+    auto* header = new (memory) FrameHeader{cls};
+    return header + 1;
+}
+
+inline void* allocate_in(FrameArena& arena, size_t frame_size) {
+    ThreadCache& cache = thread_cache();
+    ++cache.stats.frames;
+    ++cache.stats.arena_frames;
+
+    auto* header = new (arena.allocate(sizeof(FrameHeader) + frame_size)) FrameHeader{ARENA};
+    return header + 1;
+}
+
+inline void deallocate(void* frame) noexcept {
+    FrameHeader* header = static_cast<FrameHeader*>(frame) - 1;
+    uint32_t cls = header->size_class;
+    if (cls == ARENA) return;                                   // Вернётся с arena.reset()
+    if (cls != LARGE && thread_cache().push(cls, header)) return;
+    ::operator delete(header);
+}
+
+// Базовый класс для promise_type: все операторы new/delete фрейма
+struct pooled_frame {
+    static void* operator new(std::size_t size) {
+        return allocate(size);
+    }
+
+    // Свободная корутина: f(std::allocator_arg, arena, args...)
+    template<typename... Args>
+    static void* operator new(std::size_t size, std::allocator_arg_t, FrameArena& arena, Args&...) {
+        return allocate_in(arena, size);
+    }
+
+    // Метод-корутина: первым аргументом идёт объект (*this)
+    template<typename Self, typename... Args>
+    static void* operator new(std::size_t size, Self&, std::allocator_arg_t, FrameArena& arena, Args&...) {
+        return allocate_in(arena, size);
+    }
+
+    static void operator delete(void* frame, std::size_t) noexcept {
+        deallocate(frame);
+    }
+};
+
+} // namespace frame_alloc
+
 // ============================================
 // 📌 GENERATOR<T> - ПОЛНАЯ РЕАЛИЗАЦИЯ
 // ============================================
@@ -41,8 +247,8 @@
 template<typename T>
 class generator {
 public:
-    // Promise type - управляет поведением корутины
-    struct promise_type {
+    // Promise type - управляет поведением корутины (фрейм - из frame_alloc)
+    struct promise_type : frame_alloc::pooled_frame {
         T current_value_;
         std::exception_ptr exception_;
         
@@ -204,7 +410,7 @@ generator<std::string> lines_from_string(const std::string& text) {
 template<typename T>
 class task {
 public:
-    struct promise_type {
+    struct promise_type : frame_alloc::pooled_frame {
         std::optional<T> result_;
         std::exception_ptr exception_;
         std::coroutine_handle<> continuation_;
@@ -321,7 +527,7 @@ private:
 template<>
 class task<void> {
 public:
-    struct promise_type {
+    struct promise_type : frame_alloc::pooled_frame {
         std::exception_ptr exception_;
         std::coroutine_handle<> continuation_;
         
@@ -450,13 +656,703 @@ auto task_result = complex_computation();
 int final_value = task_result.get();
 std::cout << "Final result: " << final_value << '\n';
 
+// ============================================
+// 📌 COROUTINE RUNTIME - EPOLL + TIMER WHEEL + RUN QUEUE НА ЯДРО
+// ============================================
+
+/*
+ * task<T> выше ленивый и исполняется только через get() - "снаружи" его
+ * некому возобновлять. Runtime даёт корутинам исполнителя:
+ *
+ * - Worker = поток на ядро: своя очередь готовых корутин, свой epoll, свои таймеры.
+ *   Корутина, уснувшая на Worker'е, на нём же и просыпается - без блокировок
+ * - Таймеры - колесо (timing wheel) с тиком 1 мс: вставка и срабатывание O(1),
+ *   узел таймера живёт прямо в фрейме корутины (в awaiter'е) - без аллокаций
+ * - Сокеты: accept/read/write/connect сначала пробуют syscall (non-blocking fd);
+ *   EAGAIN → корутина паркуется на fd, epoll (edge-triggered) будит Worker,
+ *   тот повторяет операцию и ставит корутину в очередь готовых
+ * - Пробуждённые корутины не возобновляются рекурсивно из обработчика события:
+ *   они ставятся в run queue, а цепочки task<T> внутри продолжаются через
+ *   symmetric transfer (final_awaiter → continuation)
+ */
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <semaphore>
+#include <thread>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace runtime {
+
+using namespace std::chrono_literals;
+
+class Runtime;
+
+// Узел таймерного колеса (лежит внутри sleep-awaiter'а, т.е. во фрейме корутины)
+struct TimerNode {
+    TimerNode* next = nullptr;
+    uint64_t deadline_tick = 0;
+    std::coroutine_handle<> handle;
+};
+
+// Ожидание готовности fd: attempt() повторяет операцию после события epoll
+struct IoWaiter {
+    std::coroutine_handle<> handle;
+    bool (*attempt)(IoWaiter*) = nullptr;   // true - операция завершена (успех или ошибка)
+};
+
+// Поколение номера fd: close_socket() увеличивает его, и слот Worker'а со старым
+// поколением считается чужим, даже если номер уже достался новому сокету (ядро само
+// убирает закрытый fd из epoll, а Worker об этом не узнаёт). Таблица полосатая:
+// коллизия fd & (N-1) стоит лишь лишнего epoll_ctl
+inline std::atomic<uint32_t>& fd_generation(int fd) {
+    static constexpr size_t STRIPES = 4096;
+    static std::atomic<uint32_t> generations[STRIPES];
+    return generations[size_t(fd) & (STRIPES - 1)];
+}
+
+// --- Worker: event loop одного ядра ---
+class Worker {
+public:
+    static constexpr size_t WHEEL_SLOTS = 4096;              // Оборот колеса ≈ 4 с
+    static constexpr auto TICK = std::chrono::milliseconds(1);
+    static constexpr size_t RESUME_BUDGET = 256;
+
+private:
+    struct FdSlot {
+        IoWaiter* reader = nullptr;
+        IoWaiter* writer = nullptr;
+        uint32_t generation = 0;
+        bool registered = false;
+    };
+
+    static inline thread_local Worker* current_ = nullptr;
+
+    Runtime& runtime_;
+    size_t index_;
+    int epoll_fd_;
+    int wakeup_fd_;
+
+    // Очередь готовых корутин - только поток Worker'а
+    std::deque<std::coroutine_handle<>> ready_;
+
+    // Входящие из других потоков (spawn, переход между Worker'ами)
+    std::mutex inbox_mutex_;
+    std::atomic<bool> inbox_pending_{false};   // Чтобы не брать мьютекс на каждом круге
+    std::vector<std::coroutine_handle<>> inbox_;
+    std::vector<std::coroutine_handle<>> inbox_swap_;
+
+    std::vector<FdSlot> fds_;
+    std::vector<epoll_event> events_ = std::vector<epoll_event>(256);
+
+    std::vector<TimerNode*> wheel_ = std::vector<TimerNode*>(WHEEL_SLOTS, nullptr);
+    std::chrono::steady_clock::time_point epoch_ = std::chrono::steady_clock::now();
+    uint64_t current_tick_ = 0;
+    size_t timer_count_ = 0;
+
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+
+public:
+    Worker(Runtime& runtime, size_t index) : runtime_(runtime), index_(index) {
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epoll_fd_ < 0 || wakeup_fd_ < 0) {
+            throw std::runtime_error("Worker: epoll/eventfd failed");
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = -1;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev);
+    }
+
+    ~Worker() {
+        close(wakeup_fd_);
+        close(epoll_fd_);
+    }
+
+    Worker(const Worker&) = delete;
+    Worker& operator=(const Worker&) = delete;
+
+    static Worker* current() { return current_; }
+
+    // Для awaitable'ов, которым нужен "свой" Worker: вне его потока - понятная ошибка
+    static Worker& this_worker() {
+        if (!current_) throw std::runtime_error("runtime: awaitable used outside of a Worker thread");
+        return *current_;
+    }
+    size_t index() const { return index_; }
+
+    void start(bool pin) {
+        thread_ = std::thread([this, pin] {
+            if (pin) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(index_ % std::max(1u, std::thread::hardware_concurrency()), &set);
+                pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            }
+            run();
+        });
+    }
+
+    void stop() {
+        stop_.store(true, std::memory_order_relaxed);
+        wake();
+    }
+
+    void join() {
+        if (thread_.joinable()) thread_.join();
+    }
+
+    // Поставить корутину в очередь: из своего потока - напрямую, из чужого - через inbox
+    void schedule(std::coroutine_handle<> h) {
+        if (current_ == this) {
+            ready_.push_back(h);
+            return;
+        }
+        bool was_empty;
+        {
+            std::lock_guard lock(inbox_mutex_);
+            was_empty = inbox_.empty();
+            inbox_.push_back(h);
+            inbox_pending_.store(true, std::memory_order_release);
+        }
+        if (was_empty) wake();  // Пачка schedule() подряд = один write в eventfd
+    }
+
+    void add_timer(TimerNode* node, std::chrono::steady_clock::duration delay) {
+        uint64_t ticks = uint64_t((delay + TICK - std::chrono::nanoseconds(1)) / TICK);
+        node->deadline_tick = ticks_now() + std::max<uint64_t>(ticks, 1);
+        uint64_t slot_tick = std::max(node->deadline_tick, current_tick_ + 1);
+        TimerNode*& head = wheel_[slot_tick & (WHEEL_SLOTS - 1)];
+        node->next = head;
+        head = node;
+        ++timer_count_;
+    }
+
+    // Припарковать корутину до готовности fd (EPOLLIN - чтение, EPOLLOUT - запись)
+    void wait_io(int fd, uint32_t direction, IoWaiter* waiter) {
+        if (size_t(fd) >= fds_.size()) fds_.resize(std::max(fds_.size() * 2, size_t(fd) + 1));
+        FdSlot& slot = fds_[fd];
+        uint32_t generation = fd_generation(fd).load(std::memory_order_acquire);
+        if (slot.registered && slot.generation != generation) {
+            slot = {};   // Номер fd переиспользован: прежний сокет закрыт (возможно, на другом Worker'е)
+        }
+        (direction == EPOLLIN ? slot.reader : slot.writer) = waiter;
+
+        if (!slot.registered) {
+            // Один раз на сокет, сразу оба направления: дальше - без epoll_ctl на каждую операцию.
+            // EEXIST - fd всё ещё в epoll (коллизия поколений или закрыт не через close_socket)
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            ev.data.fd = fd;
+            int rc = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+            if (rc < 0 && errno == EEXIST) rc = epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+            if (rc == 0) {
+                slot.registered = true;
+                slot.generation = generation;
+            }
+        }
+    }
+
+    // Обязательно перед close(fd): номер fd может сразу достаться новому сокету
+    void forget(int fd) {
+        if (size_t(fd) < fds_.size() && fds_[fd].registered) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+            fds_[fd] = {};
+        }
+    }
+
+private:
+    void wake() {
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeup_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    uint64_t ticks_now() const {
+        return uint64_t((std::chrono::steady_clock::now() - epoch_) / TICK);
+    }
+
+    void run() {
+        current_ = this;
+        while (!stop_.load(std::memory_order_relaxed)) {
+            take_inbox();
+
+            // Не больше RESUME_BUDGET подряд, затем обязательно таймеры и I/O:
+            // корутины, которые всё время уступают друг другу, не заморят event loop
+            for (size_t budget = RESUME_BUDGET; budget > 0 && !ready_.empty(); --budget) {
+                auto h = ready_.front();
+                ready_.pop_front();
+                h.resume();
+            }
+
+            advance_timers();
+            poll(ready_.empty() ? next_timeout_ms() : 0);
+        }
+        current_ = nullptr;
+    }
+
+    void take_inbox() {
+        if (!inbox_pending_.load(std::memory_order_acquire)) return;
+        {
+            std::lock_guard lock(inbox_mutex_);
+            inbox_swap_.swap(inbox_);
+            inbox_pending_.store(false, std::memory_order_relaxed);
+        }
+        ready_.insert(ready_.end(), inbox_swap_.begin(), inbox_swap_.end());
+        inbox_swap_.clear();
+    }
+
+    void poll(int timeout_ms) {
+        int n = epoll_wait(epoll_fd_, events_.data(), int(events_.size()), timeout_ms);
+        for (int i = 0; i < n; ++i) {
+            int fd = events_[i].data.fd;
+            if (fd < 0) {
+                uint64_t counter;
+                ssize_t ignored = read(wakeup_fd_, &counter, sizeof(counter));
+                (void)ignored;
+                continue;
+            }
+
+            uint32_t ev = events_[i].events;
+            FdSlot& slot = fds_[fd];
+            bool error = ev & (EPOLLERR | EPOLLHUP);
+            if (slot.reader && (ev & (EPOLLIN | EPOLLRDHUP) || error)) complete(slot.reader);
+            if (slot.writer && (ev & EPOLLOUT || error)) complete(slot.writer);
+        }
+    }
+
+    // Повторяем операцию; всё ещё EAGAIN (ложное пробуждение) - ждём следующего фронта
+    void complete(IoWaiter*& waiter) {
+        if (waiter->attempt(waiter)) {
+            ready_.push_back(waiter->handle);
+            waiter = nullptr;
+        }
+    }
+
+    void advance_timers() {
+        if (timer_count_ == 0) {
+            current_tick_ = ticks_now();
+            return;
+        }
+
+        uint64_t now = ticks_now();
+        // Отстали больше, чем на оборот, - достаточно пройти колесо один раз
+        uint64_t from = now - current_tick_ > WHEEL_SLOTS ? now - WHEEL_SLOTS + 1 : current_tick_ + 1;
+
+        for (uint64_t tick = from; tick <= now; ++tick) {
+            TimerNode** link = &wheel_[tick & (WHEEL_SLOTS - 1)];
+            while (TimerNode* node = *link) {
+                if (node->deadline_tick <= now) {
+                    *link = node->next;
+                    ready_.push_back(node->handle);
+                    --timer_count_;
+                } else {
+                    link = &node->next;   // Срок через полный оборот (или больше)
+                }
+            }
+        }
+        current_tick_ = now;
+    }
+
+    // Сколько спать в epoll_wait: до ближайшего непустого слота колеса
+    int next_timeout_ms() const {
+        if (timer_count_ == 0) return -1;
+        for (uint64_t tick = current_tick_ + 1; tick <= current_tick_ + WHEEL_SLOTS; ++tick) {
+            if (wheel_[tick & (WHEEL_SLOTS - 1)]) {
+                // Знаковая арифметика: с uint64_t просроченный срок дал бы огромное
+                // беззнаковое "осталось", а после усечения в int - отрицательный (вечный) таймаут
+                auto deadline = epoch_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(TICK * int64_t(tick));
+                auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+                return int(std::clamp<int64_t>(left.count(), 0, INT_MAX));
+            }
+        }
+        return int(WHEEL_SLOTS);
+    }
+};
+
+// Корутина верхнего уровня: фрейм сам себя удаляет по завершении
+struct detached_task {
+    struct promise_type : frame_alloc::pooled_frame {
+        detached_task get_return_object() {
+            return {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+    std::coroutine_handle<promise_type> handle;
+};
+
+// --- Runtime: по Worker'у на ядро ---
+class Runtime {
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<size_t> next_worker_{0};
+    std::atomic<size_t> live_tasks_{0};
+
+public:
+    explicit Runtime(size_t threads = std::max(1u, std::thread::hardware_concurrency()), bool pin = true) {
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.push_back(std::make_unique<Worker>(*this, i));
+        }
+        for (auto& w : workers_) w->start(pin);
+    }
+
+    // Остановка не дожидается незавершённых корутин: сначала wait_all()
+    ~Runtime() {
+        for (auto& w : workers_) w->stop();
+        for (auto& w : workers_) w->join();
+    }
+
+    Runtime(const Runtime&) = delete;
+    Runtime& operator=(const Runtime&) = delete;
+
+    size_t size() const { return workers_.size(); }
+    Worker& worker(size_t i) { return *workers_[i]; }
+
+    // Запуск "в фоне": Worker'ы по кругу (или конкретный)
+    void spawn(task<void> t) {
+        spawn_on(*workers_[next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size()], std::move(t));
+    }
+
+    void spawn_on(Worker& worker, task<void> t) {
+        live_tasks_.fetch_add(1, std::memory_order_relaxed);
+        worker.schedule(run_detached(std::move(t)).handle);
+    }
+
+    // Дождаться завершения всех spawn'нутых корутин (из не-Worker потока)
+    void wait_all() {
+        for (size_t n = live_tasks_.load(); n != 0; n = live_tasks_.load()) {
+            live_tasks_.wait(n);
+        }
+    }
+
+    // Выполнить task на runtime и синхронно получить результат
+    template<typename T>
+    T block_on(task<T> t) {
+        std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> result;
+        std::exception_ptr error;
+        std::binary_semaphore done{0};
+
+        spawn([](task<T> t, auto& result, std::exception_ptr& error, std::binary_semaphore& done) -> task<void> {
+            try {
+                if constexpr (std::is_void_v<T>) {
+                    co_await t;
+                    result.emplace(true);
+                } else {
+                    result.emplace(co_await t);
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+            done.release();
+        }(std::move(t), result, error, done));
+
+        done.acquire();
+        if (error) std::rethrow_exception(error);
+        if constexpr (!std::is_void_v<T>) return std::move(*result);
+    }
+
+private:
+    detached_task run_detached(task<void> t) {
+        try {
+            co_await t;
+        } catch (const std::exception& e) {
+            std::cerr << "Unhandled exception in spawned task: " << e.what() << '\n';
+        }
+        if (live_tasks_.fetch_sub(1, std::memory_order_release) == 1) live_tasks_.notify_all();
+    }
+};
+
+// --- Awaitables ---
+
+// Неблокирующий sleep: узел таймера во фрейме, будит свой же Worker
+struct sleep_for {
+    std::chrono::steady_clock::duration delay;
+    TimerNode node{};
+
+    explicit sleep_for(std::chrono::steady_clock::duration d) : delay(d) {}
+
+    bool await_ready() const noexcept { return delay <= delay.zero(); }
+    void await_suspend(std::coroutine_handle<> h) {
+        node.handle = h;
+        Worker::this_worker().add_timer(&node, delay);
+    }
+    void await_resume() const noexcept {}
+};
+
+// Уступить Worker другим готовым корутинам
+struct yield {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) const { Worker::this_worker().schedule(h); }
+    void await_resume() const noexcept {}
+};
+
+// Перейти на другой Worker (например, из I/O-корутины на "CPU" ядро)
+struct schedule_on {
+    Worker& target;
+    bool await_ready() const noexcept { return Worker::current() == &target; }
+    void await_suspend(std::coroutine_handle<> h) const { target.schedule(h); }
+    void await_resume() const noexcept {}
+};
+
+// Общий каркас: Op(fd) → ssize_t, EAGAIN - ждать готовности direction
+template<typename Op>
+struct io_awaiter : IoWaiter {
+    int fd;
+    uint32_t direction;
+    Op op;
+    ssize_t result = 0;
+
+    io_awaiter(int fd, uint32_t direction, Op op) : fd(fd), direction(direction), op(op) {}
+
+    bool try_once() {
+        result = op(fd);
+        if (result < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS) return false;
+            result = -errno;
+        }
+        return true;
+    }
+
+    bool await_ready() { return try_once(); }
+
+    void await_suspend(std::coroutine_handle<> h) {
+        handle = h;
+        attempt = [](IoWaiter* self) { return static_cast<io_awaiter*>(self)->try_once(); };
+        Worker::this_worker().wait_io(fd, direction, this);
+    }
+
+    // >= 0 - результат syscall'а, < 0 - -errno
+    ssize_t await_resume() const noexcept { return result; }
+};
+
+inline auto async_read(int fd, void* buffer, size_t size) {
+    return io_awaiter(fd, EPOLLIN, [=](int fd) { return ::recv(fd, buffer, size, 0); });
+}
+
+inline auto async_write(int fd, const void* data, size_t size) {
+    return io_awaiter(fd, EPOLLOUT, [=](int fd) { return ::send(fd, data, size, MSG_NOSIGNAL); });
+}
+
+// Результат - fd нового (non-blocking) соединения
+inline auto async_accept(int listen_fd) {
+    return io_awaiter(listen_fd, EPOLLIN, [](int fd) -> ssize_t {
+        return ::accept4(fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    });
+}
+
+// Первый вызов - connect(), после EPOLLOUT - итог из SO_ERROR
+inline auto async_connect(int fd, const sockaddr_in& address) {
+    return io_awaiter(fd, EPOLLOUT, [address, started = false](int fd) mutable -> ssize_t {
+        if (!started) {
+            started = true;
+            return ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        }
+        int error = 0;
+        socklen_t len = sizeof(error);
+        getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len);
+        errno = error;
+        return error == 0 ? 0 : -1;
+    });
+}
+
+// Дописать всё (send может взять только часть)
+inline task<ssize_t> write_all(int fd, const char* data, size_t size) {
+    size_t sent = 0;
+    while (sent < size) {
+        ssize_t n = co_await async_write(fd, data + sent, size - sent);
+        if (n < 0) co_return n;
+        sent += size_t(n);
+    }
+    co_return ssize_t(sent);
+}
+
+// Закрывать лучше на Worker'е, который ждал fd (снимет регистрацию сразу); на любом
+// другом - новое поколение номера заставит Worker'ы перерегистрировать его заново
+inline void close_socket(int fd) {
+    if (Worker* w = Worker::current()) w->forget(fd);
+    fd_generation(fd).fetch_add(1, std::memory_order_release);
+    ::close(fd);
+}
+
+inline int make_socket() {
+    return ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+}
+
+} // namespace runtime
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Пример: echo-сервер и клиенты на одном Runtime
+// ────────────────────────────────────────────────────────────────────────────────────
+
+task<void> echo_session(int fd) {
+    char buffer[4096];
+    while (true) {
+        ssize_t n = co_await runtime::async_read(fd, buffer, sizeof(buffer));
+        if (n <= 0) break;  // 0 - клиент закрыл соединение, < 0 - ошибка
+        if (co_await runtime::write_all(fd, buffer, size_t(n)) < 0) break;
+    }
+    runtime::close_socket(fd);
+}
+
+task<void> echo_server(runtime::Runtime& rt, int listen_fd, int connections) {
+    for (int i = 0; i < connections; ++i) {
+        ssize_t client = co_await runtime::async_accept(listen_fd);
+        if (client < 0) break;
+        rt.spawn(echo_session(int(client)));  // Сессии расходятся по Worker'ам
+    }
+    runtime::close_socket(listen_fd);
+}
+
+task<std::string> echo_client(sockaddr_in address, std::string message) {
+    int fd = runtime::make_socket();
+    if (co_await runtime::async_connect(fd, address) < 0) {
+        runtime::close_socket(fd);
+        throw std::runtime_error("connect failed");
+    }
+
+    co_await runtime::write_all(fd, message.data(), message.size());
+
+    std::string reply(message.size(), '\0');
+    size_t received = 0;
+    while (received < reply.size()) {
+        ssize_t n = co_await runtime::async_read(fd, reply.data() + received, reply.size() - received);
+        if (n <= 0) break;
+        received += size_t(n);
+    }
+    runtime::close_socket(fd);
+    reply.resize(received);
+    co_return reply;
+}
+
+void coroutine_runtime_example() {
+    runtime::Runtime rt(2);
+
+    int listen_fd = runtime::make_socket();
+    int opt = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;  // Любой свободный порт
+    bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    listen(listen_fd, 128);
+    socklen_t len = sizeof(address);
+    getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &len);
+
+    constexpr int clients = 8;
+    rt.spawn(echo_server(rt, listen_fd, clients));
+
+    auto run_clients = [](sockaddr_in address) -> task<int> {
+        int ok = 0;
+        for (int i = 0; i < clients; ++i) {
+            std::string message = "hello #" + std::to_string(i);
+            if (co_await echo_client(address, message) == message) ++ok;
+            co_await runtime::sleep_for(std::chrono::milliseconds(1));  // Таймер, а не sleep потока
+        }
+        co_return ok;
+    };
+
+    std::cout << "Echo round-trips OK: " << rt.block_on(run_clients(address)) << "/" << clients << '\n';
+    rt.wait_all();
+}
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Бенчмарк: цена переключения и 100k спящих корутин
+// ────────────────────────────────────────────────────────────────────────────────────
+
+void coroutine_runtime_benchmark() {
+    using clock = std::chrono::steady_clock;
+
+    // 1. Переключение через run queue: yield = suspend + постановка в очередь + resume
+    {
+        runtime::Runtime rt(1);
+        constexpr int switches = 2'000'000;
+        auto start = clock::now();
+        rt.block_on([]() -> task<void> {
+            for (int i = 0; i < switches; ++i) co_await runtime::yield{};
+        }());
+        auto ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        std::cout << "yield (switch via run queue): " << ns / switches << " ns\n";
+    }
+
+    // 2. Для сравнения: ping-pong двух потоков через binary_semaphore (переключение ОС)
+    {
+        constexpr int rounds = 100'000;
+        std::binary_semaphore ping{0}, pong{0};
+        std::thread other([&] {
+            for (int i = 0; i < rounds; ++i) {
+                ping.acquire();
+                pong.release();
+            }
+        });
+        auto start = clock::now();
+        for (int i = 0; i < rounds; ++i) {
+            ping.release();
+            pong.acquire();
+        }
+        auto ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        other.join();
+        std::cout << "thread ping-pong (semaphore): " << ns / (2 * rounds) << " ns per switch\n";
+    }
+
+    // 3. 100k одновременно спящих корутин: таймеры в колесе, ни одного потока на корутину
+    {
+        runtime::Runtime rt;
+        constexpr int sleepers = 100'000;
+        constexpr auto delay = std::chrono::milliseconds(200);
+        std::atomic<int64_t> total_late_us{0};
+        std::atomic<int64_t> max_late_us{0};
+
+        auto start = clock::now();
+        for (int i = 0; i < sleepers; ++i) {
+            rt.spawn([](auto delay, auto& total, auto& max_late) -> task<void> {
+                auto begin = clock::now();
+                co_await runtime::sleep_for(delay);
+                auto late = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - begin - delay).count();
+                total.fetch_add(late, std::memory_order_relaxed);
+                int64_t prev = max_late.load(std::memory_order_relaxed);
+                while (late > prev && !max_late.compare_exchange_weak(prev, late)) {}
+            }(delay, total_late_us, max_late_us));
+        }
+        auto spawned = clock::now();
+        rt.wait_all();
+        auto finished = clock::now();
+
+        auto ms = [](auto d) { return std::chrono::duration<double, std::milli>(d).count(); };
+        std::cout << sleepers << " sleepers x " << delay.count() << "ms on " << rt.size() << " workers: spawn "
+                  << ms(spawned - start) << " ms, all done after " << ms(finished - start) << " ms"
+                  << ", lateness avg " << total_late_us.load() / sleepers << " us, max "
+                  << max_late_us.load() << " us\n";
+    }
+}
+
+coroutine_runtime_example();
+coroutine_runtime_benchmark();
+
 // ============================================
 // 📌 CUSTOM AWAITABLES
 // ============================================
 
-// Awaitable для задержки (симуляция async sleep)
+// Awaitable для задержки
 struct sleep_awaiter {
     std::chrono::milliseconds duration_;
+    runtime::TimerNode timer_;
     
     explicit sleep_awaiter(std::chrono::milliseconds duration)
         : duration_(duration) {}
@@ -465,9 +1361,15 @@ struct sleep_awaiter {
         return duration_.count() <= 0;
     }
     
-    void await_suspend(std::coroutine_handle<> handle) const {
-        // В реальной реализации здесь был бы timer в event loop
-        // Для примера просто делаем sleep
+    void await_suspend(std::coroutine_handle<> handle) {
+        // Внутри runtime::Runtime - таймер event loop'а, поток не блокируется
+        if (auto* worker = runtime::Worker::current()) {
+            timer_.handle = handle;
+            worker->add_timer(&timer_, duration_);
+            return;
+        }
+        
+        // Вне runtime будить некому - блокирующий sleep и resume на месте
         std::this_thread::sleep_for(duration_);
         handle.resume();
     }
@@ -480,7 +1382,8 @@ sleep_awaiter sleep(std::chrono::milliseconds duration) {
     return sleep_awaiter{duration};
 }
 
-task<void> delayed_print(const std::string& msg, int delay_ms) {
+// msg по значению: после настоящей приостановки ссылка на временный объект повиснет
+task<void> delayed_print(std::string msg, int delay_ms) {
     std::cout << "Waiting " << delay_ms << "ms...\n";
     co_await sleep(std::chrono::milliseconds{delay_ms});
     std::cout << msg << '\n';
@@ -505,7 +1408,7 @@ struct value_awaiter {
 template<typename T>
 class lazy {
 public:
-    struct promise_type {
+    struct promise_type : frame_alloc::pooled_frame {
         T value_;
         std::exception_ptr exception_;
         
@@ -580,6 +1483,8 @@ std::cout << "Result: " << lazy_result << '\n';
 // 📌 ASYNC PRODUCER-CONSUMER
 // ============================================
 
+// Однопоточная версия: только корутины одного потока, без ограничения размера.
+// Между потоками/пулами - channel<T> ниже
 template<typename T>
 class async_queue {
 private:
@@ -635,6 +1540,420 @@ public:
     }
 };
 
+// ────────────────────────────────────────────────────────────────────────────────────
+// channel<T>: ограниченный MPMC-канал для корутин из разных потоков
+// ────────────────────────────────────────────────────────────────────────────────────
+
+/*
+ * async_queue выше - только для одного потока: std::queue без синхронизации,
+ * рост без предела, а push_awaiter возобновляет получателя прямо внутри
+ * своего await_suspend (рекурсия по стеку).
+ *
+ * channel<T>:
+ * - значения - в lock-free кольце (Vyukov MPMC, capacity - степень двойки);
+ *   try_push/try_pop - быстрый путь без блокировок
+ * - полон → producer засыпает (backpressure), пуст → засыпает consumer;
+ *   очереди спящих - под мьютексом, который берётся только на медленном пути
+ * - разбудить = передать значение напрямую (handoff) и отдать корутину её
+ *   Worker'у через schedule(): никакого resume() внутри чужого await_suspend
+ * - close(): новые push получают false, спящие просыпаются;
+ *   consumer'ы дочитывают остаток, pop() после опустошения → std::nullopt
+ */
+
+#include <bit>
+
+template<typename T>
+class channel {
+    struct alignas(64) Cell {
+        std::atomic<size_t> sequence;
+        alignas(T) std::byte storage[sizeof(T)];
+
+        T* value() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    // Спящая корутина; живёт в её фрейме (внутри awaiter'а)
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        runtime::Worker* worker = nullptr;   // Куда вернуть при пробуждении
+        Waiter* next = nullptr;
+    };
+
+    // Интрузивная FIFO спящих
+    struct WaitList {
+        Waiter* head = nullptr;
+        Waiter* tail = nullptr;
+
+        void push_back(Waiter* w) {
+            w->next = nullptr;
+            (tail ? tail->next : head) = w;
+            tail = w;
+        }
+
+        Waiter* pop_front() {
+            Waiter* w = head;
+            if (w) {
+                head = w->next;
+                if (!head) tail = nullptr;
+            }
+            return w;
+        }
+    };
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> head_{0};     // Следующая позиция для push
+    alignas(64) std::atomic<size_t> tail_{0};     // Следующая позиция для pop
+    alignas(64) std::atomic<bool> closed_{false};
+
+    // Медленный путь: счётчики спящих читаются без мьютекса после каждой операции
+    std::atomic<size_t> waiting_producers_{0};
+    std::atomic<size_t> waiting_consumers_{0};
+    std::mutex mutex_;
+    WaitList producers_;
+    WaitList consumers_;
+
+public:
+    explicit channel(size_t capacity)
+        : mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+          cells_(std::make_unique<Cell[]>(mask_ + 1)) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~channel() {
+        std::optional<T> value;
+        while (pop_raw(value)) {}
+    }
+
+    channel(const channel&) = delete;
+    channel& operator=(const channel&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    // --- Быстрый путь (можно звать и не из корутины) ---
+
+    // value перемещается только при успехе
+    bool try_push(T& value) {
+        if (closed()) return false;
+        if (!push_raw(value)) return false;
+        after_push();
+        return true;
+    }
+
+    bool try_push(T&& value) { return try_push(value); }
+
+    std::optional<T> try_pop() {
+        std::optional<T> value;
+        if (!pop_raw(value)) return std::nullopt;
+        after_pop();
+        return value;
+    }
+
+    // Забрать всё, что осталось (обычно после close())
+    template<typename F>
+    size_t drain(F&& consume) {
+        size_t n = 0;
+        while (auto value = try_pop()) {
+            consume(std::move(*value));
+            ++n;
+        }
+        return n;
+    }
+
+    // --- Awaitables ---
+
+    struct push_awaiter : Waiter {
+        channel& ch;
+        T value;
+        bool ok = false;
+
+        push_awaiter(channel& ch, T value) : ch(ch), value(std::move(value)) {}
+
+        bool await_ready() {
+            if (ch.closed()) return true;
+            ok = ch.try_push(value);
+            return ok;
+        }
+
+        bool await_suspend(std::coroutine_handle<> h) { return ch.park_producer(this, h); }
+
+        // false - канал закрыт, значение не принято
+        bool await_resume() const noexcept { return ok; }
+    };
+
+    struct pop_awaiter : Waiter {
+        channel& ch;
+        std::optional<T> result;
+
+        explicit pop_awaiter(channel& ch) : ch(ch) {}
+
+        bool await_ready() {
+            result = ch.try_pop();
+            return result.has_value() || ch.closed();
+        }
+
+        bool await_suspend(std::coroutine_handle<> h) { return ch.park_consumer(this, h); }
+
+        // nullopt - канал закрыт и пуст
+        std::optional<T> await_resume() {
+            if (!result) result = ch.try_pop();   // Разбудил close(): дочитываем остаток
+            return std::move(result);
+        }
+    };
+
+    push_awaiter push(T value) { return push_awaiter{*this, std::move(value)}; }
+    pop_awaiter pop() { return pop_awaiter{*this}; }
+
+    void close() {
+        closed_.store(true, std::memory_order_release);
+
+        std::vector<Waiter*> woken;
+        {
+            std::lock_guard lock(mutex_);
+            while (Waiter* w = producers_.pop_front()) woken.push_back(w);   // ok остаётся false
+            while (Waiter* w = consumers_.pop_front()) woken.push_back(w);
+            waiting_producers_.store(0);
+            waiting_consumers_.store(0);
+        }
+        for (Waiter* w : woken) wake(w);
+    }
+
+private:
+    // --- Кольцо Vyukov: sequence ячейки говорит, чья сейчас очередь ---
+
+    bool push_raw(T& value) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(seq) - intptr_t(pos);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    new (cell.storage) T(std::move(value));
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // Полон
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Результат - в optional: T не обязан иметь конструктор по умолчанию
+    bool pop_raw(std::optional<T>& out) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(seq) - intptr_t(pos + 1);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out.emplace(std::move(*cell.value()));
+                    cell.value()->~T();
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // Пуст
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // --- Медленный путь ---
+    //
+    // Без потерянных пробуждений: засыпающий сначала увеличивает waiting_*,
+    // потом повторяет попытку; будящий сначала делает операцию, потом читает
+    // waiting_*. seq_cst с обеих сторон - хотя бы один увидит другого
+
+    bool park_producer(push_awaiter* w, std::coroutine_handle<> h) {
+        Waiter* woken = nullptr;
+        {
+            std::lock_guard lock(mutex_);
+            waiting_producers_.fetch_add(1);
+            if (!closed() && !push_raw(w->value)) {
+                w->handle = h;
+                w->worker = runtime::Worker::current();
+                producers_.push_back(w);
+                return true;
+            }
+            waiting_producers_.fetch_sub(1);
+            w->ok = !closed();
+            if (w->ok) woken = take_consumer_locked();
+        }
+        if (woken) wake(woken);
+        return false;   // Не засыпаем
+    }
+
+    bool park_consumer(pop_awaiter* w, std::coroutine_handle<> h) {
+        Waiter* woken = nullptr;
+        {
+            std::lock_guard lock(mutex_);
+            waiting_consumers_.fetch_add(1);
+            bool popped = pop_raw(w->result);   // result пуст: await_ready ничего не забрал
+            if (!popped && !closed()) {
+                w->handle = h;
+                w->worker = runtime::Worker::current();
+                consumers_.push_back(w);
+                return true;
+            }
+            waiting_consumers_.fetch_sub(1);
+            if (popped) woken = take_producer_locked();
+        }
+        if (woken) wake(woken);
+        return false;
+    }
+
+    void after_push() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_consumers_.load(std::memory_order_relaxed) == 0) return;
+        Waiter* woken;
+        {
+            std::lock_guard lock(mutex_);
+            woken = take_consumer_locked();
+        }
+        if (woken) wake(woken);
+    }
+
+    void after_pop() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_producers_.load(std::memory_order_relaxed) == 0) return;
+        Waiter* woken;
+        {
+            std::lock_guard lock(mutex_);
+            woken = take_producer_locked();
+        }
+        if (woken) wake(woken);
+    }
+
+    // Handoff: забираем значение для спящего consumer'а; будим уже после unlock
+    Waiter* take_consumer_locked() {
+        auto* w = static_cast<pop_awaiter*>(consumers_.head);
+        if (!w) return nullptr;
+        if (!pop_raw(w->result)) return nullptr;   // Значение уже забрал кто-то на быстром пути
+        consumers_.pop_front();
+        waiting_consumers_.fetch_sub(1);
+        return w;
+    }
+
+    // Handoff: кладём значение спящего producer'а в освободившуюся ячейку
+    Waiter* take_producer_locked() {
+        auto* w = static_cast<push_awaiter*>(producers_.head);
+        if (!w) return nullptr;
+        if (!push_raw(w->value)) return nullptr;   // Ячейку уже занял быстрый push
+        producers_.pop_front();
+        waiting_producers_.fetch_sub(1);
+        w->ok = true;
+        return w;
+    }
+
+    // Корутину возобновляет её Worker (не рекурсивно из чужого await_suspend);
+    // вне runtime - на месте, но уже без мьютекса
+    static void wake(Waiter* w) {
+        if (w->worker) {
+            w->worker->schedule(w->handle);
+        } else {
+            w->handle.resume();
+        }
+    }
+};
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Пример: конвейер I/O → CPU через channel
+// ────────────────────────────────────────────────────────────────────────────────────
+
+task<void> channel_producer(channel<int>& ch, int from, int count, std::atomic<int>& producers_left) {
+    for (int i = from; i < from + count; ++i) {
+        if (!co_await ch.push(i)) break;   // Канал закрыт
+    }
+    if (producers_left.fetch_sub(1) == 1) ch.close();   // Последний producer закрывает
+}
+
+task<void> channel_consumer(channel<int>& ch, std::atomic<int64_t>& sum) {
+    int64_t local = 0;
+    while (auto value = co_await ch.pop()) {
+        local += *value;
+    }
+    sum.fetch_add(local);
+}
+
+void channel_example() {
+    runtime::Runtime rt(2);
+    channel<int> ch(16);   // Маленькая ёмкость - producer'ы будут засыпать
+    std::atomic<int> producers_left{3};
+    std::atomic<int64_t> sum{0};
+
+    for (int p = 0; p < 3; ++p) rt.spawn(channel_producer(ch, p * 1000, 1000, producers_left));
+    for (int c = 0; c < 2; ++c) rt.spawn(channel_consumer(ch, sum));
+    rt.wait_all();
+
+    std::cout << "channel sum: " << sum.load() << " (expected " << int64_t(2999) * 3000 / 2 << ")\n";
+}
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Бенчмарк: пропускная способность по числу producer'ов/consumer'ов
+// ────────────────────────────────────────────────────────────────────────────────────
+
+void channel_benchmark() {
+    constexpr int messages = 2'000'000;
+
+    // 1. Корутины на Runtime: засыпание/пробуждение через Worker'ы
+    for (size_t workers : {1, 2, 4}) {
+        for (int n : {1, 4, 16}) {
+            for (size_t capacity : {64, 1024}) {
+                runtime::Runtime rt(workers);
+                channel<int> ch(capacity);
+                std::atomic<int> producers_left{n};
+                std::atomic<int64_t> sum{0};
+
+                auto start = std::chrono::steady_clock::now();
+                for (int p = 0; p < n; ++p) rt.spawn(channel_producer(ch, p * (messages / n), messages / n, producers_left));
+                for (int c = 0; c < n; ++c) rt.spawn(channel_consumer(ch, sum));
+                rt.wait_all();
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                std::cout << "coroutines " << workers << " workers, " << n << "P/" << n << "C, capacity "
+                          << capacity << ": " << messages / seconds / 1e6 << " M msg/s\n";
+            }
+        }
+    }
+
+    // 2. Только быстрый путь из обычных потоков (try_push/try_pop со спином)
+    for (int n : {1, 2, 4}) {
+        channel<int> ch(1024);
+        std::atomic<int> consumed{0};
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::jthread> threads;
+        for (int p = 0; p < n; ++p) {
+            threads.emplace_back([&] {
+                for (int i = 0; i < messages / n; ++i) {
+                    while (!ch.try_push(i)) std::this_thread::yield();
+                }
+            });
+        }
+        for (int c = 0; c < n; ++c) {
+            threads.emplace_back([&] {
+                while (consumed.load(std::memory_order_relaxed) < messages / n * n) {
+                    if (ch.try_pop()) consumed.fetch_add(1, std::memory_order_relaxed);
+                    else std::this_thread::yield();
+                }
+            });
+        }
+        threads.clear();   // join
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "threads try_push/try_pop " << n << "P/" << n << "C: " << messages / seconds / 1e6 << " M msg/s\n";
+    }
+}
+
+channel_example();
+channel_benchmark();
+
 // ============================================
 // 📌 SYMMETRIC TRANSFER
 // ============================================
@@ -730,11 +2049,13 @@ try {
  *    Компилятор может оптимизировать аллокацию на стек
  * 
  * 2. Кастомный аллокатор через promise_type::operator new
+ *    (frame_alloc: size-классы + free-list'ы потока, арена запроса)
  * 
  * 3. Symmetric transfer вместо рекурсивных вызовов
  */
 
-// Пример кастомного аллокатора
+// Пример кастомного аллокатора (минимальный хук; рабочий пул -
+// frame_alloc::pooled_frame, от него наследуют promise_type у task/lazy/generator)
 template<typename T>
 class task_with_custom_allocator {
 public:
@@ -754,6 +2075,79 @@ public:
     };
 };
 
+// ────────────────────────────────────────────────────────────────────────────────────
+// Бенчмарк: пул фреймов vs куча vs арена запроса
+// ────────────────────────────────────────────────────────────────────────────────────
+
+// level1/level2/level3 без вывода - чтобы мерить только корутины
+task<int> bench_level3() {
+    co_return 3;
+}
+
+task<int> bench_level2() {
+    int val = co_await bench_level3();
+    co_return val + 2;
+}
+
+task<int> bench_level1() {
+    int val = co_await bench_level2();
+    co_return val + 1;
+}
+
+// Глубокая цепочка: depth + 1 фреймов на вызов
+task<int> bench_chain(int depth) {
+    if (depth == 0) co_return 0;
+    int val = co_await bench_chain(depth - 1);
+    co_return val + 1;
+}
+
+// Та же цепочка, но фреймы - из арены запроса
+task<int> bench_chain(std::allocator_arg_t, frame_alloc::FrameArena& arena, int depth) {
+    if (depth == 0) co_return 0;
+    int val = co_await bench_chain(std::allocator_arg, arena, depth - 1);
+    co_return val + 1;
+}
+
+void frame_allocator_benchmark() {
+    constexpr int iterations = 200'000;
+
+    auto measure = [](const char* name, auto&& run_once) {
+        frame_alloc::reset_stats();
+        long checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) checksum += run_once();
+        auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        auto s = frame_alloc::stats();
+        std::cout << name << ": " << ns / iterations << " ns per chain, frames " << s.frames
+                  << ", heap allocations " << s.heap_allocations << ", arena frames " << s.arena_frames
+                  << " (checksum " << checksum << ")\n";
+    };
+
+    for (bool pooled : {false, true}) {
+        frame_alloc::set_enabled(pooled);
+        std::cout << (pooled ? "--- frame pool ---\n" : "--- global new/delete ---\n");
+        measure("level1→level2→level3", [] { return bench_level1().get(); });
+        measure("chain depth 32      ", [] { return bench_chain(32).get(); });
+        measure("generator range(0,16)", [] {
+            int sum = 0;
+            for (int v : range(0, 16)) sum += v;
+            return sum;
+        });
+    }
+
+    // Арена: фреймы запроса режутся подряд, освобождение - одним reset()
+    frame_alloc::FrameArena arena;
+    std::cout << "--- per-request arena ---\n";
+    measure("chain depth 32      ", [&arena] {
+        int result = bench_chain(std::allocator_arg, arena, 32).get();
+        arena.reset();  // Все фреймы уже уничтожены вместе с task
+        return result;
+    });
+}
+
+frame_allocator_benchmark();
+
 // ============================================
 // 📌 ПРАКТИЧЕСКИЕ СОВЕТЫ
 // ============================================
@@ -801,12 +2195,15 @@ public:
  * ✓ task<T>       - для async операций
  * ✓ lazy<T>       - ленивые вычисления (старт по запросу)
  * ✓ Custom awaitables - интеграция с event loops
+ * ✓ runtime::Runtime   - поток на ядро: run queue, timer wheel, epoll-сокеты
+ * ✓ channel<T>         - ограниченный MPMC-канал между корутинами разных потоков
  * 
  * ВАЖНЫЕ КОНЦЕПЦИИ:
  * ✓ Promise type        - управляет поведением корутины
  * ✓ Symmetric transfer  - избежать stack overflow
  * ✓ Awaitable interface - await_ready/suspend/resume
  * ✓ Exception handling  - unhandled_exception()
+ * ✓ Frame allocator     - пул фреймов через promise_type::operator new
  * 
  * ПРЕИМУЩЕСТВА:
  * ✓ Ленивые вычисления (generator)
@@ -9,6 +9,7 @@
  * - std::format (форматирование C++20)
  * - std::filesystem (файловая система C++17)
  * - Serialization patterns (паттерны сериализации)
+ * - Parallel CSV import (mmap + SIMD + параллельные чанки)
  * 
  * Требования: C++20 для format, C++17 для filesystem
  */
@@ -664,6 +665,450 @@ std::cout << to_json(json_person) << '\n';
 //   "salary": 60000
 // }
 
+// ════════════════════════════════════════════════════════════════════════════════════
+// 📌 PARALLEL CSV - БОЛЬШИЕ CSV: mmap + ПАРАЛЛЕЛЬНЫЕ ЧАНКИ + SIMD
+// ════════════════════════════════════════════════════════════════════════════════════
+
+// getline + istringstream (выше) на каждом поле: аллокация std::string, разбор
+// через locale-aware потоки, один поток на весь файл. На 40 GB это часы.
+//
+// csv::Reader:
+// - файл отображается в память (mmap), поля - std::string_view прямо в отображение
+// - файл режется на чанки по границам записей с учётом кавычек (перевод строки
+//   внутри "..." - не граница), чанки разбираются параллельно
+// - разделитель / перевод строки ищутся SSE2 по 16 байт
+// - типизированные колонки через std::from_chars (без locale, без исключений)
+
+#include <string_view>
+#include <charconv>
+#include <thread>
+#include <span>
+#include <variant>
+#include <algorithm>
+#include <system_error>
+#include <deque>
+#include <atomic>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace csv {
+
+struct ReaderOptions {
+    char delimiter = ',';
+    char quote = '"';
+    bool has_header = true;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+};
+
+enum class ColumnType { Int64, Double, String };
+
+using Column = std::variant<std::vector<int64_t>, std::vector<double>, std::vector<std::string_view>>;
+
+struct Columns {
+    std::vector<Column> columns;
+    size_t rows = 0;
+    size_t bad_rows = 0;  // Не хватило полей или число не разобралось
+};
+
+// Ближайший разделитель или '\n' (кавычки обрабатываются отдельно)
+inline const char* find_field_end(const char* p, const char* end, char delimiter) {
+#if defined(__SSE2__)
+    const __m128i delim = _mm_set1_epi8(delimiter);
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, delim),
+                                                  _mm_cmpeq_epi8(chunk, newline)));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == delimiter || *p == '\n') return p;
+    }
+    return end;
+}
+
+class Reader {
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    ReaderOptions options_;
+    std::vector<std::string> header_;
+    const char* body_begin_ = nullptr;                 // Первая запись после заголовка
+    std::vector<std::deque<std::string>> unescaped_;  // Поля с "" для колонок read_columns
+
+public:
+    explicit Reader(const fs::path& path, ReaderOptions options = {}) : options_(options) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), path.string());
+
+        struct stat st{};
+        ::fstat(fd, &st);
+        size_ = static_cast<size_t>(st.st_size);
+
+        if (size_ > 0) {
+            void* map = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map == MAP_FAILED) {
+                int err = errno;
+                ::close(fd);
+                throw std::system_error(err, std::generic_category(), "mmap");
+            }
+            data_ = static_cast<const char*>(map);
+            ::madvise(map, size_, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+
+        if (options_.has_header) read_header();
+    }
+
+    ~Reader() {
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+    }
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    const std::vector<std::string>& header() const { return header_; }
+
+    // fn(chunk, fields) вызывается ПАРАЛЛЕЛЬНО из разных потоков (по потоку на чанк);
+    // внутри чанка - по порядку. Views живут, пока жив Reader
+    template <typename F>
+    size_t for_each_record(F&& fn) {
+        auto ranges = split();
+        std::vector<size_t> counts(ranges.size());
+
+        run_parallel(ranges.size(), [&](size_t chunk) {
+            std::vector<std::string_view> fields;
+            std::deque<std::string> storage;
+            counts[chunk] = parse_range(ranges[chunk].first, ranges[chunk].second, fields, storage, false,
+                                        [&](std::span<const std::string_view> record) { fn(chunk, record); });
+        });
+
+        size_t total = 0;
+        for (size_t c : counts) total += c;
+        return total;
+    }
+
+    // Колонки по схеме; строки - views в отображение файла, живут, пока жив Reader
+    Columns read_columns(const std::vector<ColumnType>& schema) {
+        auto ranges = split();
+        std::vector<Columns> partial(ranges.size());
+        std::vector<std::deque<std::string>> storage(ranges.size());
+
+        run_parallel(ranges.size(), [&](size_t chunk) {
+            Columns& out = partial[chunk];
+            out.columns = make_columns(schema);
+
+            std::vector<std::string_view> fields;
+            std::vector<int64_t> ints(schema.size());
+            std::vector<double> doubles(schema.size());
+
+            parse_range(ranges[chunk].first, ranges[chunk].second, fields, storage[chunk], true,
+                        [&](std::span<const std::string_view> record) {
+                if (record.size() < schema.size() ||
+                    !convert(schema, record, ints, doubles)) {
+                    ++out.bad_rows;
+                    return;
+                }
+                for (size_t i = 0; i < schema.size(); ++i) {
+                    switch (schema[i]) {
+                        case ColumnType::Int64:
+                            std::get<0>(out.columns[i]).push_back(ints[i]);
+                            break;
+                        case ColumnType::Double:
+                            std::get<1>(out.columns[i]).push_back(doubles[i]);
+                            break;
+                        case ColumnType::String:
+                            std::get<2>(out.columns[i]).push_back(record[i]);
+                            break;
+                    }
+                }
+                ++out.rows;
+            });
+        });
+
+        // Перемещение deque не двигает сами строки - views остаются валидными
+        for (auto& s : storage) unescaped_.push_back(std::move(s));
+
+        // Склейка чанков в исходном порядке строк
+        Columns result;
+        result.columns = make_columns(schema);
+        for (auto& part : partial) {
+            result.rows += part.rows;
+            result.bad_rows += part.bad_rows;
+            for (size_t i = 0; i < schema.size(); ++i) {
+                std::visit([&](auto& dst) {
+                    auto& src = std::get<std::decay_t<decltype(dst)>>(part.columns[i]);
+                    dst.insert(dst.end(), src.begin(), src.end());
+                }, result.columns[i]);
+            }
+        }
+        return result;
+    }
+
+private:
+    void read_header() {
+        std::vector<std::string_view> fields;
+        const char* end = data_ + size_;
+        const char* p = data_;
+        std::deque<std::string> storage;
+        if (p < end) {
+            p = parse_record(p, end, fields, storage);
+            for (auto f : fields) header_.emplace_back(f);
+        }
+        body_begin_ = p;
+    }
+
+    static std::vector<Column> make_columns(const std::vector<ColumnType>& schema) {
+        std::vector<Column> columns;
+        for (ColumnType t : schema) {
+            switch (t) {
+                case ColumnType::Int64: columns.emplace_back(std::vector<int64_t>{}); break;
+                case ColumnType::Double: columns.emplace_back(std::vector<double>{}); break;
+                case ColumnType::String: columns.emplace_back(std::vector<std::string_view>{}); break;
+            }
+        }
+        return columns;
+    }
+
+    static bool convert(const std::vector<ColumnType>& schema, std::span<const std::string_view> record,
+                        std::vector<int64_t>& ints, std::vector<double>& doubles) {
+        for (size_t i = 0; i < schema.size(); ++i) {
+            std::string_view f = record[i];
+            const char* last = f.data() + f.size();
+            if (schema[i] == ColumnType::Int64) {
+                auto [ptr, ec] = std::from_chars(f.data(), last, ints[i]);
+                if (ec != std::errc{} || ptr != last) return false;
+            } else if (schema[i] == ColumnType::Double) {
+                auto [ptr, ec] = std::from_chars(f.data(), last, doubles[i]);
+                if (ec != std::errc{} || ptr != last) return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename F>
+    void run_parallel(size_t chunks, F&& fn) {
+        if (chunks == 1) {
+            fn(0);
+            return;
+        }
+        std::vector<std::jthread> workers;
+        workers.reserve(chunks);
+        for (size_t c = 0; c < chunks; ++c) workers.emplace_back([&fn, c] { fn(c); });
+    }  // jthread присоединяется в деструкторе
+
+    // Границы чанков с учётом кавычек. Проход 1 (параллельный): чётность числа
+    // кавычек в каждом чанке; префиксный xor даёт состояние "внутри кавычек"
+    // в начале чанка. Дальше от номинальной границы до первого '\n' вне кавычек.
+    // Предполагается RFC 4180: кавычки встречаются только в quoted-полях ("" внутри)
+    std::vector<std::pair<const char*, const char*>> split() {
+        const char* begin = body_begin_ ? body_begin_ : data_;
+        const char* end = data_ + size_;
+        size_t length = end - begin;
+
+        size_t chunks = std::max<size_t>(1, std::min<size_t>(options_.threads, length / (1 << 20)));
+        std::vector<const char*> nominal(chunks + 1);
+        for (size_t c = 0; c <= chunks; ++c) nominal[c] = begin + length * c / chunks;
+
+        std::vector<uint8_t> parity(chunks);
+        run_parallel(chunks, [&](size_t c) {
+            parity[c] = std::count(nominal[c], nominal[c + 1], options_.quote) & 1;  // Векторизуется
+        });
+
+        std::vector<std::pair<const char*, const char*>> ranges(chunks);
+        const char* start = begin;
+        uint8_t in_quotes = 0;
+        for (size_t c = 0; c < chunks; ++c) {
+            in_quotes ^= parity[c];  // Состояние в начале чанка c + 1
+            const char* next = end;
+            if (c + 1 < chunks) {
+                bool quoted = in_quotes;
+                for (const char* p = nominal[c + 1]; p < end; ++p) {
+                    if (*p == options_.quote) quoted = !quoted;
+                    else if (*p == '\n' && !quoted) { next = p + 1; break; }
+                }
+                next = std::max(next, start);
+            }
+            ranges[c] = {start, next};
+            start = next;
+        }
+        return ranges;
+    }
+
+    template <typename F>
+    size_t parse_range(const char* p, const char* end, std::vector<std::string_view>& fields,
+                       std::deque<std::string>& storage, bool keep_storage, F&& on_record) {
+        size_t records = 0;
+        while (p < end) {
+            if (!keep_storage) storage.clear();
+            p = parse_record(p, end, fields, storage);
+            if (fields.size() == 1 && fields[0].empty()) continue;  // Пустая строка
+            on_record(std::span<const std::string_view>(fields));
+            ++records;
+        }
+        return records;
+    }
+
+    // Одна запись начиная с p; возвращает начало следующей.
+    // Поля с "" раскодируются в storage (deque: адреса строк стабильны)
+    const char* parse_record(const char* p, const char* end, std::vector<std::string_view>& fields,
+                             std::deque<std::string>& storage) const {
+        fields.clear();
+        const char delim = options_.delimiter;
+        const char quote = options_.quote;
+
+        while (true) {
+            if (p < end && *p == quote) {
+                // "..." с "" внутри: схлопываем на месте (страница копируется при записи)
+                const char* start = ++p;
+                auto* q = static_cast<const char*>(std::memchr(p, quote, end - p));
+                if (!q) {  // Незакрытая кавычка - поле до конца данных
+                    fields.emplace_back(start, end - start);
+                    p = end;
+                } else if (q + 1 < end && q[1] == quote) {
+                    // "" внутри - единственный случай, когда поле копируется
+                    std::string& unescaped = storage.emplace_back();
+                    while (q) {
+                        unescaped.append(p, q);
+                        p = q + 1;
+                        if (p < end && *p == quote) {
+                            unescaped += quote;
+                            ++p;
+                            q = static_cast<const char*>(std::memchr(p, quote, end - p));
+                            continue;
+                        }
+                        break;
+                    }
+                    if (!q) {
+                        unescaped.append(p, end);
+                        p = end;
+                    }
+                    fields.emplace_back(unescaped);
+                } else {
+                    fields.emplace_back(start, q - start);  // Без копии
+                    p = q + 1;
+                }
+                // После закрывающей кавычки ожидаем разделитель или конец строки
+                p = find_field_end(p, end, delim);
+            } else {
+                const char* q = find_field_end(p, end, delim);
+                size_t len = q - p;
+                if (q < end && *q == '\n' && len > 0 && q[-1] == '\r') --len;  // CRLF
+                fields.emplace_back(p, len);
+                p = q;
+            }
+
+            if (p >= end) return p;
+            if (*p == '\n') return p + 1;
+            ++p;  // Разделитель
+            if (p >= end) {
+                fields.emplace_back();  // "a,b," в конце файла - пустое последнее поле
+                return p;
+            }
+        }
+    }
+};
+
+} // namespace csv
+
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Использование: колонки, потоковый обход, сравнение с getline
+// ────────────────────────────────────────────────────────────────────────────────────
+
+void write_sample_csv(const fs::path& path, size_t rows) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << "id,name,city,amount,comment\n";
+    std::string line;
+    for (size_t i = 0; i < rows; ++i) {
+        line = std::to_string(i) + ",user" + std::to_string(i) + ",";
+        line += (i % 10 == 0) ? "\"Portland, OR\"" : "Berlin";
+        line += "," + std::to_string(i % 1000) + "." + std::to_string(i % 100) + ",";
+        line += (i % 50 == 0) ? "\"multi\nline \"\"quoted\"\"\"" : "ok";
+        line += '\n';
+        ofs << line;
+    }
+}
+
+void csv_import_benchmark() {
+    const fs::path path = fs::temp_directory_path() / "csv_import_bench.csv";
+    write_sample_csv(path, 2'000'000);
+    double mb = fs::file_size(path) / double(1 << 20);
+
+    auto seconds_of = [](auto&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // Базовая линия: getline + istringstream (не понимает кавычки - только для скорости)
+    size_t baseline_rows = 0;
+    double baseline = seconds_of([&] {
+        std::ifstream ifs(path);
+        std::string line, field;
+        std::getline(ifs, line);
+        while (std::getline(ifs, line)) {
+            std::istringstream iss(line);
+            std::vector<std::string> fields;
+            while (std::getline(iss, field, ',')) fields.push_back(field);
+            ++baseline_rows;
+        }
+    });
+    std::cout << "getline/istringstream: " << mb / baseline << " MB/s\n";
+
+    const std::vector<csv::ColumnType> schema = {
+        csv::ColumnType::Int64, csv::ColumnType::String, csv::ColumnType::String,
+        csv::ColumnType::Double, csv::ColumnType::String};
+
+    std::vector<unsigned> thread_counts = {1};
+    if (std::thread::hardware_concurrency() > 1) thread_counts.push_back(std::thread::hardware_concurrency());
+
+    for (unsigned threads : thread_counts) {
+        csv::Columns table;
+        double t = seconds_of([&] {
+            csv::Reader reader(path, {.threads = threads});
+            table = reader.read_columns(schema);
+            // string_view колонок живут, пока жив reader - здесь только считаем
+        });
+        std::cout << "csv::Reader x" << threads << ": " << mb / t << " MB/s, rows " << table.rows
+                  << ", bad " << table.bad_rows << '\n';
+    }
+
+    fs::remove(path);
+}
+
+{
+    const fs::path sample = fs::temp_directory_path() / "csv_sample.csv";
+    write_sample_csv(sample, 100);
+
+    csv::Reader reader(sample);
+    std::cout << "Columns: " << reader.header().size() << '\n';
+
+    // Типизированные колонки
+    auto table = reader.read_columns({csv::ColumnType::Int64, csv::ColumnType::String,
+                                      csv::ColumnType::String, csv::ColumnType::Double,
+                                      csv::ColumnType::String});
+    const auto& amounts = std::get<std::vector<double>>(table.columns[3]);
+    std::cout << "Rows: " << table.rows << ", amount[10] = " << amounts[10] << '\n';
+    std::cout << "city[0] = " << std::get<std::vector<std::string_view>>(table.columns[2])[0] << '\n';
+
+    // Потоковый обход: callback вызывается из нескольких потоков
+    std::atomic<size_t> multiline{0};
+    reader.for_each_record([&](size_t, std::span<const std::string_view> fields) {
+        if (fields.size() > 4 && fields[4].find('\n') != std::string_view::npos) ++multiline;
+    });
+    std::cout << "Multiline comments: " << multiline << '\n';
+
+    fs::remove(sample);
+}
+
+csv_import_benchmark();
+
 // ════════════════════════════════════════════════════════════════════════════════════
 // 📌 BEST PRACTICES - РЕКОМЕНДАЦИИ ПО I/O
 // ════════════════════════════════════════════════════════════════════════════════════
@@ -715,6 +1160,7 @@ std::cout << to_json(json_person) << '\n';
 // • std::format (C++20) - современное форматирование строк
 // • std::filesystem (C++17) - работа с путями, файлами, каталогами
 // • Serialization - бинарная и текстовая сериализация
+// • Parallel CSV - mmap, чанки по границам записей с учётом кавычек, SIMD, from_chars
 // 
 // 🛠️ Best Practices:
 // • RAII - автоматическое управление файловыми дескрипторами
@@ -9,6 +9,7 @@
  * - weak_ptr (наблюдение без владения)
  * - RAII паттерны
  * - Move semantics
+ * - Пул по классам размеров (thread-local магазины, pmr)
  * 
  * Компиляция: g++ -std=c++20 smart_pointers_memory.cpp
  */
@@ -785,6 +786,490 @@ std::string* str1 = pool.allocate("Hello");
 std::string* str2 = pool.allocate("World");
 pool.deallocate(str1);
 
+// ────────────────────────────────────────────────────────────────────────────────────
+// Пул по классам размеров: thread-local магазины, pmr, RAII-хэндлы
+// ────────────────────────────────────────────────────────────────────────────────────
+
+/*
+ * ObjectPool выше - один тип, фиксированный размер, не потокобезопасен;
+ * LoggingAllocator всё равно идёт в глобальный operator new. Для объектов,
+ * которые рождаются и умирают миллионами в секунду (запросы, сообщения,
+ * узлы), нужен общий слой:
+ *
+ * - классы размеров 16..1024 байт: типы близкого размера делят один класс,
+ *   блоки нарезаются из slab'ов по 64 КБ, без заголовка на блок -
+ *   размер при освобождении известен (sizeof(T), n у аллокатора, bytes у pmr)
+ * - магазин потока на каждый класс: allocate/deallocate - push/pop в массив
+ *   без атомиков; центральный список (мьютекс) трогается раз в MAGAZINE блоков
+ * - освобождение из чужого потока: блок просто ложится в магазин
+ *   освобождающего потока, переполнение уходит в центральный список -
+ *   поток-производитель заберёт его при следующей дозаправке
+ * - всё, что больше 1024 байт или выровнено сильнее 64, - в глобальный operator new
+ * - slab'ы не возвращаются ОС: пул держит пиковый объём, поэтому
+ *   high-water по каждому классу - это и есть его реальная цена в памяти
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <thread>
+
+namespace mempool {
+
+inline constexpr size_t MAX_SMALL = 1024;
+inline constexpr size_t SLAB_SIZE = 64 * 1024;
+inline constexpr size_t SLAB_ALIGN = 64;
+inline constexpr size_t MAGAZINE = 32;
+
+// До 128 - шаг 16, дальше - шаг 64 (потери на округление ≤ 25%)
+inline constexpr std::array<uint32_t, 20> CLASS_SIZES = {
+    16, 32, 48, 64, 80, 96, 112, 128,
+    192, 256, 320, 384, 448, 512, 576, 640, 768, 832, 896, 1024,
+};
+inline constexpr size_t CLASS_COUNT = CLASS_SIZES.size();
+
+// Индекс класса по ceil(size / 16): таблица вместо поиска
+inline constexpr auto CLASS_BY_GRANULE = [] {
+    std::array<uint8_t, MAX_SMALL / 16 + 1> table{};
+    size_t c = 0;
+    for (size_t g = 0; g < table.size(); ++g) {
+        while (CLASS_SIZES[c] < g * 16) ++c;
+        table[g] = uint8_t(c);
+    }
+    return table;
+}();
+
+// Класс для (size, align) или CLASS_COUNT, если блок не для пула.
+// Slab выровнена на 64, поэтому блок выровнен на align, если размер класса ему кратен
+inline constexpr size_t size_class(size_t size, size_t align) {
+    if (align > SLAB_ALIGN) return CLASS_COUNT;
+    size_t rounded = (std::max<size_t>(size, 1) + align - 1) & ~(align - 1);
+    if (rounded > MAX_SMALL) return CLASS_COUNT;
+    size_t c = CLASS_BY_GRANULE[(rounded + 15) / 16];
+    return CLASS_SIZES[c] % align == 0 ? c : CLASS_COUNT;
+}
+
+struct Stats {
+    size_t block_size;
+    size_t slabs;
+    size_t outstanding;   // Выдано из центрального списка: в работе + в магазинах потоков
+    size_t high_water;    // Пик outstanding (точность - до магазина на поток)
+};
+
+// Центральная часть класса: свободные блоки + нарезка slab'ов
+class SizeClass {
+private:
+    std::mutex mutex_;
+    std::vector<void*> free_;
+    std::byte* bump_ = nullptr;
+    std::byte* bump_end_ = nullptr;
+    size_t block_size_ = 0;
+    size_t slabs_ = 0;
+    size_t outstanding_ = 0;
+    size_t high_water_ = 0;
+
+public:
+    void init(size_t block_size) { block_size_ = block_size; }
+
+    // Отдаёт от 1 до want блоков; бросает bad_alloc, только если не отдал ни одного
+    size_t take(void** out, size_t want) {
+        std::lock_guard lock(mutex_);
+        size_t n = std::min(want, free_.size());
+        std::copy(free_.end() - n, free_.end(), out);
+        free_.resize(free_.size() - n);
+
+        if (n == 0 && bump_ == bump_end_) {
+            bump_ = static_cast<std::byte*>(::operator new(SLAB_SIZE, std::align_val_t{SLAB_ALIGN}));
+            bump_end_ = bump_ + SLAB_SIZE / block_size_ * block_size_;
+            ++slabs_;
+        }
+        // Нарезаем лениво: страницы slab'а трогаются по мере надобности
+        for (; n < want && bump_ != bump_end_; bump_ += block_size_) {
+            out[n++] = bump_;
+        }
+
+        outstanding_ += n;
+        high_water_ = std::max(high_water_, outstanding_);
+        return n;
+    }
+
+    void release(void* const* blocks, size_t n) {
+        std::lock_guard lock(mutex_);
+        free_.insert(free_.end(), blocks, blocks + n);
+        outstanding_ -= n;
+    }
+
+    Stats stats() {
+        std::lock_guard lock(mutex_);
+        return {block_size_, slabs_, outstanding_, high_water_};
+    }
+};
+
+inline SizeClass* central() {
+    // Не разрушается: блоки могут освобождаться из деструкторов статиков и потоков
+    static SizeClass* classes = [] {
+        auto* c = new SizeClass[CLASS_COUNT];
+        for (size_t i = 0; i < CLASS_COUNT; ++i) c[i].init(CLASS_SIZES[i]);
+        return c;
+    }();
+    return classes;
+}
+
+namespace detail {
+
+struct Magazine {
+    void* blocks[2 * MAGAZINE];
+    size_t count;
+};
+
+// Тривиально разрушаемый: после Flush поток работает напрямую с центральным списком
+struct ThreadCache {
+    Magazine magazines[CLASS_COUNT];
+    bool closed;
+};
+
+inline thread_local constinit ThreadCache cache{};
+
+struct Flush {
+    ~Flush() {
+        for (size_t c = 0; c < CLASS_COUNT; ++c) {
+            Magazine& m = cache.magazines[c];
+            if (m.count != 0) central()[c].release(m.blocks, m.count);
+            m.count = 0;
+        }
+        cache.closed = true;
+    }
+};
+
+inline ThreadCache& local() {
+    thread_local Flush flush;
+    (void)flush;
+    return cache;
+}
+
+inline void* allocate_block(size_t c) {
+    ThreadCache& tc = local();
+    Magazine& m = tc.magazines[c];
+    if (m.count == 0) {
+        if (tc.closed) {
+            void* block;
+            central()[c].take(&block, 1);
+            return block;
+        }
+        m.count = central()[c].take(m.blocks, MAGAZINE);
+    }
+    return m.blocks[--m.count];
+}
+
+inline void deallocate_block(size_t c, void* block) {
+    ThreadCache& tc = local();
+    Magazine& m = tc.magazines[c];
+    if (tc.closed) {
+        central()[c].release(&block, 1);
+        return;
+    }
+    if (m.count == 2 * MAGAZINE) {
+        // Полный магазин: верхнюю половину - в центр, нижняя остаётся на следующие free/alloc
+        central()[c].release(m.blocks + MAGAZINE, MAGAZINE);
+        m.count = MAGAZINE;
+    }
+    m.blocks[m.count++] = block;
+}
+
+} // namespace detail
+
+// Для констант size/align выбор класса сворачивается при компиляции
+inline void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+    size_t c = size_class(size, align);
+    if (c == CLASS_COUNT) return ::operator new(size, std::align_val_t{align});
+    return detail::allocate_block(c);
+}
+
+inline void deallocate(void* p, size_t size, size_t align = alignof(std::max_align_t)) noexcept {
+    size_t c = size_class(size, align);
+    if (c == CLASS_COUNT) {
+        ::operator delete(p, size, std::align_val_t{align});
+        return;
+    }
+    detail::deallocate_block(c, p);
+}
+
+inline Stats stats(size_t size_class_index) { return central()[size_class_index].stats(); }
+
+inline void report(std::ostream& out) {
+    for (size_t c = 0; c < CLASS_COUNT; ++c) {
+        Stats s = stats(c);
+        if (s.slabs == 0) continue;
+        out << "  class " << s.block_size << "B: slabs " << s.slabs
+            << " (" << s.slabs * SLAB_SIZE / 1024 << " KB), outstanding " << s.outstanding
+            << ", high-water " << s.high_water << " blocks\n";
+    }
+}
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Адаптеры: pmr, STL-аллокатор, unique_ptr / shared_ptr
+// ────────────────────────────────────────────────────────────────────────────────────
+
+// pmr сообщает размер при освобождении - заголовок на блок не нужен
+class Resource : public std::pmr::memory_resource {
+    void* do_allocate(size_t bytes, size_t align) override { return mempool::allocate(bytes, align); }
+    void do_deallocate(void* p, size_t bytes, size_t align) override { mempool::deallocate(p, bytes, align); }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        // Все экземпляры работают с одними и теми же классами
+        return dynamic_cast<const Resource*>(&other) != nullptr;
+    }
+};
+
+inline std::pmr::memory_resource* resource() {
+    static Resource* r = new Resource;   // Переживает pmr-контейнеры в статиках
+    return r;
+}
+
+// Для контейнеров и allocate_shared (rebind на control block работает сам)
+template<typename T>
+struct Allocator {
+    using value_type = T;
+
+    Allocator() = default;
+    template<typename U>
+    Allocator(const Allocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        if (n > SIZE_MAX / sizeof(T)) throw std::bad_array_new_length();
+        return static_cast<T*>(mempool::allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept { mempool::deallocate(p, n * sizeof(T), alignof(T)); }
+};
+
+template<typename T, typename U>
+bool operator==(const Allocator<T>&, const Allocator<U>&) { return true; }
+
+template<typename T>
+class ObjectPool {
+public:
+    static constexpr size_t SIZE_CLASS = size_class(sizeof(T), alignof(T));
+
+    template<typename... Args>
+    static T* create(Args&&... args) {
+        void* block = allocate(sizeof(T), alignof(T));
+        try {
+            return new (block) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(block, sizeof(T), alignof(T));
+            throw;
+        }
+    }
+
+    static void destroy(T* p) noexcept {
+        if (!p) return;
+        p->~T();
+        deallocate(p, sizeof(T), alignof(T));
+    }
+
+    // Пустой deleter: unique_ptr остаётся размером в один указатель.
+    // shared_ptr<T>(std::move(unique)) сохраняет его - объект вернётся в пул
+    struct Deleter {
+        void operator()(T* p) const noexcept { destroy(p); }
+    };
+
+    using Unique = std::unique_ptr<T, Deleter>;
+
+    template<typename... Args>
+    static Unique make_unique(Args&&... args) {
+        return Unique(create(std::forward<Args>(args)...));
+    }
+
+    // Объект и control block - один блок пула (как make_shared)
+    template<typename... Args>
+    static std::shared_ptr<T> make_shared(Args&&... args) {
+        return std::allocate_shared<T>(Allocator<T>{}, std::forward<Args>(args)...);
+    }
+
+    static Stats stats() {
+        if constexpr (SIZE_CLASS == CLASS_COUNT) return {sizeof(T), 0, 0, 0};   // Идёт мимо пула
+        else return mempool::stats(SIZE_CLASS);
+    }
+};
+
+template<typename T, typename... Args>
+typename ObjectPool<T>::Unique make_unique(Args&&... args) {
+    return ObjectPool<T>::make_unique(std::forward<Args>(args)...);
+}
+
+template<typename T, typename... Args>
+std::shared_ptr<T> make_shared(Args&&... args) {
+    return ObjectPool<T>::make_shared(std::forward<Args>(args)...);
+}
+
+} // namespace mempool
+
+// Использование:
+struct PooledRequest {
+    int64_t id;
+    std::string method;
+    std::string path;
+    std::array<char, 128> headers;
+
+    PooledRequest(int64_t id, std::string method, std::string path)
+        : id(id), method(std::move(method)), path(std::move(path)), headers{} {}
+};
+
+void pool_example() {
+    auto request = mempool::make_unique<PooledRequest>(1, "GET", "/users");   // unique_ptr<T, Deleter>
+    auto shared = mempool::make_shared<PooledRequest>(2, "POST", "/orders");
+
+    std::shared_ptr<PooledRequest> adopted = std::move(request);            // Deleter переехал в shared_ptr
+
+    // Освобождение в другом потоке: блок уйдёт в магазин этого потока
+    std::thread([moved = std::move(shared)]() mutable { moved.reset(); }).join();
+
+    // pmr-контейнеры: и вектор, и строки внутри - из пула
+    std::pmr::vector<std::pmr::string> names(mempool::resource());
+    names.emplace_back("a string long enough to skip SSO");
+    names.emplace_back("another string long enough to skip SSO");
+
+    std::vector<int, mempool::Allocator<int>> ids{1, 2, 3};
+
+    auto s = mempool::ObjectPool<PooledRequest>::stats();
+    std::cout << "PooledRequest: " << sizeof(PooledRequest) << "B -> class " << s.block_size
+              << "B, outstanding " << s.outstanding << ", high-water " << s.high_water << '\n';
+}
+
+pool_example();
+
+// ────────────────────────────────────────────────────────────────────────────────────
+// Бенчмарк: пул против глобального аллокатора
+// ────────────────────────────────────────────────────────────────────────────────────
+
+void pool_benchmark() {
+    constexpr int iterations = 2'000'000;
+    constexpr size_t live = 1000;
+    constexpr size_t batch = 256;
+
+    // Указатель "утекает" в volatile: компилятор не может выбросить new/delete
+    [[maybe_unused]] static void* volatile escape = nullptr;
+
+    auto measure = [](const char* name, int ops, auto&& body) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << name << ": " << ns / ops << " ns/op\n";
+    };
+
+    // 1. Churn: один объект живёт одну итерацию (типичный запрос)
+    std::cout << "churn (alloc + free):\n";
+    measure("new/delete", iterations, [&] {
+        for (int i = 0; i < iterations; ++i) {
+            auto* r = new PooledRequest(i, "GET", "/");
+            escape = r;
+            delete r;
+        }
+    });
+    measure("mempool::make_unique", iterations, [&] {
+        for (int i = 0; i < iterations; ++i) {
+            auto r = mempool::make_unique<PooledRequest>(i, "GET", "/");
+            escape = r.get();
+        }
+    });
+    measure("std::make_shared", iterations, [&] {
+        for (int i = 0; i < iterations; ++i) {
+            auto r = std::make_shared<PooledRequest>(i, "GET", "/");
+            escape = r.get();
+        }
+    });
+    measure("mempool::make_shared", iterations, [&] {
+        for (int i = 0; i < iterations; ++i) {
+            auto r = mempool::make_shared<PooledRequest>(i, "GET", "/");
+            escape = r.get();
+        }
+    });
+
+    // 2. Много живых объектов: выделить live, освободить в другом порядке
+    std::cout << "working set of " << live << " objects:\n";
+    constexpr int rounds = iterations / live;
+    std::vector<std::unique_ptr<PooledRequest>> global_set(live);
+    std::vector<mempool::ObjectPool<PooledRequest>::Unique> pooled_set(live);
+    measure("new/delete", rounds * live, [&] {
+        for (int round = 0; round < rounds; ++round) {
+            for (size_t i = 0; i < live; ++i) global_set[i] = std::make_unique<PooledRequest>(i, "GET", "/");
+            for (size_t i = 0; i < live; i += 2) global_set[i].reset();
+            for (size_t i = 1; i < live; i += 2) global_set[i].reset();
+        }
+    });
+    measure("pool", rounds * live, [&] {
+        for (int round = 0; round < rounds; ++round) {
+            for (size_t i = 0; i < live; ++i) pooled_set[i] = mempool::make_unique<PooledRequest>(i, "GET", "/");
+            for (size_t i = 0; i < live; i += 2) pooled_set[i].reset();
+            for (size_t i = 1; i < live; i += 2) pooled_set[i].reset();
+        }
+    });
+
+    // 3. pmr: контейнер строк, которые не влезают в SSO
+    std::cout << "pmr vector<string> x 64 (per container):\n";
+    constexpr int containers = iterations / 64;
+    auto fill = [&](std::pmr::memory_resource* mr) {
+        for (int k = 0; k < containers; ++k) {
+            std::pmr::vector<std::pmr::string> v(mr);
+            v.reserve(64);
+            for (int i = 0; i < 64; ++i) v.emplace_back("header-value-longer-than-sso-buffer");
+        }
+    };
+    measure("new_delete_resource", containers, [&] { fill(std::pmr::new_delete_resource()); });
+    measure("mempool::resource", containers, [&] { fill(mempool::resource()); });
+
+    // 4. Производитель -> потребитель: каждый объект освобождается в чужом потоке
+    std::cout << "producer -> consumer (cross-thread free):\n";
+    auto handoff = [&](auto&& make, auto&& release) {
+        std::mutex mutex;
+        std::vector<std::vector<PooledRequest*>> queue;
+        bool done = false;
+
+        std::jthread consumer([&] {
+            while (true) {
+                std::vector<std::vector<PooledRequest*>> taken;
+                {
+                    std::lock_guard lock(mutex);
+                    taken.swap(queue);
+                    if (taken.empty() && done) return;
+                }
+                for (auto& b : taken)
+                    for (PooledRequest* r : b) release(r);
+                if (taken.empty()) std::this_thread::yield();
+            }
+        });
+
+        for (int i = 0; i < iterations; i += batch) {
+            std::vector<PooledRequest*> b;
+            b.reserve(batch);
+            for (size_t j = 0; j < batch; ++j) b.push_back(make(i + j));
+            std::lock_guard lock(mutex);
+            queue.push_back(std::move(b));
+        }
+        std::lock_guard lock(mutex);
+        done = true;
+    };
+    measure("new/delete", iterations, [&] {
+        handoff([](int64_t id) { return new PooledRequest(id, "GET", "/"); },
+                [](PooledRequest* r) { delete r; });
+    });
+    measure("pool", iterations, [&] {
+        handoff([](int64_t id) { return mempool::ObjectPool<PooledRequest>::create(id, "GET", "/"); },
+                [](PooledRequest* r) { mempool::ObjectPool<PooledRequest>::destroy(r); });
+    });
+
+    std::cout << "pool classes:\n";
+    mempool::report(std::cout);
+}
+
+pool_benchmark();
+
 
 // ════════════════════════════════════════════════════════════════════════════════════
 // 📌 RAII PATTERNS (ПАТТЕРНЫ RAII)
@@ -490,6 +490,7 @@ if (ec2 == std::errc{}) {
 // ──────────────────────────────────────────
 // CSV Parsing - парсинг CSV
 // ──────────────────────────────────────────
+// (кавычки не поддерживаются; большие файлы - csv::Reader в io_filesystem.cpp)
 
 auto parse_csv_line = [](std::string_view line) {
     std::vector<std::string> fields;
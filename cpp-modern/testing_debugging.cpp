@@ -7,6 +7,7 @@
  * - Unit testing frameworks (Catch2, GTest, doctest)
  * - Static analysis (static_assert, concepts)
  * - Runtime debugging (assert, source_location)
+ * - Async logging (SPSC-кольца на поток, фоновый writev)
  * - Sanitizers (ASan, TSan, UBSan)
  * - Profiling и benchmarking
  * 
@@ -381,6 +382,525 @@ int debug_counter = 0;
 std::cout << "Debug counter: " << debug_counter << '\n';
 #endif
 
+// ====================================================================================================
+// 📌 ASYNC LOGGING - АСИНХРОННОЕ БИНАРНОЕ ЛОГИРОВАНИЕ
+// ====================================================================================================
+
+// Logger выше форматирует и пишет прямо в вызывающем потоке: operator<< по каждому
+// аргументу, системный вызов на строку, а под нагрузкой - ещё и общий lock потока.
+//
+// AsyncLogger:
+// - горячий поток пишет в СВОЙ SPSC-кольцевой буфер компактную бинарную запись:
+//   id формата (адрес статического LogSite) + timestamp + аргументы в бинарном виде
+// - фоновый поток забирает записи из всех колец, форматирует, копит пачку и пишет её
+//   одним writev; ротация файла по размеру
+// - переполнение кольца: Drop (запись теряется, считается) или Block (ждём место)
+// - время: steady_clock в наносекундах (монотонное, дешёвое), в wall-clock
+//   переводится уже в фоновом потоке
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Место вызова: формат и уровень известны при компиляции, в запись идёт только адрес
+struct LogSite {
+    LogLevel level;
+    const char* format;  // "{}" - подстановка аргумента
+    const char* file;
+    int line;
+};
+
+enum class OverflowPolicy { Drop, Block };
+
+struct AsyncLoggerOptions {
+    std::filesystem::path path = "app.log";
+    size_t ring_bytes = 1 << 20;             // На поток, степень двойки
+    size_t rotate_bytes = 64 << 20;          // Размер файла до ротации
+    int keep_files = 5;                      // app.log.1 ... app.log.5
+    OverflowPolicy overflow = OverflowPolicy::Drop;
+    LogLevel min_level = LogLevel::INFO;
+};
+
+class AsyncLogger {
+    enum class ArgType : uint8_t { Int, Uint, Double, Bool, Char, String };
+
+    struct RecordHeader {
+        uint32_t size;        // 0 - маркер перехода в начало кольца
+        uint32_t args;
+        const LogSite* site;
+        uint64_t timestamp;   // steady_clock, нс
+    };
+
+    // SPSC-кольцо переменных записей: пишет только свой поток, читает только фоновый
+    struct Ring {
+        std::unique_ptr<char[]> buffer;
+        size_t capacity;
+        uint32_t thread_id;
+
+        alignas(64) std::atomic<uint64_t> head{0};   // Опубликовано производителем
+        uint64_t write_pos = 0;                      // Локально производителю
+        uint64_t cached_tail = 0;
+
+        alignas(64) std::atomic<uint64_t> tail{0};   // Освобождено потребителем
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> abandoned{false};          // Поток завершился
+
+        Ring(size_t cap, uint32_t id)
+            : buffer(std::make_unique<char[]>(cap)), capacity(cap), thread_id(id) {}
+
+        // n кратно 8; nullptr - места нет
+        char* reserve(size_t n) {
+            size_t pos = write_pos & (capacity - 1);
+            size_t contiguous = capacity - pos;
+            size_t need = contiguous < n ? contiguous + n : n;  // Не влезает до конца - с начала
+
+            if (write_pos + need - cached_tail > capacity) {
+                cached_tail = tail.load(std::memory_order_acquire);
+                if (write_pos + need - cached_tail > capacity) return nullptr;
+            }
+            if (contiguous < n) {
+                RecordHeader wrap{};
+                std::memcpy(buffer.get() + pos, &wrap.size, sizeof(wrap.size));
+                write_pos += contiguous;
+                pos = 0;
+            }
+            return buffer.get() + pos;
+        }
+
+        void commit(size_t n) {
+            write_pos += n;
+            head.store(write_pos, std::memory_order_release);
+        }
+    };
+
+    // Кольца текущего потока - по одному на логгер (ключ - id логгера, не адрес: адрес
+    // удалённого логгера может достаться новому). Логгеров обычно 1-2 - хватает вектора,
+    // и потоку, пишущему попеременно в разные логгеры, не приходится пересоздавать кольцо
+    struct ThreadRings {
+        struct Entry {
+            uint64_t owner_id;
+            std::shared_ptr<Ring> ring;
+        };
+        uint32_t thread_id = next_thread_id_.fetch_add(1);
+        std::vector<Entry> entries;
+        ~ThreadRings() {
+            for (auto& e : entries) e.ring->abandoned.store(true, std::memory_order_release);
+        }
+    };
+
+    static inline std::atomic<uint64_t> next_logger_id_{1};
+    static inline std::atomic<uint32_t> next_thread_id_{1};
+
+    AsyncLoggerOptions options_;
+    uint64_t id_ = next_logger_id_.fetch_add(1);
+    std::atomic<LogLevel> min_level_;
+
+    std::mutex rings_mutex_;                      // Только регистрация потоков
+    std::vector<std::shared_ptr<Ring>> rings_;
+
+    int fd_ = -1;
+    size_t file_bytes_ = 0;
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> cycles_{0};             // Завершённые проходы фонового потока
+    std::chrono::steady_clock::time_point steady_base_;
+    std::chrono::system_clock::time_point system_base_;
+    std::thread writer_;
+
+public:
+    explicit AsyncLogger(AsyncLoggerOptions options = {})
+        : options_(std::move(options)), min_level_(options_.min_level),
+          steady_base_(std::chrono::steady_clock::now()), system_base_(std::chrono::system_clock::now()) {
+        options_.ring_bytes = std::bit_ceil(std::max<size_t>(options_.ring_bytes, 4096));
+        open_file();
+        writer_ = std::thread([this] { writer_loop(); });
+    }
+
+    ~AsyncLogger() {
+        stop_.store(true);
+        writer_.join();  // Дописывает всё, что осталось в кольцах
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    void set_level(LogLevel level) { min_level_.store(level, std::memory_order_relaxed); }
+    bool enabled(LogLevel level) const { return level >= min_level_.load(std::memory_order_relaxed); }
+
+    // Горячий путь: без аллокаций, форматирования и системных вызовов
+    template <typename... Args>
+    void log(const LogSite& site, const Args&... args) {
+        if (!enabled(site.level)) return;
+
+        uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        size_t size = (sizeof(RecordHeader) + (0 + ... + encoded_size(args)) + 7) & ~size_t(7);
+
+        Ring& ring = thread_ring();
+        if (size > ring.capacity / 2) return;  // Гигантская запись - не логируем
+
+        char* out = ring.reserve(size);
+        while (!out) {
+            if (options_.overflow == OverflowPolicy::Drop) {
+                ring.dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            std::this_thread::yield();
+            out = ring.reserve(size);
+        }
+
+        RecordHeader header{static_cast<uint32_t>(size), sizeof...(Args), &site, now};
+        std::memcpy(out, &header, sizeof(header));
+        [[maybe_unused]] char* p = out + sizeof(header);
+        ((p = encode(p, args)), ...);
+        ring.commit(size);
+    }
+
+    // Дождаться, пока всё, что залогировано ДО вызова, окажется в файле
+    void flush() {
+        uint64_t start = cycles_.load(std::memory_order_acquire);
+        while (cycles_.load(std::memory_order_acquire) < start + 2) std::this_thread::yield();
+    }
+
+    uint64_t dropped() {
+        std::lock_guard lock(rings_mutex_);
+        uint64_t total = 0;
+        for (auto& r : rings_) total += r->dropped.load(std::memory_order_relaxed);
+        return total;
+    }
+
+private:
+    Ring& thread_ring() {
+        thread_local ThreadRings local;
+        for (auto& e : local.entries) {
+            if (e.owner_id == id_) return *e.ring;
+        }
+
+        // Первая запись потока в этот логгер. Заодно - кольца удалённых логгеров:
+        // кроме этого потока, на них уже никто не ссылается
+        std::erase_if(local.entries, [](const ThreadRings::Entry& e) { return e.ring.use_count() == 1; });
+        auto ring = std::make_shared<Ring>(options_.ring_bytes, local.thread_id);
+        local.entries.push_back({id_, ring});
+        std::lock_guard lock(rings_mutex_);
+        rings_.push_back(ring);
+        return *ring;
+    }
+
+    // ---------- Бинарное кодирование аргументов ----------
+
+    template <typename T>
+    static constexpr size_t encoded_size(const T& v) {
+        if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            return 1 + sizeof(uint32_t) + std::string_view(v).size();
+        } else {
+            return 1 + 8;
+        }
+    }
+
+    template <typename T>
+    static char* encode(char* p, const T& v) {
+        auto put = [&](ArgType type, const void* data, size_t n) {
+            *p++ = static_cast<char>(type);
+            std::memcpy(p, data, n);
+            p += n;
+        };
+        if constexpr (std::is_same_v<T, bool>) {
+            uint64_t b = v;
+            put(ArgType::Bool, &b, 8);
+        } else if constexpr (std::is_same_v<T, char>) {
+            uint64_t c = static_cast<unsigned char>(v);
+            put(ArgType::Char, &c, 8);
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            int64_t i = v;
+            put(ArgType::Int, &i, 8);
+        } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+            uint64_t u = static_cast<uint64_t>(v);
+            put(ArgType::Uint, &u, 8);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            double d = v;
+            put(ArgType::Double, &d, 8);
+        } else {
+            static_assert(std::is_convertible_v<const T&, std::string_view>, "Unsupported log argument");
+            std::string_view s(v);
+            uint32_t len = static_cast<uint32_t>(s.size());
+            *p++ = static_cast<char>(ArgType::String);
+            std::memcpy(p, &len, sizeof(len));
+            std::memcpy(p + sizeof(len), s.data(), len);
+            p += sizeof(len) + len;
+        }
+        return p;
+    }
+
+    // ---------- Фоновый поток ----------
+
+    void open_file() {
+        fd_ = ::open(options_.path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        std::error_code ec;
+        auto size = std::filesystem::file_size(options_.path, ec);
+        file_bytes_ = ec ? 0 : size;
+    }
+
+    // app.log → app.log.1 → app.log.2 ... старейший удаляется
+    void rotate() {
+        if (fd_ >= 0) ::close(fd_);
+        std::error_code ec;
+        auto numbered = [&](int i) {
+            auto p = options_.path;
+            p += "." + std::to_string(i);
+            return p;
+        };
+        std::filesystem::remove(numbered(options_.keep_files), ec);
+        for (int i = options_.keep_files - 1; i >= 1; --i) {
+            std::filesystem::rename(numbered(i), numbered(i + 1), ec);
+        }
+        std::filesystem::rename(options_.path, numbered(1), ec);
+        open_file();
+    }
+
+    void writer_loop() {
+        std::vector<std::shared_ptr<Ring>> rings;
+        std::vector<std::string> chunks;     // Отформатированный текст по кольцу
+        std::vector<iovec> iov;
+        auto idle_sleep = std::chrono::microseconds(50);
+
+        while (true) {
+            bool stopping = stop_.load(std::memory_order_acquire);
+            {
+                std::lock_guard lock(rings_mutex_);
+                rings = rings_;
+            }
+            chunks.resize(rings.size());
+
+            size_t total = 0;
+            for (size_t i = 0; i < rings.size(); ++i) {
+                chunks[i].clear();
+                drain(*rings[i], chunks[i]);
+                total += chunks[i].size();
+            }
+
+            if (total > 0) {
+                if (file_bytes_ + total > options_.rotate_bytes && file_bytes_ > 0) rotate();
+                iov.clear();
+                for (auto& c : chunks) {
+                    if (!c.empty()) iov.push_back({c.data(), c.size()});
+                }
+                write_all(iov);
+                file_bytes_ += total;
+                idle_sleep = std::chrono::microseconds(50);
+            }
+
+            // Кольца завершившихся потоков, которые уже вычитаны, больше не нужны
+            {
+                std::lock_guard lock(rings_mutex_);
+                std::erase_if(rings_, [](const std::shared_ptr<Ring>& r) {
+                    return r->abandoned.load(std::memory_order_acquire) &&
+                           r->tail.load(std::memory_order_relaxed) == r->head.load(std::memory_order_acquire);
+                });
+            }
+
+            cycles_.fetch_add(1, std::memory_order_release);
+            if (stopping) break;  // Последний проход сделан уже после stop_
+            if (total == 0) {
+                std::this_thread::sleep_for(idle_sleep);
+                idle_sleep = std::min(idle_sleep * 2, std::chrono::microseconds(1000));
+            }
+        }
+    }
+
+    void write_all(std::vector<iovec>& iov) {
+        size_t index = 0;
+        while (index < iov.size()) {
+            ssize_t n = ::writev(fd_, iov.data() + index, static_cast<int>(std::min<size_t>(iov.size() - index, IOV_MAX)));
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return;  // Диск/файл недоступен - логгер не должен ронять приложение
+            }
+            while (n > 0 && index < iov.size()) {
+                if (static_cast<size_t>(n) >= iov[index].iov_len) {
+                    n -= iov[index].iov_len;
+                    ++index;
+                } else {
+                    iov[index].iov_base = static_cast<char*>(iov[index].iov_base) + n;
+                    iov[index].iov_len -= n;
+                    n = 0;
+                }
+            }
+        }
+    }
+
+    void drain(Ring& ring, std::string& out) {
+        uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+        uint64_t head = ring.head.load(std::memory_order_acquire);
+        const char* base = ring.buffer.get();
+
+        while (tail < head) {
+            size_t pos = tail & (ring.capacity - 1);
+            RecordHeader header;
+            std::memcpy(&header.size, base + pos, sizeof(header.size));
+            if (header.size == 0) {  // Маркер перехода
+                tail += ring.capacity - pos;
+                continue;
+            }
+            std::memcpy(&header, base + pos, sizeof(header));
+            format_record(ring.thread_id, header, base + pos + sizeof(header), out);
+            tail += header.size;
+        }
+        ring.tail.store(tail, std::memory_order_release);
+
+        if (uint64_t lost = ring.dropped.exchange(0, std::memory_order_relaxed)) {
+            out += "[logger] thread " + std::to_string(ring.thread_id) + " dropped " +
+                   std::to_string(lost) + " records\n";
+        }
+    }
+
+    void format_record(uint32_t thread_id, const RecordHeader& header, const char* args, std::string& out) {
+        // steady → wall: смещение от момента создания логгера
+        auto wall = system_base_ + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(header.timestamp) - steady_base_.time_since_epoch());
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wall.time_since_epoch()).count();
+
+        char buf[32];
+        append_number(out, buf, ns / 1'000'000'000);
+        out += '.';
+        auto frac = std::to_string(ns % 1'000'000'000);
+        out.append(9 - frac.size(), '0').append(frac);
+
+        static constexpr const char* names[] = {"DEBUG", "INFO", "WARNING", "ERROR"};
+        out += ' ';
+        out += names[static_cast<int>(header.site->level)];
+        out += " [";
+        append_number(out, buf, thread_id);
+        out += "] ";
+
+        // "{}" → очередной аргумент; лишние {} остаются как есть
+        std::string_view format(header.site->format);
+        uint32_t remaining = header.args;
+        size_t i = 0;
+        while (i < format.size()) {
+            size_t brace = format.find("{}", i);
+            if (brace == std::string_view::npos || remaining == 0) {
+                out.append(format.substr(i));
+                break;
+            }
+            out.append(format.substr(i, brace - i));
+            args = format_arg(args, out, buf);
+            --remaining;
+            i = brace + 2;
+        }
+        out += '\n';
+    }
+
+    template <typename T>
+    static void append_number(std::string& out, char (&buf)[32], T v) {
+        out.append(buf, std::to_chars(buf, buf + sizeof(buf), v).ptr);
+    }
+
+    static const char* format_arg(const char* p, std::string& out, char (&buf)[32]) {
+        auto type = static_cast<ArgType>(*p++);
+        if (type == ArgType::String) {
+            uint32_t len;
+            std::memcpy(&len, p, sizeof(len));
+            out.append(p + sizeof(len), len);
+            return p + sizeof(len) + len;
+        }
+        uint64_t raw;
+        std::memcpy(&raw, p, 8);
+        switch (type) {
+            case ArgType::Int: append_number(out, buf, static_cast<int64_t>(raw)); break;
+            case ArgType::Uint: append_number(out, buf, raw); break;
+            case ArgType::Double: append_number(out, buf, std::bit_cast<double>(raw)); break;
+            case ArgType::Bool: out += raw ? "true" : "false"; break;
+            case ArgType::Char: out += static_cast<char>(raw); break;
+            case ArgType::String: break;
+        }
+        return p + 8;
+    }
+};
+
+// LogSite создаётся один раз на место вызова; формат не копируется в запись
+#define ASYNC_LOG(logger, level, fmt, ...)                                          \
+    do {                                                                            \
+        static constexpr LogSite async_log_site_{level, fmt, __FILE__, __LINE__};   \
+        (logger).log(async_log_site_ __VA_OPT__(, ) __VA_ARGS__);                   \
+    } while (0)
+
+// ──────────────────────────────────────────
+// Использование AsyncLogger
+// ──────────────────────────────────────────
+
+{
+    AsyncLogger async_logger({.path = "async_app.log", .overflow = OverflowPolicy::Drop});
+
+    std::string user = "alice";
+    ASYNC_LOG(async_logger, LogLevel::INFO, "Application started");
+    ASYNC_LOG(async_logger, LogLevel::WARNING, "Low memory: {} MB", 512);
+    ASYNC_LOG(async_logger, LogLevel::INFO, "user {} logged in, latency {} ms", user, 1.25);
+    ASYNC_LOG(async_logger, LogLevel::DEBUG, "Not written (min_level = INFO)");
+
+    async_logger.flush();  // Перед чтением файла / аварийным выходом
+}   // Деструктор дописывает остаток и закрывает файл
+
+// ──────────────────────────────────────────
+// Бенчмарк: задержка одного вызова (p50 / p99.9)
+// ──────────────────────────────────────────
+
+void logger_latency_benchmark() {
+    constexpr int N = 1'000'000;
+    std::vector<uint32_t> samples(N);
+
+    auto report = [&](const char* name) {
+        std::sort(samples.begin(), samples.end());
+        std::cout << name << ": p50 " << samples[N / 2] << " ns, p99 " << samples[N * 99 / 100]
+                  << " ns, p99.9 " << samples[N * 999 / 1000] << " ns\n";
+    };
+
+    auto timed = [&](auto&& call) {
+        for (int i = 0; i < N; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            call(i);
+            samples[i] = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+    };
+
+    // Синхронно: форматирование + запись в файл в вызывающем потоке
+    {
+        std::ofstream sync_log("sync_bench.log");
+        timed([&](int i) {
+            sync_log << "[INFO] request " << i << " took " << 0.5 * i << " ms from " << "10.0.0.1" << '\n';
+        });
+        report("sync ofstream");
+    }
+
+    {
+        AsyncLogger logger({.path = "async_bench.log", .ring_bytes = 16 << 20,
+                            .overflow = OverflowPolicy::Drop});
+        timed([&](int i) {
+            ASYNC_LOG(logger, LogLevel::INFO, "request {} took {} ms from {}", i, 0.5 * i, "10.0.0.1");
+        });
+        report("AsyncLogger");
+        logger.flush();
+        std::cout << "dropped: " << logger.dropped() << '\n';
+    }
+
+    std::filesystem::remove("sync_bench.log");
+    std::filesystem::remove("async_bench.log");
+}
+
+logger_latency_benchmark();
+
 // ====================================================================================================
 // 📌 SANITIZERS - ИНСТРУМЕНТЫ ОБНАРУЖЕНИЯ ОШИБОК
 // ====================================================================================================
@@ -586,6 +1106,7 @@ DEBUG_PRINT(macro_value * 2);
  *    ✅ assert() в debug builds
  *    ✅ source_location для логирования
  *    ✅ Structured logging с уровнями
+ *    ✅ На горячем пути - асинхронный бинарный лог, форматирование в фоне
  *    ❌ Избегай printf debugging в production
  * 
  * 4. SANITIZERS
@@ -613,6 +1134,7 @@ DEBUG_PRINT(macro_value * 2);
 // • Testing frameworks: Catch2, Google Test, doctest
 // • Static analysis: static_assert, concepts
 // • Runtime: assert, source_location, логирование
+// • Async logging: бинарные записи в per-thread SPSC, writev пачками, ротация
 // • Sanitizers: ASan, TSan, UBSan, MSan
 // • Profiling: perf, Valgrind, Tracy, benchmarks
 // • CI/CD: автоматические тесты + sanitizers
@@ -253,6 +253,8 @@ struct AsyncWriteAwaiter {
 };
 
 // Coroutine-based socket wrapper
+// (поток на операцию - только для иллюстрации; без потоков, на epoll и
+// run queue на ядро - runtime::async_read/async_write в cpp-modern/coroutines.cpp)
 class CoroSocket {
     int fd_;
     
@@ -711,6 +713,437 @@ public:
     }
 };
 
+// ============================================
+// 📌 Event Loop Core: fd-таблица, батчи событий, eventfd wakeup
+// ============================================
+
+#include <sys/eventfd.h>
+#include <atomic>
+
+// Проблемы Reactor / EventLoop / EpollEventLoop выше:
+// - handlers_ в unordered_map<int, ...> → hash lookup на КАЖДОЕ событие
+// - std::function на каждый handler → косвенный вызов + аллокация при регистрации
+// - Reactor::run забирает всего 10 событий за epoll_wait и просыпается раз в секунду
+// - stop() из другого потока не будит loop, он заметит флаг только по таймауту
+// - fd переиспользуется ядром: если handler закрыл fd 7, а accept тут же
+//   вернул новый fd 7, оставшееся в батче событие старого fd 7 уйдёт новому handler
+//
+// Решение - отдельное ядро EventLoopCore (Reactor и EpollEventLoop выше остаются
+// как есть и на него не переведены; новый код - поверх EventLoopCore):
+// - fd - маленькое плотное число → std::vector<Slot>, индекс = fd, O(1) без хэша
+// - в epoll_event.data.u64 кладём (generation << 32 | fd), устаревшие события отбрасываем
+// - размер батча epoll_wait настраивается
+// - eventfd + lock-free MPSC-очередь для post() из других потоков
+
+struct EventLoopOptions {
+    int max_events = 256;          // Сколько событий забирать за один epoll_wait
+    size_t initial_slots = 1024;   // Начальный размер fd-таблицы
+};
+
+class EventLoopCore {
+public:
+    // Handler без std::function: указатель на функцию + контекст
+    using IoCallback = void (*)(void* ctx, int fd, uint32_t events);
+
+    // Снимок счётчиков для мониторинга (например, metrics::Registry в http_server.cpp)
+    struct Stats {
+        uint64_t iterations;     // Вызовов epoll_wait
+        uint64_t events;         // Отданных handler'ам событий
+        uint64_t stale_events;   // Отброшенных по generation
+        uint64_t posted_tasks;   // Выполненных post()-задач
+        size_t batch_capacity;   // Текущий размер буфера epoll_wait
+    };
+
+private:
+    struct Slot {
+        IoCallback callback = nullptr;
+        void* ctx = nullptr;
+        uint32_t generation = 0;       // Растёт при каждой регистрации fd
+        uint32_t events = 0;
+        bool active = false;
+    };
+
+    // Узел lock-free очереди задач из других потоков (intrusive список)
+    struct PostedTask {
+        PostedTask* next = nullptr;
+        std::function<void()> fn;
+    };
+
+    static constexpr int WAKEUP_FD_TAG = -1;
+
+    int epoll_fd_;
+    int wakeup_fd_;
+    std::vector<Slot> slots_;
+    std::vector<epoll_event> events_;
+    std::atomic<PostedTask*> posted_{nullptr};
+    std::atomic<bool> running_{false};
+
+    // Пишет только поток loop'а: load + store вместо lock-префикса,
+    // atomic - чтобы stats() можно было читать из любого потока
+    struct Counters {
+        std::atomic<uint64_t> iterations{0};
+        std::atomic<uint64_t> events{0};
+        std::atomic<uint64_t> stale_events{0};
+        std::atomic<uint64_t> posted_tasks{0};
+        std::atomic<size_t> batch_capacity{0};
+    } counters_;
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t n = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    static uint64_t pack(int fd, uint32_t generation) {
+        return (uint64_t(generation) << 32) | uint32_t(fd);
+    }
+
+public:
+    explicit EventLoopCore(EventLoopOptions options = {})
+        : slots_(options.initial_slots), events_(options.max_events) {
+        counters_.batch_capacity.store(events_.size(), std::memory_order_relaxed);
+
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ < 0) {
+            throw std::runtime_error("epoll_create1 failed");
+        }
+
+        wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeup_fd_ < 0) {
+            close(epoll_fd_);
+            throw std::runtime_error("eventfd failed");
+        }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = pack(WAKEUP_FD_TAG, 0);
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev);
+    }
+
+    ~EventLoopCore() {
+        // Задачи, которые так и не были выполнены
+        PostedTask* task = posted_.exchange(nullptr);
+        while (task) {
+            PostedTask* next = task->next;
+            delete task;
+            task = next;
+        }
+
+        close(wakeup_fd_);
+        close(epoll_fd_);
+    }
+
+    EventLoopCore(const EventLoopCore&) = delete;
+    EventLoopCore& operator=(const EventLoopCore&) = delete;
+
+    // Регистрация fd (только из потока loop'а)
+    bool add(int fd, uint32_t events, IoCallback callback, void* ctx) {
+        if (size_t(fd) >= slots_.size()) {
+            slots_.resize(std::max(slots_.size() * 2, size_t(fd) + 1));
+        }
+
+        Slot& slot = slots_[fd];
+        slot.callback = callback;
+        slot.ctx = ctx;
+        slot.events = events;
+        slot.active = true;
+        ++slot.generation;  // События от предыдущего владельца fd станут "чужими"
+
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = pack(fd, slot.generation);
+
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            slot.active = false;
+            return false;
+        }
+        return true;
+    }
+
+    // Удобная перегрузка: любой callable, который живёт дольше регистрации.
+    // Тип стирается в статическую функцию - никаких аллокаций
+    template<typename Handler>
+    bool add(int fd, uint32_t events, Handler& handler) {
+        return add(fd, events,
+            [](void* ctx, int fd, uint32_t ev) {
+                (*static_cast<Handler*>(ctx))(fd, ev);
+            },
+            &handler);
+    }
+
+    bool modify(int fd, uint32_t events) {
+        if (size_t(fd) >= slots_.size() || !slots_[fd].active) return false;
+
+        Slot& slot = slots_[fd];
+        slot.events = events;
+
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = pack(fd, slot.generation);
+        return epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == 0;
+    }
+
+    void remove(int fd) {
+        if (size_t(fd) >= slots_.size() || !slots_[fd].active) return;
+
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        slots_[fd].active = false;
+        slots_[fd].callback = nullptr;
+        slots_[fd].ctx = nullptr;
+    }
+
+    // Выполнить задачу в потоке loop'а (можно вызывать из любого потока)
+    void post(std::function<void()> fn) {
+        auto* task = new PostedTask{nullptr, std::move(fn)};
+
+        // Treiber push: lock-free, без мьютекса
+        PostedTask* head = posted_.load(std::memory_order_relaxed);
+        do {
+            task->next = head;
+        } while (!posted_.compare_exchange_weak(head, task,
+                     std::memory_order_release, std::memory_order_relaxed));
+
+        // Будим loop только если очередь была пуста:
+        // пачка post() подряд = один write в eventfd
+        if (head == nullptr) {
+            uint64_t one = 1;
+            ssize_t ignored = write(wakeup_fd_, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+
+    // Одна итерация: ждём события и раздаём их (timeout_ms = -1 - без таймаута)
+    int run_once(int timeout_ms = -1) {
+        int nfds = epoll_wait(epoll_fd_, events_.data(), int(events_.size()), timeout_ms);
+        if (nfds < 0) {
+            return errno == EINTR ? 0 : -1;
+        }
+
+        bump(counters_.iterations);
+        uint64_t dispatched = 0;
+
+        for (int i = 0; i < nfds; ++i) {
+            uint64_t data = events_[i].data.u64;
+            int fd = int(uint32_t(data));
+            uint32_t generation = uint32_t(data >> 32);
+
+            if (fd == WAKEUP_FD_TAG) {
+                drain_posted();
+                continue;
+            }
+
+            // Прямой индекс вместо hash lookup
+            const Slot& slot = slots_[fd];
+
+            // fd уже удалён или переиспользован внутри этого же батча
+            if (!slot.active || slot.generation != generation) {
+                bump(counters_.stale_events);
+                continue;
+            }
+
+            slot.callback(slot.ctx, fd, events_[i].events);
+            ++dispatched;
+        }
+        bump(counters_.events, dispatched);
+
+        // Батч заполнен целиком - в ядре, скорее всего, есть ещё события.
+        // Растим буфер, чтобы следующий epoll_wait забрал больше за один syscall
+        if (nfds == int(events_.size()) && events_.size() < 4096) {
+            events_.resize(events_.size() * 2);
+            counters_.batch_capacity.store(events_.size(), std::memory_order_relaxed);
+        }
+
+        return nfds;
+    }
+
+    Stats stats() const {
+        return {counters_.iterations.load(std::memory_order_relaxed),
+                counters_.events.load(std::memory_order_relaxed),
+                counters_.stale_events.load(std::memory_order_relaxed),
+                counters_.posted_tasks.load(std::memory_order_relaxed),
+                counters_.batch_capacity.load(std::memory_order_relaxed)};
+    }
+
+    void run() {
+        running_.store(true, std::memory_order_relaxed);
+        while (running_.load(std::memory_order_relaxed)) {
+            if (run_once(-1) < 0) break;  // Таймаут не нужен - будит eventfd
+        }
+    }
+
+    // Безопасно вызывать из любого потока: loop проснётся сразу
+    void stop() {
+        post([this] { running_.store(false, std::memory_order_relaxed); });
+    }
+
+private:
+    void drain_posted() {
+        uint64_t counter;
+        ssize_t ignored = read(wakeup_fd_, &counter, sizeof(counter));
+        (void)ignored;
+
+        // Забираем весь стек разом и разворачиваем в FIFO-порядок
+        PostedTask* head = posted_.exchange(nullptr, std::memory_order_acquire);
+        PostedTask* fifo = nullptr;
+        while (head) {
+            PostedTask* next = head->next;
+            head->next = fifo;
+            fifo = head;
+            head = next;
+        }
+
+        while (fifo) {
+            PostedTask* next = fifo->next;
+            fifo->fn();
+            delete fifo;
+            fifo = next;
+            bump(counters_.posted_tasks);
+        }
+    }
+};
+
+// Пример: echo-сервер на EventLoopCore
+void event_loop_core_example(int server_fd) {
+    EventLoopCore loop({.max_events = 512});
+
+    // Handler хранится на стеке и живёт дольше loop.run() - регистрация без аллокаций
+    auto on_client = [&loop](int fd, uint32_t) {
+        char buffer[4096];
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+
+        if (n > 0) {
+            send(fd, buffer, n, 0);
+        } else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            loop.remove(fd);
+            close(fd);  // Номер fd можно сразу переиспользовать - generation защитит
+        }
+    };
+
+    auto on_accept = [&loop, &on_client](int fd, uint32_t) {
+        int client_fd = accept4(fd, nullptr, nullptr, SOCK_NONBLOCK);
+        if (client_fd >= 0) {
+            loop.add(client_fd, EPOLLIN, on_client);
+        }
+    };
+
+    loop.add(server_fd, EPOLLIN, on_accept);
+
+    // Остановка из другого потока - loop просыпается мгновенно
+    std::thread stopper([&loop] {
+        std::this_thread::sleep_for(std::chrono::seconds(10));
+        loop.stop();
+    });
+
+    loop.run();
+    stopper.join();
+}
+
+// Микробенчмарк: events/sec на pipe'ах (EpollEventLoop vs EventLoopCore)
+// Каждый pipe "пингует сам себя": handler читает байт и пишет его обратно,
+// поэтому в каждый момент готово ровно pipe_count fd
+void event_loop_core_benchmark() {
+    constexpr int pipe_count = 256;
+    constexpr long total_events = 2'000'000;
+
+    auto make_pipes = [] {
+        std::vector<std::array<int, 2>> pipes(pipe_count);
+        for (auto& p : pipes) {
+            pipe2(p.data(), O_NONBLOCK | O_CLOEXEC);
+            char byte = 'x';
+            ssize_t ignored = write(p[1], &byte, 1);  // "Зажигаем" каждый pipe
+            (void)ignored;
+        }
+        return pipes;
+    };
+
+    auto close_pipes = [](auto& pipes) {
+        for (auto& p : pipes) {
+            close(p[0]);
+            close(p[1]);
+        }
+    };
+
+    auto report = [](const char* name, long events, auto elapsed) {
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        std::cout << name << ": " << static_cast<long>(events / seconds)
+                  << " events/sec\n";
+    };
+
+    // 1. Baseline: unordered_map + std::function, 64 события за вызов
+    {
+        auto pipes = make_pipes();
+        EpollEventLoop loop;
+        long events = 0;
+
+        for (auto& p : pipes) {
+            int rfd = p[0], wfd = p[1];
+            loop.add_level_triggered(rfd, [&loop, &events, rfd, wfd] {
+                char byte;
+                if (read(rfd, &byte, 1) == 1) {
+                    ssize_t ignored = write(wfd, &byte, 1);
+                    (void)ignored;
+                }
+                if (++events >= total_events) loop.stop();
+            });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        loop.run();
+        report("EpollEventLoop", events, std::chrono::steady_clock::now() - start);
+        close_pipes(pipes);
+    }
+
+    // 2. EventLoopCore: fd-таблица + батч 256
+    {
+        auto pipes = make_pipes();
+        EventLoopCore loop({.max_events = 256});
+        long events = 0;
+        bool done = false;
+
+        // Для бенчмарка write-конец pipe'а лежит в таблице по read-fd
+        std::vector<int> write_end(pipe_count * 2 + 64, -1);
+
+        auto handler = [&](int rfd, uint32_t) {
+            char byte;
+            if (read(rfd, &byte, 1) == 1) {
+                ssize_t ignored = write(write_end[rfd], &byte, 1);
+                (void)ignored;
+            }
+            if (++events >= total_events) done = true;
+        };
+
+        for (auto& p : pipes) {
+            if (size_t(p[0]) >= write_end.size()) write_end.resize(p[0] + 1, -1);
+            write_end[p[0]] = p[1];
+            loop.add(p[0], EPOLLIN, handler);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        while (!done) loop.run_once();
+        report("EventLoopCore", events, std::chrono::steady_clock::now() - start);
+        close_pipes(pipes);
+    }
+
+    // 3. Cross-thread post(): сколько задач в секунду проходит через eventfd
+    {
+        EventLoopCore loop;
+        constexpr long posts = 1'000'000;
+        std::atomic<long> executed{0};
+
+        std::thread producer([&] {
+            for (long i = 0; i < posts; ++i) {
+                loop.post([&executed] {
+                    executed.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+            loop.stop();
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        loop.run();
+        report("EventLoopCore::post", executed.load(), std::chrono::steady_clock::now() - start);
+        producer.join();
+    }
+}
+
 // ============================================
 // 📌 io_uring (Modern Linux)
 // ============================================
@@ -1023,122 +1456,1460 @@ public:
 };
 
 // ============================================
-// 📌 Buffering Strategies
+// 📌 Work-Stealing Executor (per-worker deques)
 // ============================================
 
-// Ring Buffer для эффективной буферизации
-class RingBuffer {
-    std::vector<char> buffer_;
-    size_t read_pos_ = 0;
-    size_t write_pos_ = 0;
-    size_t size_;
-    
-public:
-    explicit RingBuffer(size_t size) : buffer_(size), size_(size) {}
-    
-    size_t write(const char* data, size_t len) {
-        size_t available = (size_ - write_pos_ + read_pos_ - 1) % size_;
-        size_t to_write = std::min(len, available);
-        
-        if (to_write == 0) return 0;
-        
-        // Записываем данные циклически
-        if (write_pos_ + to_write <= size_) {
-            std::memcpy(buffer_.data() + write_pos_, data, to_write);
-            write_pos_ = (write_pos_ + to_write) % size_;
-        } else {
-            size_t first_part = size_ - write_pos_;
-            std::memcpy(buffer_.data() + write_pos_, data, first_part);
-            std::memcpy(buffer_.data(), data + first_part, to_write - first_part);
-            write_pos_ = to_write - first_part;
-        }
-        
-        return to_write;
-    }
-    
-    size_t read(char* data, size_t len) {
-        size_t available = (size_ - read_pos_ + write_pos_) % size_;
-        size_t to_read = std::min(len, available);
-        
-        if (to_read == 0) return 0;
-        
-        if (read_pos_ + to_read <= size_) {
-            std::memcpy(data, buffer_.data() + read_pos_, to_read);
-            read_pos_ = (read_pos_ + to_read) % size_;
+// Проблема NetworkThreadPool (и ThreadPool из network_basics.cpp):
+// - одна очередь + один mutex + notify_one на КАЖДУЮ задачу
+// - при сотнях тысяч задач/сек все потоки дерутся за одну cache line
+// - std::function аллоцирует для любого лямбда-захвата больше 16 байт
+//
+// Work stealing:
+// - у каждого worker'а своя Chase-Lev deque: владелец push/pop с bottom (LIFO,
+//   горячий кэш), воры забирают с top (FIFO, самые "старые" и крупные задачи)
+// - mutex только для задач, пришедших снаружи пула (injection queue)
+// - задача хранится inline в переиспользуемом узле (small-buffer), без std::function
+// - задачи, созданные в потоке event loop'а, остаются в его deque
+
+#include <pthread.h>
+#include <random>
+
+// Узел задачи: callable лежит прямо во внутреннем буфере
+struct TaskNode {
+    static constexpr size_t INLINE_SIZE = 48;
+
+    TaskNode* next_free = nullptr;
+    void (*run)(TaskNode*) = nullptr;  // Вызвать callable и уничтожить его
+    alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+
+    template<typename F>
+    void emplace(F&& f) {
+        using Fn = std::decay_t<F>;
+
+        if constexpr (sizeof(Fn) <= INLINE_SIZE &&
+                      alignof(Fn) <= alignof(std::max_align_t)) {
+            new (storage) Fn(std::forward<F>(f));
+            run = [](TaskNode* node) {
+                Fn* fn = std::launder(reinterpret_cast<Fn*>(node->storage));
+                (*fn)();
+                fn->~Fn();
+            };
         } else {
-            size_t first_part = size_ - read_pos_;
-            std::memcpy(data, buffer_.data() + read_pos_, first_part);
-            std::memcpy(data + first_part, buffer_.data(), to_read - first_part);
-            read_pos_ = to_read - first_part;
+            // Большой захват - одна аллокация, как у std::function
+            *reinterpret_cast<Fn**>(storage) = new Fn(std::forward<F>(f));
+            run = [](TaskNode* node) {
+                Fn* fn = *reinterpret_cast<Fn**>(node->storage);
+                (*fn)();
+                delete fn;
+            };
         }
-        
-        return to_read;
     }
 };
 
-// Scatter/Gather I/O - векторизованные операции
-void scatter_gather_example(int sockfd) {
-    // Подготовка нескольких буферов
-    char header[128];
-    char body[1024];
-    char footer[64];
-    
-    // Scatter read - читаем в несколько буферов одной операцией
-    iovec iov[3];
-    iov[0].iov_base = header;
-    iov[0].iov_len = sizeof(header);
-    iov[1].iov_base = body;
-    iov[1].iov_len = sizeof(body);
-    iov[2].iov_base = footer;
-    iov[2].iov_len = sizeof(footer);
-    
-    ssize_t n = readv(sockfd, iov, 3);
-    
-    // Gather write - отправляем несколько буферов одной операцией
-    ssize_t sent = writev(sockfd, iov, 3);
-    
-    std::cout << "Read: " << n << ", Sent: " << sent << '\n';
-}
+// Thread-local кэш узлов: malloc/free не на горячем пути
+class TaskNodeCache {
+    TaskNode* head_ = nullptr;
+    size_t count_ = 0;
+    static constexpr size_t MAX_CACHED = 4096;
 
-// Buffer Pool - переиспользование буферов
-class BufferPool {
-    std::vector<std::unique_ptr<char[]>> buffers_;
-    std::queue<char*> available_;
-    std::mutex mutex_;
-    size_t buffer_size_;
-    
 public:
-    BufferPool(size_t buffer_size, size_t count) 
-        : buffer_size_(buffer_size) {
-        for (size_t i = 0; i < count; ++i) {
-            auto buffer = std::make_unique<char[]>(buffer_size);
-            available_.push(buffer.get());
-            buffers_.push_back(std::move(buffer));
+    ~TaskNodeCache() {
+        while (head_) {
+            TaskNode* next = head_->next_free;
+            delete head_;
+            head_ = next;
         }
     }
-    
-    char* acquire() {
-        std::lock_guard lock(mutex_);
-        
-        if (available_.empty()) {
-            // Создаём новый буфер
-            auto buffer = std::make_unique<char[]>(buffer_size_);
-            char* ptr = buffer.get();
-            buffers_.push_back(std::move(buffer));
-            return ptr;
+
+    TaskNode* allocate() {
+        if (!head_) return new TaskNode;
+        TaskNode* node = head_;
+        head_ = node->next_free;
+        --count_;
+        return node;
+    }
+
+    // Узел мог быть создан в другом потоке - просто кладём в свой кэш
+    void release(TaskNode* node) {
+        if (count_ >= MAX_CACHED) {
+            delete node;
+            return;
         }
-        
-        char* buffer = available_.front();
-        available_.pop();
-        return buffer;
+        node->next_free = head_;
+        head_ = node;
+        ++count_;
     }
-    
-    void release(char* buffer) {
-        std::lock_guard lock(mutex_);
-        available_.push(buffer);
+
+    static TaskNodeCache& local() {
+        static thread_local TaskNodeCache cache;
+        return cache;
     }
 };
 
+// Chase-Lev deque (вариант Lê et al., "Correct and Efficient Work-Stealing
+// for Weak Memory Models"). push/pop - только владелец, steal - кто угодно
+template<typename T>
+class ChaseLevDeque {
+    static_assert(std::is_pointer_v<T>, "slots must be atomic-friendly");
+
+    struct Array {
+        int64_t capacity;
+        int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+
+        explicit Array(int64_t cap)
+            : capacity(cap), mask(cap - 1), slots(new std::atomic<T>[cap]) {}
+
+        T get(int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+        void put(int64_t i, T v) { slots[i & mask].store(v, std::memory_order_relaxed); }
+    };
+
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    alignas(64) std::atomic<Array*> array_;
+    std::vector<std::unique_ptr<Array>> arrays_;  // Старые массивы живут до конца (их могут читать воры)
+
+public:
+    explicit ChaseLevDeque(int64_t capacity = 1024) {
+        arrays_.push_back(std::make_unique<Array>(capacity));
+        array_.store(arrays_.back().get(), std::memory_order_relaxed);
+    }
+
+    // Владелец: положить в bottom
+    void push(T item) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Array* a = array_.load(std::memory_order_relaxed);
+
+        if (b - t > a->capacity - 1) {
+            a = grow(a, t, b);
+        }
+
+        a->put(b, item);
+        // release-store вместо release-fence: то же самое на x86, но понятно TSan
+        bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    // Владелец: забрать с bottom (LIFO)
+    T pop() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // Пусто
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T item = a->get(b);
+        if (t == b) {
+            // Последний элемент - гонка с ворами решается CAS на top
+            if (!top_.compare_exchange_strong(t, t + 1,
+                    std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Вор: забрать с top (FIFO)
+    T steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+
+        if (t >= b) return nullptr;
+
+        Array* a = array_.load(std::memory_order_acquire);
+        T item = a->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;  // Проиграли гонку другому вору или владельцу
+        }
+        return item;
+    }
+
+    bool empty() const {
+        return bottom_.load(std::memory_order_relaxed) <=
+               top_.load(std::memory_order_relaxed);
+    }
+
+private:
+    Array* grow(Array* old, int64_t t, int64_t b) {
+        auto bigger = std::make_unique<Array>(old->capacity * 2);
+        for (int64_t i = t; i < b; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        Array* raw = bigger.get();
+        arrays_.push_back(std::move(bigger));
+        array_.store(raw, std::memory_order_release);
+        return raw;
+    }
+};
+
+// Привязка потока к ядру (Linux)
+inline bool pin_current_thread(size_t cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % std::max(1u, std::thread::hardware_concurrency()), &set);   // 0 = "неизвестно"
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+struct WorkStealingOptions {
+    size_t workers = std::thread::hardware_concurrency();
+    size_t loop_slots = 0;      // Сколько потоков event loop'а можно подключить
+    bool pin_threads = false;   // Worker i → CPU i
+};
+
+class WorkStealingExecutor {
+    struct alignas(64) Slot {
+        ChaseLevDeque<TaskNode*> deque;
+        std::minstd_rand rng;
+    };
+
+    std::vector<std::unique_ptr<Slot>> slots_;  // [0, workers) - worker'ы, дальше - loop-потоки
+    size_t worker_count_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> attached_loops_{0};
+
+    // Задачи извне пула - единственное место с mutex
+    std::mutex inject_mutex_;
+    std::deque<TaskNode*> injected_;
+    std::atomic<size_t> injected_size_{0};
+
+    // Парковка: worker засыпает на epoch_.wait(), submit будит notify_one()
+    alignas(64) std::atomic<uint32_t> epoch_{0};
+    alignas(64) std::atomic<int> sleepers_{0};
+    std::atomic<int> searching_{0};  // Worker'ы, которые сейчас ищут задачи (крутятся)
+    std::atomic<bool> stop_{false};
+
+    // Какому пулу и какому слоту принадлежит текущий поток
+    static inline thread_local WorkStealingExecutor* tls_owner_ = nullptr;
+    static inline thread_local size_t tls_slot_ = 0;
+
+public:
+    explicit WorkStealingExecutor(WorkStealingOptions options = {})
+        : worker_count_(std::max<size_t>(1, options.workers)) {
+        size_t total = worker_count_ + options.loop_slots;
+        for (size_t i = 0; i < total; ++i) {
+            slots_.push_back(std::make_unique<Slot>());
+            slots_.back()->rng.seed(static_cast<unsigned>(i + 1));
+        }
+
+        for (size_t i = 0; i < worker_count_; ++i) {
+            threads_.emplace_back([this, i, pin = options.pin_threads] {
+                if (pin) pin_current_thread(i);
+                worker_loop(i);
+            });
+        }
+    }
+
+    ~WorkStealingExecutor() {
+        stop_.store(true);
+        epoch_.fetch_add(1);
+        epoch_.notify_all();
+
+        for (auto& t : threads_) t.join();
+
+        // Задачи, которые так никто и не выполнил. Они могут порождать новые
+        // (в injected_ или в deque текущего потока) - крутимся, пока пусто везде
+        for (bool ran = true; ran;) {
+            ran = false;
+            for (auto& slot : slots_) {
+                while (TaskNode* node = slot->deque.steal()) {
+                    run_node(node);
+                    ran = true;
+                }
+            }
+            while (TaskNode* node = take_injected()) {
+                run_node(node);
+                ran = true;
+            }
+        }
+    }
+
+    WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+    WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+    // Подключить текущий поток event loop'а: его задачи пойдут в его deque
+    // и будут выполняться им же (run_local), а простаивающие worker'ы их украдут
+    bool attach_current_thread(bool pin = false) {
+        size_t index = worker_count_ + attached_loops_.fetch_add(1);
+        if (index >= slots_.size()) {
+            attached_loops_.fetch_sub(1);
+            return false;
+        }
+        tls_owner_ = this;
+        tls_slot_ = index;
+        if (pin) pin_current_thread(index);
+        return true;
+    }
+
+    template<typename F>
+    void submit(F&& f) {
+        TaskNode* node = TaskNodeCache::local().allocate();
+        node->emplace(std::forward<F>(f));
+
+        if (tls_owner_ == this) {
+            // Изнутри пула: в свою deque, без блокировок
+            slots_[tls_slot_]->deque.push(node);
+
+            // Loop-поток выполнит свои задачи сам - не дёргаем спящих worker'ов
+            if (tls_slot_ >= worker_count_) return;
+        } else {
+            {
+                std::lock_guard lock(inject_mutex_);
+                injected_.push_back(node);
+            }
+            injected_size_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        wake_one();
+    }
+
+    // Для loop-потока: выполнить до max своих задач (между итерациями epoll_wait)
+    size_t run_local(size_t max = 256) {
+        if (tls_owner_ != this) return 0;
+
+        size_t executed = 0;
+        while (executed < max) {
+            TaskNode* node = slots_[tls_slot_]->deque.pop();
+            if (!node) break;
+            run_node(node);
+            ++executed;
+        }
+        return executed;
+    }
+
+    bool has_local() const {
+        return tls_owner_ == this && !slots_[tls_slot_]->deque.empty();
+    }
+
+private:
+    static void run_node(TaskNode* node) {
+        node->run(node);
+        TaskNodeCache::local().release(node);
+    }
+
+    void wake_one() {
+        // Пара к fence в worker_loop: либо мы видим спящего, либо он видит задачу.
+        // Если кто-то уже ищет работу - он её и найдёт, futex-syscall не нужен
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (searching_.load(std::memory_order_relaxed) == 0 &&
+            sleepers_.load(std::memory_order_relaxed) > 0) {
+            epoch_.fetch_add(1, std::memory_order_release);
+            epoch_.notify_one();
+        }
+    }
+
+    TaskNode* take_injected() {
+        if (injected_size_.load(std::memory_order_relaxed) == 0) return nullptr;
+
+        std::lock_guard lock(inject_mutex_);
+        if (injected_.empty()) return nullptr;
+        TaskNode* node = injected_.front();
+        injected_.pop_front();
+        injected_size_.fetch_sub(1, std::memory_order_relaxed);
+        return node;
+    }
+
+    TaskNode* try_steal(size_t self) {
+        size_t n = slots_.size();
+        size_t start = slots_[self]->rng() % n;  // Случайная жертва - меньше коллизий воров
+
+        for (size_t i = 0; i < n; ++i) {
+            size_t victim = (start + i) % n;
+            if (victim == self) continue;
+            if (TaskNode* node = slots_[victim]->deque.steal()) return node;
+        }
+        return nullptr;
+    }
+
+    TaskNode* find_task(size_t self) {
+        if (TaskNode* node = slots_[self]->deque.pop()) return node;  // LIFO - горячий кэш
+        if (TaskNode* node = take_injected()) return node;
+        return try_steal(self);
+    }
+
+    void worker_loop(size_t self) {
+        tls_owner_ = this;
+        tls_slot_ = self;
+
+        while (true) {
+            if (TaskNode* node = find_task(self)) {
+                run_node(node);
+                continue;
+            }
+
+            // Немного покрутимся - новые задачи часто появляются через микросекунды
+            searching_.fetch_add(1, std::memory_order_relaxed);
+            TaskNode* stolen = nullptr;
+            for (int spin = 0; spin < 64 && !stolen; ++spin) {
+                stolen = find_task(self);
+            }
+
+            if (stolen) {
+                // Последний ищущий нашёл работу - будим смену, вдруг задач много
+                if (searching_.fetch_sub(1, std::memory_order_relaxed) == 1) {
+                    wake_one();
+                }
+                run_node(stolen);
+                continue;
+            }
+            searching_.fetch_sub(1, std::memory_order_relaxed);
+
+            // Засыпаем: регистрируемся, перепроверяем и ждём смены epoch
+            sleepers_.fetch_add(1, std::memory_order_relaxed);
+            uint32_t epoch = epoch_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            TaskNode* node = find_task(self);
+            if (!node && !stop_.load()) {
+                epoch_.wait(epoch, std::memory_order_acquire);
+            }
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+
+            if (node) {
+                run_node(node);
+            } else if (stop_.load()) {
+                return;
+            }
+        }
+    }
+};
+
+// Event loop + executor: задачи из обработчиков остаются на ядре loop'а
+void work_stealing_with_event_loop(int server_fd) {
+    WorkStealingExecutor executor({.workers = 4, .loop_slots = 1, .pin_threads = true});
+
+    std::thread loop_thread([&executor, server_fd] {
+        executor.attach_current_thread(/*pin=*/true);
+        EventLoopCore loop;
+
+        auto on_accept = [&executor](int fd, uint32_t) {
+            int client_fd = accept4(fd, nullptr, nullptr, SOCK_NONBLOCK);
+            if (client_fd < 0) return;
+
+            // Попадёт в deque этого потока - выполнится здесь же, пока данные в кэше
+            executor.submit([client_fd] {
+                // Разбор запроса, бизнес-логика...
+                close(client_fd);
+            });
+        };
+        loop.add(server_fd, EPOLLIN, on_accept);
+
+        while (true) {
+            // Есть свои задачи - не блокируемся в epoll_wait
+            loop.run_once(executor.has_local() ? 0 : -1);
+            executor.run_local(256);
+        }
+    });
+
+    loop_thread.join();
+}
+
+// Бенчмарк: fork-join и "много крошечных задач"
+// NetworkThreadPool vs WorkStealingExecutor
+void work_stealing_benchmark() {
+    const size_t threads = std::max(2u, std::thread::hardware_concurrency());
+
+    auto wait_zero = [](std::atomic<long>& pending) {
+        while (pending.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    };
+
+    auto report = [](const char* name, long tasks, auto elapsed) {
+        double ms = std::chrono::duration<double, std::milli>(elapsed).count();
+        std::cout << name << ": " << ms << " ms, "
+                  << static_cast<long>(tasks / ms * 1000) << " tasks/sec\n";
+    };
+
+    // 1. Fork-join: дерево задач глубины 20 (~2M задач), каждая порождает две
+    constexpr int depth = 20;
+    constexpr long tree_tasks = (1L << (depth + 1)) - 1;
+
+    auto fork_join = [&](auto& pool, const char* name) {
+        std::atomic<long> pending{1};
+
+        // Рекурсивная лямбда через указатель на себя
+        struct Node {
+            decltype(pool)& p;
+            std::atomic<long>& pending;
+            void spawn(int level) {
+                p.submit([this, level] {
+                    if (level < depth) {
+                        pending.fetch_add(2, std::memory_order_relaxed);
+                        spawn(level + 1);
+                        spawn(level + 1);
+                    }
+                    pending.fetch_sub(1, std::memory_order_release);
+                });
+            }
+        } root{pool, pending};
+
+        auto start = std::chrono::steady_clock::now();
+        root.spawn(0);
+        wait_zero(pending);
+        report(name, tree_tasks, std::chrono::steady_clock::now() - start);
+    };
+
+    // 2. Одна задача порождает миллион крошечных (~десятки нс работы)
+    constexpr long tiny_tasks = 1'000'000;
+
+    auto many_tiny = [&](auto& pool, const char* name) {
+        std::atomic<long> pending{tiny_tasks};
+        std::atomic<uint64_t> sink{0};
+
+        auto start = std::chrono::steady_clock::now();
+        pool.submit([&] {
+            for (long i = 0; i < tiny_tasks; ++i) {
+                pool.submit([&sink, &pending, i] {
+                    sink.fetch_add(uint64_t(i) * 2654435761u, std::memory_order_relaxed);
+                    pending.fetch_sub(1, std::memory_order_release);
+                });
+            }
+        });
+        wait_zero(pending);
+        report(name, tiny_tasks, std::chrono::steady_clock::now() - start);
+    };
+
+    {
+        NetworkThreadPool pool(threads);
+        fork_join(pool, "NetworkThreadPool    fork-join ");
+        many_tiny(pool, "NetworkThreadPool    tiny tasks");
+    }
+    {
+        WorkStealingExecutor pool({.workers = threads});
+        fork_join(pool, "WorkStealingExecutor fork-join ");
+        many_tiny(pool, "WorkStealingExecutor tiny tasks");
+    }
+}
+
+// ============================================
+// 📌 Buffering Strategies
+// ============================================
+
+// Ring Buffer для эффективной буферизации
+class RingBuffer {
+    std::vector<char> buffer_;
+    size_t read_pos_ = 0;
+    size_t write_pos_ = 0;
+    size_t size_;
+    
+public:
+    explicit RingBuffer(size_t size) : buffer_(size), size_(size) {}
+    
+    size_t write(const char* data, size_t len) {
+        size_t available = (size_ - write_pos_ + read_pos_ - 1) % size_;
+        size_t to_write = std::min(len, available);
+        
+        if (to_write == 0) return 0;
+        
+        // Записываем данные циклически
+        if (write_pos_ + to_write <= size_) {
+            std::memcpy(buffer_.data() + write_pos_, data, to_write);
+            write_pos_ = (write_pos_ + to_write) % size_;
+        } else {
+            size_t first_part = size_ - write_pos_;
+            std::memcpy(buffer_.data() + write_pos_, data, first_part);
+            std::memcpy(buffer_.data(), data + first_part, to_write - first_part);
+            write_pos_ = to_write - first_part;
+        }
+        
+        return to_write;
+    }
+    
+    size_t read(char* data, size_t len) {
+        size_t available = (size_ - read_pos_ + write_pos_) % size_;
+        size_t to_read = std::min(len, available);
+        
+        if (to_read == 0) return 0;
+        
+        if (read_pos_ + to_read <= size_) {
+            std::memcpy(data, buffer_.data() + read_pos_, to_read);
+            read_pos_ = (read_pos_ + to_read) % size_;
+        } else {
+            size_t first_part = size_ - read_pos_;
+            std::memcpy(data, buffer_.data() + read_pos_, first_part);
+            std::memcpy(data + first_part, buffer_.data(), to_read - first_part);
+            read_pos_ = to_read - first_part;
+        }
+        
+        return to_read;
+    }
+};
+
+// "Magic" Ring Buffer: одна и та же физическая память отображена дважды подряд
+//
+//   виртуальные адреса: [ копия 0 | копия 1 ]
+//   физическая память:  [   memfd (capacity)  ]
+//
+// Запись, которая "переваливает" через конец первой копии, физически попадает
+// в начало буфера. Поэтому любой readable/writable регион всегда непрерывен:
+// - recv()/send() прямо в буфер/из буфера, без промежуточного char[]
+// - парсер HTTP/WebSocket видит сообщение целиком, даже если оно на стыке
+// - счётчики read_/write_ монотонные, поэтому полный буфер отличим от пустого
+//   без "потерянного" слота (в RingBuffer выше всегда пропадает 1 байт)
+
+#include <sys/mman.h>
+#include <span>
+#include <bit>
+
+class MirroredRingBuffer {
+    char* base_ = nullptr;
+    size_t capacity_ = 0;     // Степень двойки и кратна размеру страницы
+    uint64_t read_ = 0;       // Сколько байт всего прочитано
+    uint64_t write_ = 0;      // Сколько байт всего записано
+
+public:
+    explicit MirroredRingBuffer(size_t min_capacity) {
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        capacity_ = std::bit_ceil(std::max(min_capacity, page));
+
+        int fd = memfd_create("ring_buffer", MFD_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("memfd_create failed");
+        }
+
+        if (ftruncate(fd, capacity_) < 0) {
+            close(fd);
+            throw std::runtime_error("ftruncate failed");
+        }
+
+        // Резервируем 2 * capacity виртуального адресного пространства...
+        void* area = mmap(nullptr, 2 * capacity_, PROT_NONE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (area == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("mmap reserve failed");
+        }
+        base_ = static_cast<char*>(area);
+
+        // ...и кладём в обе половины один и тот же memfd
+        void* first = mmap(base_, capacity_, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_FIXED, fd, 0);
+        void* second = mmap(base_ + capacity_, capacity_, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_FIXED, fd, 0);
+        close(fd);  // Отображения держат memfd сами
+
+        if (first == MAP_FAILED || second == MAP_FAILED) {
+            munmap(base_, 2 * capacity_);
+            throw std::runtime_error("mmap mirror failed");
+        }
+    }
+
+    ~MirroredRingBuffer() {
+        if (base_) munmap(base_, 2 * capacity_);
+    }
+
+    MirroredRingBuffer(MirroredRingBuffer&& other) noexcept
+        : base_(std::exchange(other.base_, nullptr)),
+          capacity_(other.capacity_), read_(other.read_), write_(other.write_) {}
+
+    MirroredRingBuffer(const MirroredRingBuffer&) = delete;
+    MirroredRingBuffer& operator=(const MirroredRingBuffer&) = delete;
+
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return static_cast<size_t>(write_ - read_); }
+    size_t free() const { return capacity_ - size(); }
+    bool empty() const { return read_ == write_; }
+
+    // Непрерывный регион для записи (до n байт) - отдаём прямо в recv()
+    std::span<char> prepare(size_t n) {
+        return {base_ + (write_ & (capacity_ - 1)), std::min(n, free())};
+    }
+
+    // Подтверждаем, что n байт из prepare() заполнены
+    void commit(size_t n) {
+        write_ += std::min(n, free());
+    }
+
+    // Все непрочитанные данные одним непрерывным куском
+    std::span<const char> data() const {
+        return {base_ + (read_ & (capacity_ - 1)), size()};
+    }
+
+    std::string_view view() const {
+        auto d = data();
+        return {d.data(), d.size()};
+    }
+
+    // Освобождаем n байт с начала
+    void consume(size_t n) {
+        read_ += std::min(n, size());
+    }
+
+    // recv() прямо в буфер: ни одного memcpy
+    ssize_t read_from(int fd) {
+        auto space = prepare(free());
+        if (space.empty()) return 0;
+
+        ssize_t n = recv(fd, space.data(), space.size(), 0);
+        if (n > 0) commit(n);
+        return n;
+    }
+
+    // send() прямо из буфера
+    ssize_t write_to(int fd) {
+        auto pending = data();
+        if (pending.empty()) return 0;
+
+        ssize_t n = send(fd, pending.data(), pending.size(), MSG_NOSIGNAL);
+        if (n > 0) consume(n);
+        return n;
+    }
+};
+
+// Соединение на MirroredRingBuffer: парсеры читают непрерывный view прямо из кольца,
+// даже если сообщение лежит на стыке. Парсеры - существующие, из других модулей;
+// они - параметры шаблона, чтобы этот файл от них не зависел:
+// - Request = HttpRequest (http_server.cpp): Request::parse(std::string_view) → std::expected
+// - Frame = WebSocketFrame (websocket.cpp): Frame::parse(const uint8_t*, size_t, size_t& consumed)
+
+// HTTP: отвечаем на каждый полный запрос; body не ждём (пример без Content-Length)
+template <typename Request>
+void serve_http_from_ring(int client_fd, MirroredRingBuffer& in, MirroredRingBuffer& out) {
+    while (in.read_from(client_fd) > 0) {
+        size_t end;
+        while ((end = in.view().find("\r\n\r\n")) != std::string_view::npos) {
+            auto request = Request::parse(in.view().substr(0, end + 4));
+            in.consume(end + 4);
+
+            std::string_view reply = request ? "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n"
+                                             : "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n";
+            if (request) std::cout << request->method << ' ' << request->path << '\n';
+
+            auto space = out.prepare(reply.size());
+            std::memcpy(space.data(), reply.data(), space.size());
+            out.commit(space.size());
+            out.write_to(client_fd);
+            if (!request) return;
+        }
+    }
+}
+
+// WebSocket (после рукопожатия): все полные фреймы из кольца, остаток ждёт следующего recv
+template <typename Frame, typename OnFrame>
+void read_websocket_frames_from_ring(int client_fd, MirroredRingBuffer& in, OnFrame&& on_frame) {
+    while (in.read_from(client_fd) > 0) {
+        while (true) {
+            auto bytes = in.data();
+            size_t consumed = 0;
+            auto frame = Frame::parse(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size(), consumed);
+            if (!frame) break;
+            in.consume(consumed);
+            if (!on_frame(*frame)) return;   // false - закрыть (например, CLOSE)
+        }
+    }
+}
+
+// Бенчмарк: echo через socketpair, RingBuffer vs MirroredRingBuffer
+// RingBuffer: recv → char[] → write() (memcpy) → read() (memcpy) → char[] → send
+// Mirrored:   recv → кольцо → send
+void mirrored_ring_benchmark() {
+    constexpr size_t chunk = 1500;                 // Типичный размер сегмента
+    constexpr size_t total = 512 * 1024 * 1024;    // 512 MB через echo
+    constexpr size_t ring_size = 64 * 1024;
+
+    auto run = [&](const char* name, auto&& echo_step) {
+        int sv[2];
+        socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+        int client = sv[0], server = sv[1];
+        fcntl(server, F_SETFL, fcntl(server, F_GETFL, 0) | O_NONBLOCK);
+
+        std::vector<char> out(chunk, 'x');
+        std::vector<char> back(chunk);
+        size_t sent = 0, received = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        while (received < total) {
+            if (sent < total) {
+                ssize_t n = send(client, out.data(), chunk, MSG_DONTWAIT);
+                if (n > 0) sent += n;
+            }
+            echo_step(server);  // Сервер: прочитать и отправить обратно
+            ssize_t n = recv(client, back.data(), back.size(), MSG_DONTWAIT);
+            if (n > 0) received += n;
+        }
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+        std::cout << name << ": " << (total / (1024.0 * 1024.0)) / seconds << " MB/s\n";
+        close(client);
+        close(server);
+    };
+
+    {
+        RingBuffer ring(ring_size);
+        std::vector<char> in_tmp(ring_size), out_tmp(ring_size);
+        size_t buffered = 0;               // RingBuffer не знает свой free() - считаем сами
+        size_t out_pos = 0, out_len = 0;   // Неотправленный остаток во временном буфере
+
+        run("RingBuffer        ", [&](int fd) {
+            size_t space = ring_size - 1 - buffered;  // Один слот всегда пропадает
+            ssize_t n = space ? recv(fd, in_tmp.data(), space, 0) : 0;
+            if (n > 0) buffered += ring.write(in_tmp.data(), n);  // Копия 1
+
+            if (out_pos == out_len) {
+                out_len = ring.read(out_tmp.data(), out_tmp.size()); // Копия 2
+                buffered -= out_len;
+                out_pos = 0;
+            }
+            if (out_pos < out_len) {
+                ssize_t m = send(fd, out_tmp.data() + out_pos, out_len - out_pos, 0);
+                if (m > 0) out_pos += m;
+            }
+        });
+    }
+
+    {
+        MirroredRingBuffer ring(ring_size);
+
+        run("MirroredRingBuffer", [&](int fd) {
+            ring.read_from(fd);  // recv прямо в кольцо
+            ring.write_to(fd);   // send прямо из кольца
+        });
+    }
+}
+
+// Scatter/Gather I/O - векторизованные операции
+void scatter_gather_example(int sockfd) {
+    // Подготовка нескольких буферов
+    char header[128];
+    char body[1024];
+    char footer[64];
+    
+    // Scatter read - читаем в несколько буферов одной операцией
+    iovec iov[3];
+    iov[0].iov_base = header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = body;
+    iov[1].iov_len = sizeof(body);
+    iov[2].iov_base = footer;
+    iov[2].iov_len = sizeof(footer);
+    
+    ssize_t n = readv(sockfd, iov, 3);
+    
+    // Gather write - отправляем несколько буферов одной операцией
+    ssize_t sent = writev(sockfd, iov, 3);
+    
+    std::cout << "Read: " << n << ", Sent: " << sent << '\n';
+}
+
+// Buffer Pool - переиспользование буферов
+class BufferPool {
+    std::vector<std::unique_ptr<char[]>> buffers_;
+    std::queue<char*> available_;
+    std::mutex mutex_;
+    size_t buffer_size_;
+    
+public:
+    BufferPool(size_t buffer_size, size_t count) 
+        : buffer_size_(buffer_size) {
+        for (size_t i = 0; i < count; ++i) {
+            auto buffer = std::make_unique<char[]>(buffer_size);
+            available_.push(buffer.get());
+            buffers_.push_back(std::move(buffer));
+        }
+    }
+    
+    char* acquire() {
+        std::lock_guard lock(mutex_);
+        
+        if (available_.empty()) {
+            // Создаём новый буфер
+            auto buffer = std::make_unique<char[]>(buffer_size_);
+            char* ptr = buffer.get();
+            buffers_.push_back(std::move(buffer));
+            return ptr;
+        }
+        
+        char* buffer = available_.front();
+        available_.pop();
+        return buffer;
+    }
+    
+    void release(char* buffer) {
+        std::lock_guard lock(mutex_);
+        available_.push(buffer);
+    }
+};
+
+// ============================================
+// 📌 Size-Class Buffer Pool (thread-local магазины + lock-free freelist)
+// ============================================
+
+// Проблемы BufferPool выше:
+// - mutex на каждый acquire/release
+// - один размер буфера на весь пул
+// - при пустом пуле растёт без ограничений (при всплеске нагрузки → OOM)
+// - память никогда не возвращается ОС
+//
+// Устройство SizeClassBufferPool:
+// - классы размеров 256 B ... 64 KB (степени двойки)
+// - память нарезается из slab'ов по 1 MB (mmap)
+// - у каждого потока "магазин" на класс: acquire/release без атомиков вообще
+// - магазины обмениваются пачками с глобальным lock-free стеком (Treiber + tag против ABA)
+// - связи freelist'а хранятся ВНЕ буферов → свободные slab'ы можно madvise(DONTNEED)
+// - счётчики slab'ов трогаются только при обмене пачками, не на каждый acquire
+// - hard cap на резидентный объём slab'ов: при исчерпании try_acquire() возвращает
+//   пустой handle; trim() уменьшает резидентный объём, и cap снова свободен другим классам
+
+class SizeClassBufferPool;
+
+// RAII-handle: возвращает буфер в пул в деструкторе
+class PooledBuffer {
+    SizeClassBufferPool* pool_ = nullptr;
+    char* data_ = nullptr;
+    uint32_t index_ = 0;
+    uint8_t size_class_ = 0;
+
+    friend class SizeClassBufferPool;
+    PooledBuffer(SizeClassBufferPool* pool, char* data, uint32_t index, uint8_t cls)
+        : pool_(pool), data_(data), index_(index), size_class_(cls) {}
+
+public:
+    PooledBuffer() = default;
+    ~PooledBuffer() { reset(); }
+
+    PooledBuffer(PooledBuffer&& other) noexcept
+        : pool_(std::exchange(other.pool_, nullptr)),
+          data_(std::exchange(other.data_, nullptr)),
+          index_(other.index_), size_class_(other.size_class_) {}
+
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept {
+        if (this != &other) {
+            reset();
+            pool_ = std::exchange(other.pool_, nullptr);
+            data_ = std::exchange(other.data_, nullptr);
+            index_ = other.index_;
+            size_class_ = other.size_class_;
+        }
+        return *this;
+    }
+
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    explicit operator bool() const { return data_ != nullptr; }
+    char* data() const { return data_; }
+    size_t capacity() const;
+    std::span<char> span() const { return {data_, capacity()}; }
+
+    // Для readv/writev
+    iovec iov(size_t len) const { return {data_, std::min(len, capacity())}; }
+    iovec iov() const { return {data_, capacity()}; }
+
+    inline void reset();
+};
+
+class SizeClassBufferPool {
+public:
+    static constexpr size_t MIN_SHIFT = 8;                 // 256 B
+    static constexpr size_t MAX_SHIFT = 16;                // 64 KB
+    static constexpr size_t CLASS_COUNT = MAX_SHIFT - MIN_SHIFT + 1;
+    static constexpr size_t SLAB_SHIFT = 20;               // 1 MB
+    static constexpr size_t SLAB_BYTES = size_t(1) << SLAB_SHIFT;
+    static constexpr uint32_t MAGAZINE_SIZE = 32;
+
+    struct ClassStats {
+        size_t buffer_size;
+        uint64_t hits;       // Выдано из магазина/freelist'а
+        uint64_t misses;     // Пришлось нарезать новый slab
+        uint64_t rejects;    // Отказ: упёрлись в memory cap
+        size_t slabs;
+    };
+
+private:
+    static constexpr uint32_t EMPTY = 0xFFFFFFFF;
+    static constexpr uint32_t CAPPED = 0xFFFFFFFE;   // Буфер есть, но его slab нельзя вернуть в память: cap
+    static constexpr int32_t TRIMMING = INT32_MIN / 2;
+
+    struct Slab {
+        char* memory = nullptr;
+        std::unique_ptr<std::atomic<uint32_t>[]> next;  // Связи freelist'а вне буферов
+        std::atomic<int32_t> in_global{0};              // Буферов в глобальном стеке
+        std::atomic<bool> resident{true};               // false после madvise
+    };
+
+    struct alignas(64) SizeClass {
+        size_t shift = 0;
+        uint32_t per_slab = 0;
+        std::atomic<uint64_t> free_head{EMPTY};         // (tag << 32) | index
+        std::unique_ptr<std::atomic<Slab*>[]> slabs;
+        std::atomic<uint32_t> slab_count{0};
+        uint32_t max_slabs = 0;
+        std::mutex grow_mutex;                          // Только для нарезки нового slab'а
+
+        alignas(64) std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> rejects{0};
+    };
+
+    // Thread-local кэш: магазины потока для одного (последнего использованного) пула
+    struct ThreadCache {
+        uint64_t pool_id = 0;
+        uint32_t items[CLASS_COUNT][MAGAZINE_SIZE];
+        uint32_t count[CLASS_COUNT] = {};
+        uint64_t pending_hits[CLASS_COUNT] = {};  // Сбрасываются в общий счётчик пачками
+
+        ~ThreadCache() {
+            // Пул мог быть уничтожен раньше потока - проверяем по реестру
+            std::lock_guard lock(registry_mutex());
+            auto it = registry().find(pool_id);
+            if (it != registry().end()) it->second->flush_cache(*this);
+        }
+    };
+
+    SizeClass classes_[CLASS_COUNT];
+    const size_t memory_cap_;
+    std::atomic<size_t> mapped_bytes_{0};     // Адресное пространство slab'ов
+    std::atomic<size_t> resident_bytes_{0};   // Slab'ы без madvise - именно их ограничивает cap
+    const uint64_t id_;
+
+    static std::mutex& registry_mutex() { static std::mutex m; return m; }
+    static std::unordered_map<uint64_t, SizeClassBufferPool*>& registry() {
+        static std::unordered_map<uint64_t, SizeClassBufferPool*> r;
+        return r;
+    }
+    static uint64_t next_id() {
+        static std::atomic<uint64_t> id{1};
+        return id.fetch_add(1);
+    }
+
+    friend class PooledBuffer;
+
+public:
+    explicit SizeClassBufferPool(size_t memory_cap = size_t(1) << 30)
+        : memory_cap_(memory_cap), id_(next_id()) {
+        for (size_t c = 0; c < CLASS_COUNT; ++c) {
+            SizeClass& sc = classes_[c];
+            sc.shift = MIN_SHIFT + c;
+            sc.per_slab = uint32_t(SLAB_BYTES >> sc.shift);
+            sc.max_slabs = uint32_t(memory_cap / SLAB_BYTES) + 1;
+            sc.slabs.reset(new std::atomic<Slab*>[sc.max_slabs]);
+            for (uint32_t s = 0; s < sc.max_slabs; ++s) sc.slabs[s].store(nullptr);
+        }
+
+        std::lock_guard lock(registry_mutex());
+        registry()[id_] = this;
+    }
+
+    ~SizeClassBufferPool() {
+        {
+            std::lock_guard lock(registry_mutex());
+            registry().erase(id_);
+        }
+
+        for (SizeClass& sc : classes_) {
+            for (uint32_t s = 0; s < sc.slab_count.load(); ++s) {
+                Slab* slab = sc.slabs[s].load();
+                munmap(slab->memory, SLAB_BYTES);
+                delete slab;
+            }
+        }
+    }
+
+    SizeClassBufferPool(const SizeClassBufferPool&) = delete;
+    SizeClassBufferPool& operator=(const SizeClassBufferPool&) = delete;
+
+    static constexpr size_t max_buffer_size() { return size_t(1) << MAX_SHIFT; }
+
+    // Неблокирующий: пустой handle, если класс исчерпан и cap не даёт расти
+    PooledBuffer try_acquire(size_t size) {
+        if (size > max_buffer_size()) return {};
+
+        uint8_t cls = class_of(size);
+        SizeClass& sc = classes_[cls];
+        ThreadCache& cache = thread_cache();
+
+        if (cache.count[cls] == 0 && !refill(cache, cls)) {
+            return {};
+        }
+
+        // Горячий путь: только магазин потока, ни одного атомика
+        uint32_t index = cache.items[cls][--cache.count[cls]];
+        ++cache.pending_hits[cls];
+
+        return PooledBuffer(this, address_of(sc, index), index, cls);
+    }
+
+    // Backpressure: ждём освобождения буфера не дольше timeout
+    PooledBuffer acquire(size_t size, std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        auto backoff = std::chrono::microseconds(10);
+
+        while (true) {
+            if (auto buffer = try_acquire(size)) return buffer;
+            if (std::chrono::steady_clock::now() >= deadline) return {};
+
+            std::this_thread::sleep_for(backoff);
+            backoff = std::min(backoff * 2, std::chrono::microseconds(1000));
+        }
+    }
+
+    // Вернуть ОС физическую память slab'ов, все буферы которых лежат в глобальном стеке.
+    // Адресное пространство остаётся за пулом - следующий acquire получит нулевые страницы
+    size_t trim() {
+        // Сначала отдаём свой магазин, иначе его буферы держат slab'ы "тёплыми"
+        ThreadCache& cache = thread_cache();
+        flush_cache(cache);
+
+        size_t released = 0;
+        for (SizeClass& sc : classes_) {
+            uint32_t count = sc.slab_count.load(std::memory_order_acquire);
+
+            for (uint32_t s = 0; s < count; ++s) {
+                Slab* slab = sc.slabs[s].load(std::memory_order_acquire);
+                if (!slab->resident.load(std::memory_order_relaxed)) continue;
+
+                // Все буферы slab'а свободны → помечаем, что идёт trim
+                int32_t expected = int32_t(sc.per_slab);
+                if (!slab->in_global.compare_exchange_strong(expected, expected + TRIMMING)) {
+                    continue;
+                }
+
+                {
+                    // Под grow_mutex: revive() этого slab'а не пересчитает его дважды
+                    std::lock_guard lock(sc.grow_mutex);
+                    madvise(slab->memory, SLAB_BYTES, MADV_DONTNEED);
+                    slab->resident.store(false, std::memory_order_relaxed);
+                    resident_bytes_.fetch_sub(SLAB_BYTES, std::memory_order_relaxed);
+                }
+                slab->in_global.fetch_sub(TRIMMING, std::memory_order_release);
+                released += SLAB_BYTES;
+            }
+        }
+        return released;
+    }
+
+    std::vector<ClassStats> stats() {
+        flush_hits(thread_cache());
+
+        std::vector<ClassStats> result;
+        for (SizeClass& sc : classes_) {
+            result.push_back({size_t(1) << sc.shift,
+                              sc.hits.load(std::memory_order_relaxed),
+                              sc.misses.load(std::memory_order_relaxed),
+                              sc.rejects.load(std::memory_order_relaxed),
+                              sc.slab_count.load(std::memory_order_relaxed)});
+        }
+        return result;
+    }
+
+    size_t mapped_bytes() const { return mapped_bytes_.load(std::memory_order_relaxed); }
+    size_t resident_bytes() const { return resident_bytes_.load(std::memory_order_relaxed); }
+
+private:
+    static uint8_t class_of(size_t size) {
+        size_t shift = std::bit_width(std::max(size, size_t(1) << MIN_SHIFT) - 1);
+        return uint8_t(shift - MIN_SHIFT);
+    }
+
+    Slab* slab_of(SizeClass& sc, uint32_t index) {
+        return sc.slabs[index / sc.per_slab].load(std::memory_order_acquire);
+    }
+
+    char* address_of(SizeClass& sc, uint32_t index) {
+        return slab_of(sc, index)->memory + (size_t(index % sc.per_slab) << sc.shift);
+    }
+
+    std::atomic<uint32_t>& next_of(SizeClass& sc, uint32_t index) {
+        return slab_of(sc, index)->next[index % sc.per_slab];
+    }
+
+    ThreadCache& thread_cache() {
+        static thread_local ThreadCache cache;
+        if (cache.pool_id != id_) {
+            // Поток переключился на другой пул: старый магазин отдаём его владельцу
+            {
+                std::lock_guard lock(registry_mutex());
+                auto it = registry().find(cache.pool_id);
+                if (it != registry().end()) it->second->flush_cache(cache);
+            }
+            std::fill(std::begin(cache.count), std::end(cache.count), 0u);
+            std::fill(std::begin(cache.pending_hits), std::end(cache.pending_hits), 0u);
+            cache.pool_id = id_;
+        }
+        return cache;
+    }
+
+    // Резервирует cap под страницы slab'а, отданные trim(); false - cap исчерпан
+    bool revive(SizeClass& sc, Slab* slab) {
+        std::lock_guard lock(sc.grow_mutex);
+        if (slab->resident.load(std::memory_order_relaxed)) return true;   // Уже вернул другой поток
+        if (!reserve_resident()) return false;
+        slab->resident.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool reserve_resident() {
+        if (resident_bytes_.fetch_add(SLAB_BYTES, std::memory_order_relaxed) + SLAB_BYTES > memory_cap_) {
+            resident_bytes_.fetch_sub(SLAB_BYTES, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    // Lock-free pop из глобального стека класса.
+    // EMPTY - стек пуст; CAPPED - на вершине буфер trim'нутого slab'а, а cap не даёт его вернуть
+    uint32_t pop_global(SizeClass& sc) {
+        uint64_t head = sc.free_head.load(std::memory_order_acquire);
+        while (true) {
+            uint32_t index = uint32_t(head);
+            if (index == EMPTY) return EMPTY;
+
+            uint32_t next = next_of(sc, index).load(std::memory_order_relaxed);
+            uint64_t tag = (head >> 32) + 1;  // Tag растёт на каждую операцию - защита от ABA
+            if (!sc.free_head.compare_exchange_weak(head, (tag << 32) | next,
+                    std::memory_order_acquire, std::memory_order_acquire)) {
+                continue;
+            }
+
+            Slab* slab = slab_of(sc, index);
+            if (slab->in_global.fetch_sub(1, std::memory_order_acquire) < 0) {
+                // Параллельный trim() как раз делает madvise этого slab'а - дожидаемся
+                while (slab->in_global.load(std::memory_order_acquire) < 0) {
+                    std::this_thread::yield();
+                }
+            }
+            if (!slab->resident.load(std::memory_order_relaxed) && !revive(sc, slab)) {
+                // Кладём буфер обратно - он остаётся свободным
+                slab->in_global.fetch_add(1, std::memory_order_relaxed);
+                push_global(sc, index, index);
+                return CAPPED;
+            }
+            return index;
+        }
+    }
+
+    // Lock-free push цепочки first → ... → last одним CAS.
+    // Счётчики in_global увеличивает вызывающий - ДО публикации цепочки
+    void push_global(SizeClass& sc, uint32_t first, uint32_t last) {
+        uint64_t head = sc.free_head.load(std::memory_order_relaxed);
+        while (true) {
+            next_of(sc, last).store(uint32_t(head), std::memory_order_relaxed);
+            uint64_t tag = (head >> 32) + 1;
+            if (sc.free_head.compare_exchange_weak(head, (tag << 32) | first,
+                    std::memory_order_release, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+    // Магазин пуст: берём половину магазина из глобального стека или режем slab
+    bool refill(ThreadCache& cache, uint8_t cls) {
+        SizeClass& sc = classes_[cls];
+        flush_hits(cache);
+
+        // Новый slab могут разобрать другие потоки раньше нас - тогда снова в стек / grow.
+        // Пустой handle - только когда упёрлись в cap
+        while (true) {
+            uint32_t index = EMPTY;
+            while (cache.count[cls] < MAGAZINE_SIZE / 2) {
+                index = pop_global(sc);
+                if (index == EMPTY || index == CAPPED) break;
+                cache.items[cls][cache.count[cls]++] = index;
+            }
+            if (cache.count[cls] > 0) return true;
+
+            if (index == CAPPED || !grow(sc)) {
+                sc.rejects.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+    }
+
+    bool grow(SizeClass& sc) {
+        std::lock_guard lock(sc.grow_mutex);
+
+        // Пока ждали mutex, кто-то мог уже нарезать slab
+        if (uint32_t(sc.free_head.load(std::memory_order_acquire)) != EMPTY) return true;
+
+        uint32_t slab_no = sc.slab_count.load(std::memory_order_relaxed);
+        if (slab_no >= sc.max_slabs) return false;
+
+        // Hard cap: резервируем резидентные байты до mmap
+        if (!reserve_resident()) return false;
+
+        void* memory = mmap(nullptr, SLAB_BYTES, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            resident_bytes_.fetch_sub(SLAB_BYTES, std::memory_order_relaxed);
+            return false;
+        }
+        mapped_bytes_.fetch_add(SLAB_BYTES, std::memory_order_relaxed);
+        sc.misses.fetch_add(1, std::memory_order_relaxed);
+
+        auto* slab = new Slab;
+        slab->memory = static_cast<char*>(memory);
+        slab->in_global.store(int32_t(sc.per_slab), std::memory_order_relaxed);
+        slab->next.reset(new std::atomic<uint32_t>[sc.per_slab]);
+
+        uint32_t base = slab_no * sc.per_slab;
+        for (uint32_t i = 0; i + 1 < sc.per_slab; ++i) {
+            slab->next[i].store(base + i + 1, std::memory_order_relaxed);
+        }
+
+        sc.slabs[slab_no].store(slab, std::memory_order_release);
+        sc.slab_count.store(slab_no + 1, std::memory_order_release);
+        push_global(sc, base, base + sc.per_slab - 1);
+        return true;
+    }
+
+    void release(uint8_t cls, uint32_t index) {
+        ThreadCache& cache = thread_cache();
+        if (cache.count[cls] == MAGAZINE_SIZE) {
+            // Магазин полон: отдаём половину одной цепочкой
+            flush_half(cache, cls);
+        }
+        cache.items[cls][cache.count[cls]++] = index;
+    }
+
+    void flush_half(ThreadCache& cache, uint8_t cls) {
+        SizeClass& sc = classes_[cls];
+        uint32_t keep = cache.count[cls] / 2;
+        uint32_t* items = cache.items[cls];
+
+        link_chain(sc, items + keep, cache.count[cls] - keep);
+        push_global(sc, items[keep], items[cache.count[cls] - 1]);
+        cache.count[cls] = keep;
+    }
+
+    void link_chain(SizeClass& sc, const uint32_t* items, uint32_t n) {
+        for (uint32_t i = 0; i < n; ++i) {
+            slab_of(sc, items[i])->in_global.fetch_add(1, std::memory_order_relaxed);
+            if (i + 1 < n) {
+                next_of(sc, items[i]).store(items[i + 1], std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void flush_hits(ThreadCache& cache) {
+        for (size_t c = 0; c < CLASS_COUNT; ++c) {
+            if (cache.pending_hits[c]) {
+                classes_[c].hits.fetch_add(cache.pending_hits[c], std::memory_order_relaxed);
+                cache.pending_hits[c] = 0;
+            }
+        }
+    }
+
+    void flush_cache(ThreadCache& cache) {
+        flush_hits(cache);
+        for (uint8_t c = 0; c < CLASS_COUNT; ++c) {
+            if (cache.count[c] == 0) continue;
+
+            SizeClass& sc = classes_[c];
+            uint32_t* items = cache.items[c];
+            link_chain(sc, items, cache.count[c]);
+            push_global(sc, items[0], items[cache.count[c] - 1]);
+            cache.count[c] = 0;
+        }
+    }
+};
+
+inline size_t PooledBuffer::capacity() const {
+    return data_ ? size_t(1) << (SizeClassBufferPool::MIN_SHIFT + size_class_) : 0;
+}
+
+inline void PooledBuffer::reset() {
+    if (pool_) {
+        pool_->release(size_class_, index_);
+        pool_ = nullptr;
+        data_ = nullptr;
+    }
+}
+
+// Scatter/Gather на пуловых буферах: header/body/footer разных классов
+void scatter_gather_pooled(int sockfd, SizeClassBufferPool& pool) {
+    PooledBuffer header = pool.try_acquire(128);
+    PooledBuffer body = pool.acquire(16 * 1024, std::chrono::milliseconds(50));
+    PooledBuffer footer = pool.try_acquire(64);
+
+    if (!header || !body || !footer) {
+        // Cap исчерпан - не читаем из сокета, пусть TCP притормозит отправителя
+        return;
+    }
+
+    iovec iov[3] = {header.iov(128), body.iov(), footer.iov(64)};
+
+    ssize_t n = readv(sockfd, iov, 3);
+    if (n > 0) {
+        ssize_t sent = writev(sockfd, iov, 3);
+        std::cout << "Read: " << n << ", Sent: " << sent << '\n';
+    }
+    // Буферы вернутся в магазин потока автоматически
+}
+
+void size_class_pool_example() {
+    SizeClassBufferPool pool(64 * 1024 * 1024);  // Не больше 64 MB под буферы
+
+    {
+        std::vector<PooledBuffer> burst;
+        for (int i = 0; i < 1000; ++i) {
+            burst.push_back(pool.try_acquire(4096));
+        }
+    }  // Всплеск закончился - буферы вернулись в пул
+
+    std::cout << "Mapped: " << pool.mapped_bytes() << ", trimmed: " << pool.trim()
+              << ", resident: " << pool.resident_bytes() << '\n';
+
+    for (const auto& s : pool.stats()) {
+        if (s.hits || s.misses || s.rejects) {
+            std::cout << s.buffer_size << " B: hits=" << s.hits << " misses=" << s.misses
+                      << " rejects=" << s.rejects << " slabs=" << s.slabs << '\n';
+        }
+    }
+
+    // Cap считает резидентные байты: после trim() место достаётся и другим классам
+    SizeClassBufferPool small(4 * 1024 * 1024);
+    {
+        std::vector<PooledBuffer> burst;
+        while (auto buffer = small.try_acquire(64 * 1024)) burst.push_back(std::move(buffer));
+    }
+    small.trim();
+    std::cout << "256 B after 64 KB burst + trim: " << (small.try_acquire(256) ? "ok" : "rejected") << '\n';
+}
+
+// Бенчмарк: acquire/release из нескольких потоков, BufferPool vs SizeClassBufferPool
+void size_class_pool_benchmark() {
+    constexpr int threads = 4;
+    constexpr int iterations = 1'000'000;
+
+    auto run = [&](const char* name, auto&& body) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) workers.emplace_back(body);
+        for (auto& w : workers) w.join();
+
+        double ns = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << ns / (double(threads) * iterations) << " ns/op\n";
+    };
+
+    BufferPool old_pool(4096, 64);
+    run("BufferPool         ", [&] {
+        for (int i = 0; i < iterations; ++i) {
+            char* buffer = old_pool.acquire();
+            buffer[0] = char(i);
+            old_pool.release(buffer);
+        }
+    });
+
+    SizeClassBufferPool pool;
+    run("SizeClassBufferPool", [&] {
+        for (int i = 0; i < iterations; ++i) {
+            PooledBuffer buffer = pool.try_acquire(4096);
+            buffer.data()[0] = char(i);
+        }
+    });
+}
+
 // ============================================
 // 📌 Performance Optimization
 // ============================================
@@ -12,43 +12,79 @@
 #include <filesystem>
 #include <expected>
 #include <chrono>
+#include <charconv>
+#include <memory_resource>
+#include <string_view>
+
+// --- Строки и словари запроса ---
+// Всё, что живёт один запрос, - pmr: память берётся из арены запроса
+// (RequestArena ниже), без арены - из обычной кучи (get_default_resource)
+
+// Прозрачные hash/equal: поиск по string_view / const char* без временной строки
+struct StringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+
+struct StringEqual {
+    using is_transparent = void;
+    bool operator()(std::string_view a, std::string_view b) const { return a == b; }
+};
+
+using StringMap = std::pmr::unordered_map<std::pmr::string, std::pmr::string, StringHash, StringEqual>;
+
+// map[key] = value без временного ключа: узел и строки - в аллокаторе словаря
+inline void set_value(StringMap& map, std::string_view key, std::string_view value) {
+    if (auto it = map.find(key); it != map.end()) {
+        it->second = value;
+    } else {
+        map.emplace(key, value);
+    }
+}
 
 // --- Парсинг HTTP запроса ---
 struct HttpRequest {
-    std::string method;           // GET, POST, PUT, DELETE
-    std::string path;             // /api/users
-    std::string version;          // HTTP/1.1
-    std::unordered_map<std::string, std::string> headers;
-    std::unordered_map<std::string, std::string> query_params;
-    std::string body;
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    std::pmr::string method;      // GET, POST, PUT, DELETE
+    std::pmr::string path;        // /api/users
+    std::pmr::string version;     // HTTP/1.1
+    StringMap headers;
+    StringMap query_params;
+    std::pmr::string body;
+    
+    explicit HttpRequest(allocator_type alloc = {})
+        : method(alloc), path(alloc), version(alloc),
+          headers(alloc), query_params(alloc), body(alloc) {}
+    
+    allocator_type get_allocator() const { return body.get_allocator(); }
     
     // Парсинг query параметров из URL
-    static void parse_query_string(const std::string& query, 
-                                   std::unordered_map<std::string, std::string>& params) {
-        std::istringstream stream(query);
-        std::string pair;
-        
-        while (std::getline(stream, pair, '&')) {
+    static void parse_query_string(std::string_view query, StringMap& params) {
+        while (!query.empty()) {
+            auto amp = query.find('&');
+            auto pair = query.substr(0, amp);
+            query = amp == std::string_view::npos ? std::string_view{} : query.substr(amp + 1);
+            
             auto eq_pos = pair.find('=');
-            if (eq_pos != std::string::npos) {
-                auto key = pair.substr(0, eq_pos);
-                auto value = pair.substr(eq_pos + 1);
-                params[url_decode(key)] = url_decode(value);
+            if (eq_pos != std::string_view::npos) {
+                auto alloc = params.get_allocator();
+                params.insert_or_assign(url_decode(pair.substr(0, eq_pos), alloc),
+                                        url_decode(pair.substr(eq_pos + 1), alloc));
             }
         }
     }
     
     // URL декодирование (%20 -> пробел)
-    static std::string url_decode(const std::string& str) {
-        std::string result;
+    static std::pmr::string url_decode(std::string_view str, allocator_type alloc = {}) {
+        std::pmr::string result(alloc);
+        result.reserve(str.size());
         for (size_t i = 0; i < str.length(); ++i) {
-            if (str[i] == '%' && i + 2 < str.length()) {
-                int value;
-                std::istringstream hex(str.substr(i + 1, 2));
-                if (hex >> std::hex >> value) {
-                    result += static_cast<char>(value);
-                    i += 2;
-                }
+            int value = 0;
+            if (str[i] == '%' && i + 2 < str.length() &&
+                std::from_chars(str.data() + i + 1, str.data() + i + 3, value, 16).ptr == str.data() + i + 3) {
+                result += static_cast<char>(value);
+                i += 2;
             } else if (str[i] == '+') {
                 result += ' ';
             } else {
@@ -58,52 +94,55 @@ struct HttpRequest {
         return result;
     }
     
-    // Парсинг HTTP запроса из строки
-    static std::expected<HttpRequest, std::string> parse(const std::string& data) {
-        HttpRequest req;
-        std::istringstream stream(data);
-        std::string line;
+    // Парсинг HTTP запроса из строки.
+    // Разбор по string_view: копируются только сами поля, и только в alloc
+    static std::expected<HttpRequest, std::string> parse(std::string_view data, allocator_type alloc = {}) {
+        HttpRequest req(alloc);
+        
+        // Следующая строка без \r\n; false - данных больше нет
+        auto next_line = [&data](std::string_view& line) {
+            if (data.empty()) return false;
+            auto eol = data.find('\n');
+            line = data.substr(0, eol);
+            data = eol == std::string_view::npos ? std::string_view{} : data.substr(eol + 1);
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            return true;
+        };
         
         // Парсинг Request Line: GET /path HTTP/1.1
-        if (!std::getline(stream, line)) {
+        std::string_view line;
+        if (!next_line(line) || line.empty()) {
             return std::unexpected("Empty request");
         }
         
-        std::istringstream request_line(line);
-        std::string path_with_query;
-        request_line >> req.method >> path_with_query >> req.version;
+        auto sp1 = line.find(' ');
+        auto sp2 = line.find(' ', sp1 == std::string_view::npos ? sp1 : sp1 + 1);
+        if (sp1 == std::string_view::npos || sp2 == std::string_view::npos) {
+            return std::unexpected("Malformed request line");
+        }
+        req.method = line.substr(0, sp1);
+        auto path_with_query = line.substr(sp1 + 1, sp2 - sp1 - 1);
+        req.version = line.substr(sp2 + 1);
         
         // Разделение пути и query параметров
         auto query_pos = path_with_query.find('?');
-        if (query_pos != std::string::npos) {
-            req.path = path_with_query.substr(0, query_pos);
-            auto query = path_with_query.substr(query_pos + 1);
-            parse_query_string(query, req.query_params);
-        } else {
-            req.path = path_with_query;
+        req.path = path_with_query.substr(0, query_pos);
+        if (query_pos != std::string_view::npos) {
+            parse_query_string(path_with_query.substr(query_pos + 1), req.query_params);
         }
         
         // Парсинг заголовков
-        while (std::getline(stream, line) && line != "\r" && !line.empty()) {
+        while (next_line(line) && !line.empty()) {
             auto colon = line.find(':');
-            if (colon != std::string::npos) {
-                auto key = line.substr(0, colon);
-                auto value = line.substr(colon + 2); // Пропуск ": "
-                
-                // Удаление \r в конце
-                if (!value.empty() && value.back() == '\r') {
-                    value.pop_back();
-                }
-                
-                req.headers[key] = value;
+            if (colon != std::string_view::npos) {
+                auto value = line.substr(colon + 1);
+                value.remove_prefix(std::min(value.find_first_not_of(' '), value.size()));
+                set_value(req.headers, line.substr(0, colon), value);
             }
         }
         
-        // Чтение тела запроса
-        std::string body_line;
-        while (std::getline(stream, body_line)) {
-            req.body += body_line + "\n";
-        }
+        // Тело запроса - остаток как есть
+        req.body = data;
         
         return req;
     }
@@ -142,7 +181,7 @@ public:
 // ============================================
 
 // --- Route Handler ---
-using RouteHandler = std::function<void(const HttpRequest&, class HttpResponse&)>;
+using RouteHandler = std::function<void(const class HttpRequestEx&, class HttpResponse&)>;
 
 // --- Маршрут с параметрами ---
 struct Route {
@@ -151,17 +190,19 @@ struct Route {
     std::vector<std::string> param_names; // Имена параметров
     RouteHandler handler;      // Функция-обработчик
     
-    // Проверка соответствия запроса маршруту
-    bool matches(const std::string& method, const std::string& path, 
-                std::unordered_map<std::string, std::string>& params) const {
+    // Проверка соответствия запроса маршруту.
+    // Группы regex и параметры - в аллокаторе params (арена запроса)
+    bool matches(std::string_view method, std::string_view path, StringMap& params) const {
         if (this->method != method) return false;
         
-        std::smatch match;
-        if (!std::regex_match(path, match, path_regex)) return false;
+        using Iterator = std::string_view::const_iterator;
+        std::match_results<Iterator, std::pmr::polymorphic_allocator<std::sub_match<Iterator>>>
+            match(params.get_allocator());
+        if (!std::regex_match(path.begin(), path.end(), match, path_regex)) return false;
         
         // Извлечение параметров из пути
         for (size_t i = 0; i < param_names.size(); ++i) {
-            params[param_names[i]] = match[i + 1].str();
+            set_value(params, param_names[i], std::string_view(match[i + 1].first, match[i + 1].second));
         }
         
         return true;
@@ -227,22 +268,21 @@ public:
         route.method = "GET";
         route.path_regex = std::regex(pattern);
         route.param_names = {"filepath"};
-        route.handler = [root_dir](const HttpRequest& req, HttpResponse& res) {
+        route.handler = [root_dir](const HttpRequestEx& req, HttpResponse& res) {
             // Обработчик будет определен позже
         };
         routes.push_back(route);
     }
     
-    // Поиск подходящего маршрута
-    std::optional<std::pair<RouteHandler, std::unordered_map<std::string, std::string>>>
-    find_route(const std::string& method, const std::string& path) const {
+    // Поиск подходящего маршрута: handler не копируется (std::function может аллоцировать),
+    // параметры пишутся в params вызывающего
+    const RouteHandler* find_route(std::string_view method, std::string_view path, StringMap& params) const {
         for (const auto& route : routes) {
-            std::unordered_map<std::string, std::string> params;
             if (route.matches(method, path, params)) {
-                return std::make_pair(route.handler, params);
+                return &route.handler;
             }
         }
-        return std::nullopt;
+        return nullptr;
     }
     
     // Удобные методы регистрации
@@ -287,50 +327,65 @@ public:
 class HttpRequestEx {
 private:
     HttpRequest raw_request;
-    std::unordered_map<std::string, std::string> path_params; // :id из /users/:id
-    std::unordered_map<std::string, std::string> cookies;
+    StringMap path_params; // :id из /users/:id
+    StringMap cookies;
     std::string client_ip;
     
+    // Значение наружу - std::string: короткие (id, токены) помещаются в SSO без аллокации
+    static std::optional<std::string> lookup(const StringMap& map, std::string_view key) {
+        auto it = map.find(key);
+        return it != map.end() ? std::optional<std::string>(it->second) : std::nullopt;
+    }
+    
+    const std::pmr::string* find_header(std::string_view name) const {
+        for (const auto& [key, value] : raw_request.headers) {
+            if (key.size() == name.size() && strncasecmp(key.data(), name.data(), name.size()) == 0) {
+                return &value;
+            }
+        }
+        return nullptr;
+    }
+    
 public:
-    HttpRequestEx(const HttpRequest& req) : raw_request(req) {
+    // Запрос переезжает целиком (move): его строки остаются в той же арене
+    HttpRequestEx(HttpRequest req)
+        : raw_request(std::move(req)),
+          path_params(raw_request.get_allocator()),
+          cookies(raw_request.get_allocator()) {
         parse_cookies();
     }
     
-    const std::string& method() const { return raw_request.method; }
-    const std::string& path() const { return raw_request.path; }
-    const std::string& body() const { return raw_request.body; }
+    // Память запроса: middleware и handler'ы размещают в ней свои временные строки
+    HttpRequest::allocator_type get_allocator() const { return raw_request.get_allocator(); }
+    
+    std::string_view method() const { return raw_request.method; }
+    std::string_view path() const { return raw_request.path; }
+    std::string_view body() const { return raw_request.body; }
     
     // Получение заголовка (case-insensitive)
-    std::optional<std::string> header(const std::string& name) const {
-        for (const auto& [key, value] : raw_request.headers) {
-            if (strcasecmp(key.c_str(), name.c_str()) == 0) {
-                return value;
-            }
-        }
-        return std::nullopt;
+    std::optional<std::string> header(std::string_view name) const {
+        const std::pmr::string* value = find_header(name);
+        return value ? std::optional<std::string>(*value) : std::nullopt;
     }
     
     // Query параметр
-    std::optional<std::string> query(const std::string& key) const {
-        auto it = raw_request.query_params.find(key);
-        return it != raw_request.query_params.end() ? 
-               std::optional(it->second) : std::nullopt;
+    std::optional<std::string> query(std::string_view key) const {
+        return lookup(raw_request.query_params, key);
     }
     
     // Path параметр (/users/:id)
-    std::optional<std::string> param(const std::string& key) const {
-        auto it = path_params.find(key);
-        return it != path_params.end() ? std::optional(it->second) : std::nullopt;
+    std::optional<std::string> param(std::string_view key) const {
+        return lookup(path_params, key);
     }
     
-    void set_path_params(const std::unordered_map<std::string, std::string>& params) {
-        path_params = params;
+    // params должны быть в аллокаторе запроса - тогда move без копирования
+    void set_path_params(StringMap params) {
+        path_params = std::move(params);
     }
     
     // Cookie
-    std::optional<std::string> cookie(const std::string& name) const {
-        auto it = cookies.find(name);
-        return it != cookies.end() ? std::optional(it->second) : std::nullopt;
+    std::optional<std::string> cookie(std::string_view name) const {
+        return lookup(cookies, name);
     }
     
     const std::string& get_client_ip() const { return client_ip; }
@@ -338,38 +393,46 @@ public:
     
 private:
     void parse_cookies() {
-        auto cookie_header = header("Cookie");
+        const std::pmr::string* cookie_header = find_header("Cookie");
         if (!cookie_header) return;
         
-        std::istringstream stream(*cookie_header);
-        std::string pair;
-        
-        while (std::getline(stream, pair, ';')) {
+        std::string_view rest = *cookie_header;
+        while (!rest.empty()) {
+            auto semicolon = rest.find(';');
+            auto pair = rest.substr(0, semicolon);
+            rest = semicolon == std::string_view::npos ? std::string_view{} : rest.substr(semicolon + 1);
+            
             auto eq = pair.find('=');
-            if (eq != std::string::npos) {
-                auto key = trim(pair.substr(0, eq));
-                auto value = trim(pair.substr(eq + 1));
-                cookies[key] = value;
+            if (eq != std::string_view::npos) {
+                set_value(cookies, trim(pair.substr(0, eq)), trim(pair.substr(eq + 1)));
             }
         }
     }
     
-    static std::string trim(const std::string& str) {
+    static std::string_view trim(std::string_view str) {
         auto start = str.find_first_not_of(" \t");
         auto end = str.find_last_not_of(" \t");
-        return start == std::string::npos ? "" : str.substr(start, end - start + 1);
+        return start == std::string_view::npos ? std::string_view{} : str.substr(start, end - start + 1);
     }
 };
 
 // --- Response Object ---
+// Заголовки, тело и собранный ответ - в аллокаторе ответа (арена запроса)
 class HttpResponse {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+    
 private:
     int status_code = 200;
-    std::unordered_map<std::string, std::string> headers;
-    std::string body_content;
+    StringMap headers;
+    std::pmr::string body_content;
     bool sent = false;
     
 public:
+    explicit HttpResponse(allocator_type alloc = {}) : headers(alloc), body_content(alloc) {}
+    
+    allocator_type get_allocator() const { return body_content.get_allocator(); }
+    
     // Установка статус кода
     HttpResponse& status(int code) {
         status_code = code;
@@ -377,33 +440,33 @@ public:
     }
     
     // Установка заголовка
-    HttpResponse& set_header(const std::string& key, const std::string& value) {
-        headers[key] = value;
+    HttpResponse& set_header(std::string_view key, std::string_view value) {
+        set_value(headers, key, value);
         return *this;
     }
     
     // Отправка текста
-    HttpResponse& send(const std::string& text) {
+    HttpResponse& send(std::string_view text) {
         body_content = text;
         if (headers.find("Content-Type") == headers.end()) {
-            headers["Content-Type"] = "text/plain";
+            set_value(headers, "Content-Type", "text/plain");
         }
         sent = true;
         return *this;
     }
     
     // Отправка JSON
-    HttpResponse& json(const std::string& json_str) {
+    HttpResponse& json(std::string_view json_str) {
         body_content = json_str;
-        headers["Content-Type"] = "application/json";
+        set_value(headers, "Content-Type", "application/json");
         sent = true;
         return *this;
     }
     
     // Отправка HTML
-    HttpResponse& html(const std::string& html_content) {
+    HttpResponse& html(std::string_view html_content) {
         body_content = html_content;
-        headers["Content-Type"] = "text/html";
+        set_value(headers, "Content-Type", "text/html");
         sent = true;
         return *this;
     }
@@ -417,72 +480,86 @@ public:
         
         std::stringstream buffer;
         buffer << file.rdbuf();
-        body_content = buffer.str();
+        body_content = buffer.view();
         
-        headers["Content-Type"] = MimeTypes::get_mime_type(filepath);
+        set_value(headers, "Content-Type", MimeTypes::get_mime_type(filepath));
         sent = true;
         return *this;
     }
     
     // Редирект
-    HttpResponse& redirect(const std::string& url, int code = 302) {
+    HttpResponse& redirect(std::string_view url, int code = 302) {
         status_code = code;
-        headers["Location"] = url;
+        set_value(headers, "Location", url);
         sent = true;
         return *this;
     }
     
     // Установка cookie
-    HttpResponse& set_cookie(const std::string& name, const std::string& value,
-                            int max_age = -1, const std::string& path = "/") {
-        std::string cookie = name + "=" + value + "; Path=" + path;
+    HttpResponse& set_cookie(std::string_view name, std::string_view value,
+                            int max_age = -1, std::string_view path = "/") {
+        std::pmr::string cookie(get_allocator());
+        cookie.append(name).append("=").append(value).append("; Path=").append(path);
         if (max_age > 0) {
-            cookie += "; Max-Age=" + std::to_string(max_age);
+            cookie.append("; Max-Age=").append(std::to_string(max_age));
         }
-        headers["Set-Cookie"] = cookie;
+        set_value(headers, "Set-Cookie", cookie);
         return *this;
     }
     
-    // Генерация HTTP ответа
-    std::string build() const {
-        std::ostringstream response;
+    int get_status() const { return status_code; }
+    
+    // Генерация HTTP ответа: один буфер нужного размера вместо ostringstream
+    std::pmr::string build() const {
+        char status[16];
+        char length[24];
+        std::string_view status_str(status, std::to_chars(status, status + sizeof(status), status_code).ptr - status);
+        std::string_view length_str(length, std::to_chars(length, length + sizeof(length), body_content.size()).ptr - length);
+        std::string_view status_text = get_status_text();
+        
+        size_t size = 9 + status_str.size() + 1 + status_text.size() + 2   // Status line
+                    + 16 + length_str.size() + 4 + body_content.size();     // Content-Length + тело
+        for (const auto& [key, value] : headers) {
+            size += key.size() + value.size() + 4;
+        }
+        
+        std::pmr::string response(get_allocator());
+        response.reserve(size);
         
         // Status line
-        response << "HTTP/1.1 " << status_code << " " << get_status_text() << "\r\n";
+        response.append("HTTP/1.1 ").append(status_str).append(" ").append(status_text).append("\r\n");
         
         // Headers
         for (const auto& [key, value] : headers) {
-            response << key << ": " << value << "\r\n";
+            response.append(key).append(": ").append(value).append("\r\n");
         }
         
         // Content-Length
-        response << "Content-Length: " << body_content.size() << "\r\n";
-        response << "\r\n";
+        response.append("Content-Length: ").append(length_str).append("\r\n\r\n");
         
         // Body
-        response << body_content;
+        response.append(body_content);
         
-        return response.str();
+        return response;
     }
     
 private:
-    std::string get_status_text() const {
-        static const std::unordered_map<int, std::string> status_texts = {
-            {200, "OK"},
-            {201, "Created"},
-            {204, "No Content"},
-            {301, "Moved Permanently"},
-            {302, "Found"},
-            {304, "Not Modified"},
-            {400, "Bad Request"},
-            {401, "Unauthorized"},
-            {403, "Forbidden"},
-            {404, "Not Found"},
-            {500, "Internal Server Error"},
-        };
-        
-        auto it = status_texts.find(status_code);
-        return it != status_texts.end() ? it->second : "Unknown";
+    std::string_view get_status_text() const {
+        switch (status_code) {
+            case 200: return "OK";
+            case 201: return "Created";
+            case 204: return "No Content";
+            case 301: return "Moved Permanently";
+            case 302: return "Found";
+            case 304: return "Not Modified";
+            case 400: return "Bad Request";
+            case 401: return "Unauthorized";
+            case 403: return "Forbidden";
+            case 404: return "Not Found";
+            case 429: return "Too Many Requests";
+            case 500: return "Internal Server Error";
+            default: return "Unknown";
+        }
     }
 };
 
@@ -521,9 +598,11 @@ Middleware logging_middleware() {
     return [](HttpRequestEx& req, HttpResponse& res) -> bool {
         auto start = std::chrono::steady_clock::now();
         
+        // '\n' вместо std::endl: без flush на каждый запрос.
+        // Под нагрузкой - AsyncLogger (cpp-modern/testing_debugging.cpp)
         std::cout << "[" << current_time() << "] "
                   << req.method() << " " << req.path() 
-                  << " from " << req.get_client_ip() << std::endl;
+                  << " from " << req.get_client_ip() << '\n';
         
         // Продолжаем обработку
         return true;
@@ -670,6 +749,552 @@ std::string generate_uuid() {
     return uuid;
 }
 
+// ============================================
+// 📌 Metrics Registry (Prometheus)
+// ============================================
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+// Метрики пишутся на горячем пути (каждый запрос, каждая итерация loop'а),
+// а читаются раз в 15-60 секунд. Поэтому:
+// - запись: relaxed fetch_add в шард своего потока, без мьютексов и false sharing
+// - чтение (/metrics): суммирует шарды на лету, писателей не останавливает
+// - регистрация: редкая, под мьютексом; ссылки на метрики стабильны до конца жизни Registry
+
+namespace metrics {
+
+// Шардов - степень двойки, не меньше числа ядер. Потоки получают шард по кругу:
+// пока потоков не больше ядер, у каждого своя кэш-линия
+inline const size_t SHARD_COUNT =
+    std::bit_ceil(std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 64));
+
+inline size_t shard_index() {
+    static std::atomic<size_t> next{0};
+    thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed) & (SHARD_COUNT - 1);
+    return index;
+}
+
+// --- Counter: монотонный счётчик ---
+class Counter {
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    std::unique_ptr<Shard[]> shards_ = std::make_unique<Shard[]>(SHARD_COUNT);
+
+public:
+    void inc(uint64_t n = 1) {
+        shards_[shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < SHARD_COUNT; ++i) {
+            sum += shards_[i].value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+};
+
+// --- Gauge: текущее значение (соединения, размер кэша, байты в пуле) ---
+// Gauge часто выставляют целиком (set) - шардировать нельзя, одно атомарное значение
+class Gauge {
+    alignas(64) std::atomic<int64_t> value_{0};
+
+public:
+    void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+    void inc() { add(1); }
+    void dec() { add(-1); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+};
+
+// --- Histogram: HDR-подобная log-linear гистограмма ---
+// Значение (обычно наносекунды) → бакет за O(1): старший бит задаёт степень двойки,
+// следующие SUB_BITS бит - линейный поддиапазон внутри неё.
+// Относительная ошибка ≤ 1/8 на всём диапазоне 0 .. 2^40 нс (~18 минут);
+// всё, что больше, - в отдельный бакет переполнения без верхней границы
+class Histogram {
+public:
+    static constexpr int SUB_BITS = 3;
+    static constexpr uint64_t SUB = 1 << SUB_BITS;
+    static constexpr int MAX_EXP = 40;
+    static constexpr size_t OVERFLOW = SUB + (MAX_EXP - SUB_BITS) * SUB;   // ≥ 2^MAX_EXP
+    static constexpr size_t BUCKETS = OVERFLOW + 1;
+
+    static size_t bucket_of(uint64_t v) {
+        if (v < SUB) return v;
+        int exp = std::bit_width(v) - 1;
+        if (exp >= MAX_EXP) return OVERFLOW;
+        return SUB + (exp - SUB_BITS) * SUB + ((v >> (exp - SUB_BITS)) & (SUB - 1));
+    }
+
+    // Нижняя граница бакета (включительно)
+    static uint64_t bucket_lower(size_t i) {
+        if (i < SUB) return i;
+        int exp = int((i - SUB) / SUB) + SUB_BITS;
+        return (SUB + (i - SUB) % SUB) << (exp - SUB_BITS);
+    }
+
+    // Верхняя граница бакета (не включительно)
+    static uint64_t bucket_upper(size_t i) {
+        if (i < SUB) return i + 1;
+        int exp = int((i - SUB) / SUB) + SUB_BITS;
+        return bucket_lower(i) + (uint64_t(1) << (exp - SUB_BITS));
+    }
+
+    // Согласованная копия для отчёта (каждый бакет - отдельное чтение,
+    // поэтому снимок "плывёт" на записи, сделанные во время копирования)
+    struct Snapshot {
+        std::array<uint64_t, BUCKETS> buckets{};
+        uint64_t count = 0;
+        uint64_t sum = 0;
+
+        // Середина бакета, в который попадает квантиль q
+        uint64_t percentile(double q) const {
+            if (count == 0) return 0;
+            uint64_t rank = std::max<uint64_t>(1, uint64_t(q * count + 0.5));
+            uint64_t seen = 0;
+            size_t i = 0;
+            for (; i < OVERFLOW; ++i) {
+                seen += buckets[i];
+                if (seen >= rank) break;
+            }
+            if (i == OVERFLOW) return bucket_lower(OVERFLOW);
+            return (bucket_lower(i) + bucket_upper(i) - 1) / 2;
+        }
+
+        double mean() const { return count ? double(sum) / count : 0.0; }
+    };
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+        std::atomic<uint64_t> sum{0};
+    };
+    std::unique_ptr<Shard[]> shards_ = std::make_unique<Shard[]>(SHARD_COUNT);
+
+public:
+    void record(uint64_t value) {
+        Shard& shard = shards_[shard_index()];
+        shard.buckets[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void record(std::chrono::nanoseconds duration) {
+        record(uint64_t(std::max<int64_t>(duration.count(), 0)));
+    }
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        for (size_t shard = 0; shard < SHARD_COUNT; ++shard) {
+            for (size_t i = 0; i < BUCKETS; ++i) {
+                s.buckets[i] += shards_[shard].buckets[i].load(std::memory_order_relaxed);
+            }
+            s.sum += shards_[shard].sum.load(std::memory_order_relaxed);
+        }
+        for (uint64_t n : s.buckets) s.count += n;
+        return s;
+    }
+};
+
+// --- RAII таймер: длительность scope → Histogram (нс) ---
+class ScopedTimer {
+    Histogram& histogram_;
+    std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+
+public:
+    explicit ScopedTimer(Histogram& histogram) : histogram_(histogram) {}
+    ~ScopedTimer() { histogram_.record(std::chrono::steady_clock::now() - start_); }
+};
+
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+// --- Registry: именованные метрики + экспорт в Prometheus text format 0.0.4 ---
+class Registry {
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Series {
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+        std::function<double()> callback;   // Значение считается в момент scrape
+        double scale = 1.0;                 // Histogram: единица записи → единица экспорта
+    };
+
+    struct Family {
+        std::string help;
+        Type type;
+        std::map<std::string, Series> series;  // Ключ - отрендеренные метки {a="b"}
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family> families_;
+
+public:
+    Counter& counter(const std::string& name, const std::string& help, const Labels& labels = {}) {
+        return *with_series(name, help, Type::Counter, labels, [&](Series& s) {
+            if (!s.counter && !s.callback) s.counter = std::make_unique<Counter>();
+            if (!s.counter) throw std::logic_error("Metric " + name + " is a callback");
+            return s.counter.get();
+        });
+    }
+
+    Gauge& gauge(const std::string& name, const std::string& help, const Labels& labels = {}) {
+        return *with_series(name, help, Type::Gauge, labels, [&](Series& s) {
+            if (!s.gauge && !s.callback) s.gauge = std::make_unique<Gauge>();
+            if (!s.gauge) throw std::logic_error("Metric " + name + " is a callback");
+            return s.gauge.get();
+        });
+    }
+
+    // scale: во что переводить записанные значения при экспорте
+    // (по умолчанию нс → секунды, как принято в Prometheus: *_duration_seconds)
+    Histogram& histogram(const std::string& name, const std::string& help,
+                         const Labels& labels = {}, double scale = 1e-9) {
+        return *with_series(name, help, Type::Histogram, labels, [&](Series& s) {
+            if (!s.histogram) {
+                s.histogram = std::make_unique<Histogram>();
+                s.scale = scale;
+            }
+            return s.histogram.get();
+        });
+    }
+
+    // Метрики чужих компонентов (пулы, event loop'ы) без правки их горячего пути:
+    // функция вызывается при scrape под мьютексом реестра - должна быть быстрой
+    void gauge_callback(const std::string& name, const std::string& help,
+                        std::function<double()> fn, const Labels& labels = {}) {
+        with_series(name, help, Type::Gauge, labels, [&](Series& s) { set_callback(s, name, std::move(fn)); });
+    }
+
+    void counter_callback(const std::string& name, const std::string& help,
+                          std::function<double()> fn, const Labels& labels = {}) {
+        with_series(name, help, Type::Counter, labels, [&](Series& s) { set_callback(s, name, std::move(fn)); });
+    }
+
+    void render(std::string& out) const {
+        std::lock_guard lock(mutex_);
+        for (const auto& [name, family] : families_) {
+            static constexpr const char* type_names[] = {"counter", "gauge", "histogram"};
+            out += "# HELP " + name + " " + family.help + "\n";
+            out += "# TYPE " + name + " " + type_names[int(family.type)] + "\n";
+
+            for (const auto& [labels, s] : family.series) {
+                if (s.histogram) {
+                    render_histogram(out, name, labels, s.histogram->snapshot(), s.scale);
+                    continue;
+                }
+                out += name;
+                out += labels;
+                out += ' ';
+                if (s.callback) append_number(out, s.callback());
+                else if (s.counter) append_number(out, s.counter->value());
+                else append_number(out, s.gauge->value());
+                out += '\n';
+            }
+        }
+    }
+
+    std::string render() const {
+        std::string out;
+        render(out);
+        return out;
+    }
+
+private:
+    // Найти или создать серию и заполнить её (init) - всё под одним захватом мьютекса:
+    // render() не видит полусозданных серий, а два потока с одним именем получают
+    // один и тот же объект. Возвращается то, что вернул init (стабильный указатель)
+    template <typename Init>
+    auto with_series(const std::string& name, const std::string& help, Type type, const Labels& labels,
+                     Init&& init) -> std::invoke_result_t<Init&, Series&> {
+        std::lock_guard lock(mutex_);
+        auto [it, inserted] = families_.try_emplace(name, Family{help, type, {}});
+        if (!inserted && it->second.type != type) {
+            throw std::logic_error("Metric " + name + " registered with a different type");
+        }
+        return init(it->second.series[format_labels(labels)]);
+    }
+
+    // Вызывается из with_series - мьютекс уже взят
+    static void set_callback(Series& s, const std::string& name, std::function<double()> fn) {
+        if (s.counter || s.gauge) throw std::logic_error("Metric " + name + " is not a callback");
+        s.callback = std::move(fn);
+    }
+
+    static std::string format_labels(const Labels& labels) {
+        if (labels.empty()) return {};
+        std::string out = "{";
+        for (const auto& [key, value] : labels) {
+            if (out.size() > 1) out += ',';
+            out += key + "=\"";
+            for (char c : value) {
+                if (c == '\\' || c == '"') out += '\\';
+                if (c == '\n') { out += "\\n"; continue; }
+                out += c;
+            }
+            out += '"';
+        }
+        return out + "}";
+    }
+
+    template<typename T>
+    static void append_number(std::string& out, T value) {
+        char buf[32];
+        out.append(buf, std::to_chars(buf, buf + sizeof(buf), value).ptr);
+    }
+
+    // Бакеты Prometheus (le - накопительно, "меньше или равно") - фиксированная сетка
+    // степеней двойки 1 .. 2^MAX_EXP: они совпадают с границами внутренних бакетов
+    // (точность - 1 единица). Сетка одна и та же в каждом scrape, пустые бакеты тоже
+    // выводятся - иначе histogram_quantile() и rate() по le рвутся между scrape'ами.
+    // Переполнение (≥ 2^MAX_EXP) попадает только в +Inf
+    static void render_histogram(std::string& out, const std::string& name, const std::string& labels,
+                                 const Histogram::Snapshot& snap, double scale) {
+        std::string prefix = labels.empty() ? "{" : labels.substr(0, labels.size() - 1) + ",";
+
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < Histogram::OVERFLOW; ++i) {
+            cumulative += snap.buckets[i];
+            if (!std::has_single_bit(Histogram::bucket_upper(i))) continue;
+
+            out += name + "_bucket" + prefix + "le=\"";
+            append_number(out, double(Histogram::bucket_upper(i)) * scale);
+            out += "\"} ";
+            append_number(out, cumulative);
+            out += '\n';
+        }
+        out += name + "_bucket" + prefix + "le=\"+Inf\"} ";
+        append_number(out, snap.count);
+        out += '\n' + name + "_sum" + labels + ' ';
+        append_number(out, double(snap.sum) * scale);
+        out += '\n' + name + "_count" + labels + ' ';
+        append_number(out, snap.count);
+        out += '\n';
+    }
+};
+
+// Реестр процесса по умолчанию: HttpServer, кэши и пулы регистрируются в нём сами
+inline Registry& default_registry() {
+    static Registry registry;
+    return registry;
+}
+
+} // namespace metrics
+
+// --- Метрики сервера ---
+// Ссылки получаются один раз при создании сервера: на запрос - только атомарные инкременты
+struct HttpServerMetrics {
+    std::array<metrics::Counter*, 5> responses;   // 1xx..5xx
+    metrics::Counter& parse_errors;
+    metrics::Counter& bytes_sent;
+    metrics::Counter& connections;
+    metrics::Counter& accept_errors;
+    metrics::Gauge& connection_threads;
+    metrics::Gauge& in_flight;
+    metrics::Histogram& duration;
+
+    explicit HttpServerMetrics(metrics::Registry& registry)
+        : parse_errors(registry.counter("http_parse_errors_total", "Requests that failed to parse")),
+          bytes_sent(registry.counter("http_response_bytes_total", "Bytes sent in HTTP responses")),
+          connections(registry.counter("http_connections_accepted_total", "Accepted TCP connections")),
+          accept_errors(registry.counter("http_accept_errors_total", "Failed accept() calls")),
+          connection_threads(registry.gauge("http_connection_threads", "Live connection handler threads")),
+          in_flight(registry.gauge("http_requests_in_flight", "Requests being processed")),
+          duration(registry.histogram("http_request_duration_seconds", "Request handling latency")) {
+        for (int i = 0; i < 5; ++i) {
+            responses[i] = &registry.counter("http_responses_total", "HTTP responses by status class",
+                                             {{"code", std::to_string(i + 1) + "xx"}});
+        }
+    }
+
+    void record(int status, size_t bytes, std::chrono::steady_clock::duration elapsed) {
+        responses[std::clamp(status / 100, 1, 5) - 1]->inc();
+        bytes_sent.inc(bytes);
+        duration.record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+    }
+};
+
+// Компоненты этого файла пишут в default_registry() сами: HttpServer (accept, потоки
+// соединений, запросы), ArenaBlockPool, ResponseCache, ConnectionPool.
+// Event loop'ы и пулы из async_io.cpp - в другой единице трансляции и от metrics не
+// зависят; в приложении, где они собраны вместе, их stats() подключаются callback'ами:
+//
+//   registry.counter_callback("event_loop_events_total", "Dispatched epoll events",
+//       [&loop] { return double(loop.stats().events); });
+//   registry.gauge_callback("buffer_pool_mapped_bytes", "Bytes mapped by the buffer pool",
+//       [&pool] { return double(pool.mapped_bytes()); });
+
+// --- Бенчмарк: цена записи метрики и scrape под нагрузкой ---
+void metrics_benchmark() {
+    constexpr int ops_per_thread = 2'000'000;
+    metrics::Registry registry;
+    auto& counter = registry.counter("bench_ops_total", "Benchmark operations");
+    auto& latency = registry.histogram("bench_latency_seconds", "Benchmark latency");
+
+    // Старый подход: мьютекс на каждую запись (как MetricsCollector ниже до перехода на Registry)
+    std::mutex mutex;
+    uint64_t locked_counter = 0;
+
+    auto run = [&](const char* name, int threads, auto&& op) {
+        std::atomic<bool> scraping{true};
+        size_t scrapes = 0;
+        std::thread scraper([&] {
+            std::string out;
+            while (scraping.load(std::memory_order_relaxed)) {
+                out.clear();
+                registry.render(out);
+                ++scrapes;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&op] {
+                for (int i = 0; i < ops_per_thread; ++i) op(uint64_t(i));
+            });
+        }
+        for (auto& w : workers) w.join();
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+
+        scraping = false;
+        scraper.join();
+        std::cout << name << " x" << threads << ": "
+                  << elapsed.count() / ops_per_thread << " ns/op per thread"
+                  << " (scrapes during run: " << scrapes << ")\n";
+    };
+
+    int hw = int(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<int> thread_counts{1};
+    if (hw > 1) thread_counts.push_back(hw);
+    thread_counts.push_back(hw * 2);
+
+    for (int threads : thread_counts) {
+        run("Counter::inc     ", threads, [&](uint64_t) { counter.inc(); });
+        run("Histogram::record", threads, [&](uint64_t i) { latency.record(i & 0xFFFFF); });
+        run("mutex counter    ", threads, [&](uint64_t) {
+            std::lock_guard lock(mutex);
+            ++locked_counter;
+        });
+    }
+
+    auto snap = latency.snapshot();
+    std::cout << "recorded: " << snap.count << ", p50 " << snap.percentile(0.5)
+              << ", p99 " << snap.percentile(0.99) << ", p99.9 " << snap.percentile(0.999) << "\n";
+    std::cout << registry.render();
+}
+
+// ============================================
+// 📌 Per-request Arena
+// ============================================
+
+// Запрос живёт микросекунды, но делал десятки аллокаций: каждая строка
+// заголовка, параметр, узел unordered_map, текст ответа - отдельный malloc/free.
+// RequestArena - monotonic_buffer_resource поверх блока, переиспользуемого между запросами:
+// - allocate - сдвиг указателя в блоке, deallocate - ничего не делает
+// - конец запроса - reset() или деструктор: указатель в начало блока, O(1)
+// - блока не хватило (большой body) - следующий берётся у кучи и отдаётся при reset
+// Всё, что переживает запрос (кэш, сессии, очереди), копируется в std::string:
+// после reset указатели в арену недействительны
+
+// --- Пул блоков для арен ---
+class ArenaBlockPool {
+public:
+    // Блок возвращается в пул сам, когда арена его отпускает
+    struct Recycle {
+        ArenaBlockPool* pool;
+        void operator()(std::byte* block) const noexcept { pool->recycle(block); }
+    };
+    using Block = std::unique_ptr<std::byte[], Recycle>;
+    
+private:
+    std::mutex mutex;
+    std::vector<std::byte*> free_blocks;
+    size_t block_size;
+    size_t max_cached;
+    
+    // Общие для всех пулов серии: по ним видно, хватает ли max_cached под нагрузку
+    metrics::Counter& reused = metrics::default_registry().counter(
+        "http_arena_blocks_total", "Arena blocks handed out", {{"source", "pool"}});
+    metrics::Counter& allocated = metrics::default_registry().counter(
+        "http_arena_blocks_total", "Arena blocks handed out", {{"source", "heap"}});
+    metrics::Gauge& cached = metrics::default_registry().gauge(
+        "http_arena_blocks_cached", "Free arena blocks kept for reuse");
+    
+    void recycle(std::byte* block) noexcept {
+        {
+            std::lock_guard lock(mutex);
+            if (free_blocks.size() < max_cached) {
+                free_blocks.push_back(block);   // Ёмкость зарезервирована - не бросает
+                cached.inc();
+                return;
+            }
+        }
+        delete[] block;
+    }
+    
+public:
+    // 16 КБ: типичный запрос с заголовками и ответом помещается целиком
+    explicit ArenaBlockPool(size_t block_size = 16 * 1024, size_t max_cached = 256)
+        : block_size(block_size), max_cached(max_cached) {
+        free_blocks.reserve(max_cached);
+    }
+    
+    ~ArenaBlockPool() {
+        cached.add(-int64_t(free_blocks.size()));
+        for (std::byte* block : free_blocks) delete[] block;
+    }
+    
+    Block acquire() {
+        {
+            std::lock_guard lock(mutex);
+            if (!free_blocks.empty()) {
+                std::byte* block = free_blocks.back();
+                free_blocks.pop_back();
+                cached.dec();
+                reused.inc();
+                return Block(block, Recycle{this});
+            }
+        }
+        allocated.inc();
+        return Block(new std::byte[block_size], Recycle{this});
+    }
+    
+    size_t get_block_size() const { return block_size; }
+};
+
+inline ArenaBlockPool& default_arena_blocks() {
+    static ArenaBlockPool pool;
+    return pool;
+}
+
+// --- Арена запроса (или соединения) ---
+class RequestArena {
+private:
+    ArenaBlockPool::Block block;                 // Объявлен первым - вернётся в пул последним
+    std::pmr::monotonic_buffer_resource arena;   // Переполнение - в get_default_resource()
+    
+public:
+    explicit RequestArena(ArenaBlockPool& blocks = default_arena_blocks())
+        : block(blocks.acquire()), arena(block.get(), blocks.get_block_size()) {}
+    
+    std::pmr::memory_resource* resource() { return &arena; }
+    
+    // Конец запроса: всё выделенное разом становится свободным
+    void reset() { arena.release(); }
+};
+
 // ============================================
 // 📌 Modern Web Framework Structure
 // ============================================
@@ -681,8 +1306,13 @@ private:
     MiddlewareChain middleware_chain;
     int server_socket = -1;
     bool running = false;
+    metrics::Registry& registry;
+    HttpServerMetrics stats;
     
 public:
+    explicit HttpServer(metrics::Registry& registry = metrics::default_registry())
+        : registry(registry), stats(registry) {}
+    
     // Регистрация middleware
     void use(Middleware mw) {
         middleware_chain.use(mw);
@@ -734,64 +1364,85 @@ public:
         });
     }
     
-    // Обработка запроса
-    void handle_request(int client_socket) {
-        // Чтение данных от клиента
-        char buffer[8192];
-        ssize_t bytes_read = recv(client_socket, buffer, sizeof(buffer) - 1, 0);
-        
-        if (bytes_read <= 0) {
-            close(client_socket);
-            return;
-        }
-        
-        buffer[bytes_read] = '\0';
-        std::string request_data(buffer);
-        
+    // GET /metrics - Prometheus scrape; читает атомарные счётчики, запросы не блокирует
+    void expose_metrics(const std::string& path = "/metrics") {
+        get(path, [this](const HttpRequestEx& req, HttpResponse& res) {
+            res.set_header("Content-Type", "text/plain; version=0.0.4")
+               .send(registry.render());
+        });
+    }
+    
+    // Обработка одного запроса без сокета: parse → middleware → route → build.
+    // Запрос, параметры, заголовки и текст ответа - в arena; возвращает статус
+    int process(std::string_view request_data, std::pmr::memory_resource* arena, std::pmr::string& response) {
         // Парсинг запроса
-        auto parse_result = HttpRequest::parse(request_data);
+        auto parse_result = HttpRequest::parse(request_data, arena);
         if (!parse_result) {
-            std::string error_response = "HTTP/1.1 400 Bad Request\r\n\r\nBad Request";
-            send(client_socket, error_response.c_str(), error_response.size(), 0);
-            close(client_socket);
-            return;
+            stats.parse_errors.inc();
+            response = "HTTP/1.1 400 Bad Request\r\n\r\nBad Request";
+            return 400;
         }
         
-        HttpRequestEx req(*parse_result);
-        HttpResponse res;
+        HttpRequestEx req(std::move(*parse_result));
+        HttpResponse res(arena);
         
         // TODO: Получение IP клиента из sockaddr
         req.set_client_ip("127.0.0.1");
         
-        // Выполнение middleware
-        if (!middleware_chain.execute(req, res)) {
-            // Middleware прервал обработку, отправляем ответ
-            std::string response = res.build();
-            send(client_socket, response.c_str(), response.size(), 0);
-            close(client_socket);
-            return;
+        // Выполнение middleware (false - middleware прервал обработку, ответ уже в res)
+        if (middleware_chain.execute(req, res)) {
+            // Поиск маршрута
+            StringMap path_params(arena);
+            const RouteHandler* handler = router.find_route(req.method(), req.path(), path_params);
+            
+            if (!handler) {
+                res.status(404).send("Not Found");
+            } else {
+                req.set_path_params(std::move(path_params));
+                
+                try {
+                    (*handler)(req, res);
+                } catch (const std::exception& e) {
+                    res.status(500).send("Internal Server Error: " + std::string(e.what()));
+                }
+            }
         }
         
-        // Поиск маршрута
-        auto route_result = router.find_route(req.method(), req.path());
+        response = res.build();   // Та же арена - move без копирования
+        return res.get_status();
+    }
+    
+    // Обработка запроса
+    void handle_request(int client_socket) {
+        auto started = std::chrono::steady_clock::now();
+        stats.in_flight.inc();
         
-        if (!route_result) {
-            res.status(404).send("Not Found");
-        } else {
-            auto [handler, path_params] = *route_result;
-            req.set_path_params(path_params);
-            
-            try {
-                handler(req, res);
-            } catch (const std::exception& e) {
-                res.status(500).send("Internal Server Error: " + std::string(e.what()));
-            }
+        // Отправка ответа + учёт в метриках (единая точка выхода)
+        auto finish = [&](std::string_view response, int status) {
+            send(client_socket, response.data(), response.size(), 0);
+            close(client_socket);
+            stats.record(status, response.size(), std::chrono::steady_clock::now() - started);
+            stats.in_flight.dec();
+        };
+        
+        // Чтение данных от клиента
+        char buffer[8192];
+        ssize_t bytes_read = recv(client_socket, buffer, sizeof(buffer), 0);
+        
+        if (bytes_read <= 0) {
+            close(client_socket);
+            stats.in_flight.dec();
+            return;
         }
         
+        // Арена запроса: блок из пула, целиком возвращается в пул на выходе.
+        // С keep-alive арена живёт в соединении, а между запросами - arena.reset()
+        RequestArena arena;
+        std::pmr::string response(arena.resource());
+        int status = process(std::string_view(buffer, size_t(bytes_read)), arena.resource(), response);
+        
         // Отправка ответа
-        std::string response = res.build();
-        send(client_socket, response.c_str(), response.size(), 0);
-        close(client_socket);
+        finish(response, status);
     }
     
     // Запуск сервера
@@ -832,12 +1483,16 @@ public:
             int client_socket = accept(server_socket, (sockaddr*)&client_addr, &client_len);
             if (client_socket < 0) {
                 if (!running) break;
+                stats.accept_errors.inc();
                 continue;
             }
+            stats.connections.inc();
             
-            // В реальном приложении здесь нужен thread pool
+            // В реальном приложении здесь нужен thread pool; пока - хотя бы видно, сколько потоков живо
+            stats.connection_threads.inc();
             std::thread([this, client_socket]() {
                 handle_request(client_socket);
+                stats.connection_threads.dec();
             }).detach();
         }
     }
@@ -852,15 +1507,8 @@ public:
 };
 
 // --- Пример использования ---
-void example_http_server() {
-    HttpServer app;
-    
-    // Middleware
-    app.use(logging_middleware());
-    app.use(cors_middleware("*"));
-    app.use(rate_limit_middleware(100, std::chrono::seconds(60)));
-    
-    // Маршруты
+// Маршруты вынесены отдельно: их же гоняет arena_benchmark()
+void register_example_routes(HttpServer& app) {
     app.get("/", [](const HttpRequestEx& req, HttpResponse& res) {
         res.html("<h1>Welcome to C++ Web Server</h1>");
     });
@@ -879,10 +1527,135 @@ void example_http_server() {
     // Статические файлы
     app.static_files("/static", "./public");
     
+    // Метрики сервера (запросы, латентность, ошибки) - GET /metrics
+    app.expose_metrics();
+}
+
+void example_http_server() {
+    HttpServer app;
+    
+    // Middleware
+    app.use(logging_middleware());
+    app.use(cors_middleware("*"));
+    app.use(rate_limit_middleware(100, std::chrono::seconds(60)));
+    
+    // Маршруты
+    register_example_routes(app);
+    
     // Запуск
     app.listen(8080);
 }
 
+// --- Бенчмарк: арена против кучи на маршрутах example_http_server ---
+
+#include <cstdlib>
+#include <new>
+
+// Счётчик аллокаций потока. Включается -DCOUNT_ALLOCATIONS, т.к. подменяет глобальный
+// operator new. Заменены и sized-формы delete: их выбирает компилятор (-fsized-deallocation),
+// и без них под ASan - alloc-dealloc-mismatch. noinline - чтобы GCC не сводил new/free в одну функцию
+#ifdef COUNT_ALLOCATIONS
+inline thread_local uint64_t heap_allocations = 0;
+
+[[gnu::noinline]] void* operator new(size_t size) {
+    ++heap_allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+// new_delete_resource и aligned-типы идут сюда
+[[gnu::noinline]] void* operator new(size_t size, std::align_val_t align) {
+    ++heap_allocations;
+    size_t alignment = std::max(size_t(align), sizeof(void*));
+    if (void* p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)) return p;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, size_t) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+#endif
+
+void arena_benchmark() {
+    metrics::Registry registry;
+    HttpServer app(registry);
+    app.use(cors_middleware("*"));        // Три заголовка ответа на каждый запрос
+    app.use(compression_middleware());    // Поиск заголовка запроса + заголовок ответа
+    register_example_routes(app);
+    
+    // Три маршрута из example_http_server: статический, с параметром, POST с телом
+    const std::array<std::string_view, 3> requests = {
+        "GET / HTTP/1.1\r\nHost: localhost:8080\r\nUser-Agent: bench/1.0\r\n"
+        "Accept: text/html\r\nConnection: keep-alive\r\n\r\n",
+        
+        "GET /api/users/42?fields=name,email&expand=true HTTP/1.1\r\nHost: localhost:8080\r\n"
+        "Accept: application/json\r\nAccept-Encoding: gzip, deflate\r\n"
+        "Cookie: session_id=3f2a9c7e1b; theme=dark\r\n\r\n",
+        
+        "POST /api/users HTTP/1.1\r\nHost: localhost:8080\r\nContent-Type: application/json\r\n"
+        "Content-Length: 49\r\n\r\n{\"name\": \"John Doe\", \"email\": \"john@example.com\"}",
+    };
+    constexpr int rounds = 50'000;
+    
+    auto run = [&](const char* name, auto&& serve) {
+        std::vector<int64_t> latencies;
+        latencies.reserve(rounds * requests.size());
+        size_t bytes = 0;
+        
+#ifdef COUNT_ALLOCATIONS
+        uint64_t allocations_before = heap_allocations;
+#endif
+        for (int i = 0; i < rounds; ++i) {
+            for (std::string_view request : requests) {
+                auto start = std::chrono::steady_clock::now();
+                bytes += serve(request);
+                latencies.push_back((std::chrono::steady_clock::now() - start).count());
+            }
+        }
+        
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&](double p) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::duration(latencies[size_t(p * (latencies.size() - 1))])).count();
+        };
+        std::cout << name << ":";
+#ifdef COUNT_ALLOCATIONS
+        std::cout << " " << double(heap_allocations - allocations_before) / latencies.size() << " heap allocs/request,";
+#endif
+        std::cout << " p50 " << percentile(0.5) << " ns, p99 " << percentile(0.99) << " ns"
+                  << (bytes == 0 ? " (no output)" : "") << "\n";
+    };
+    
+    // Как было: каждая строка и узел - из кучи
+    run("heap             ", [&](std::string_view request) {
+        std::pmr::string response(std::pmr::new_delete_resource());
+        app.process(request, std::pmr::new_delete_resource(), response);
+        return response.size();
+    });
+    
+    // Арена на запрос: блок берётся из пула и возвращается в него
+    run("arena per request", [&](std::string_view request) {
+        RequestArena arena;
+        std::pmr::string response(arena.resource());
+        app.process(request, arena.resource(), response);
+        return response.size();
+    });
+    
+    // Арена соединения (keep-alive): reset() между запросами, пул не трогается
+    RequestArena connection_arena;
+    run("keep-alive arena ", [&](std::string_view request) {
+        size_t size;
+        {
+            std::pmr::string response(connection_arena.resource());
+            app.process(request, connection_arena.resource(), response);
+            size = response.size();
+        }
+        connection_arena.reset();
+        return size;
+    });
+}
+
 // ============================================
 // 📌 JSON API Server
 // ============================================
@@ -891,14 +1664,15 @@ void example_http_server() {
 class JsonApi {
 public:
     // Парсинг JSON из строки (упрощенная версия)
-    static std::unordered_map<std::string, std::string> parse_json(const std::string& json) {
+    static std::unordered_map<std::string, std::string> parse_json(std::string_view json) {
         // В реальности использовать nlohmann/json или RapidJSON
         std::unordered_map<std::string, std::string> result;
         // Простой парсинг пар "key": "value"
         std::regex pair_regex(R"("([^"]+)"\s*:\s*"([^"]*)")");
         
-        auto begin = std::sregex_iterator(json.begin(), json.end(), pair_regex);
-        auto end = std::sregex_iterator();
+        using Iterator = std::regex_iterator<std::string_view::const_iterator>;
+        auto begin = Iterator(json.begin(), json.end(), pair_regex);
+        auto end = Iterator();
         
         for (auto it = begin; it != end; ++it) {
             result[(*it)[1].str()] = (*it)[2].str();
@@ -950,7 +1724,7 @@ struct User {
                "\", \"email\": \"" + email + "\"}";
     }
     
-    static std::optional<User> from_json(const std::string& json) {
+    static std::optional<User> from_json(std::string_view json) {
         auto data = JsonApi::parse_json(json);
         
         User user;
@@ -1106,7 +1880,7 @@ public:
     
     static std::optional<std::string> parse_websocket_key(const HttpRequest& req) {
         auto it = req.headers.find("Sec-WebSocket-Key");
-        return it != req.headers.end() ? std::optional(it->second) : std::nullopt;
+        return it != req.headers.end() ? std::optional<std::string>(it->second) : std::nullopt;
     }
     
     static std::string create_handshake_response(const std::string& accept_key) {
@@ -1492,7 +2266,7 @@ public:
         }
     };
     
-    static std::vector<Part> parse(const std::string& body, const std::string& boundary) {
+    static std::vector<Part> parse(std::string_view body, const std::string& boundary) {
         std::vector<Part> parts;
         std::string delimiter = "--" + boundary;
         std::string end_delimiter = "--" + boundary + "--";
@@ -1504,7 +2278,7 @@ public:
             
             if (end == std::string::npos) break;
             
-            std::string part_content = body.substr(start, end - start);
+            std::string part_content(body.substr(start, end - start));
             
             // Разделение headers и body
             size_t header_end = part_content.find("\r\n\r\n");
@@ -1975,9 +2749,16 @@ private:
         }
     };
     
-    std::unordered_map<std::string, CachedResponse> cache;
+    std::unordered_map<std::string, CachedResponse, StringHash, StringEqual> cache;
     std::mutex mutex;
     
+    metrics::Counter& hits = metrics::default_registry().counter(
+        "http_response_cache_requests_total", "Response cache lookups", {{"result", "hit"}});
+    metrics::Counter& misses = metrics::default_registry().counter(
+        "http_response_cache_requests_total", "Response cache lookups", {{"result", "miss"}});
+    metrics::Gauge& entries = metrics::default_registry().gauge(
+        "http_response_cache_entries", "Entries in the response cache");
+    
 public:
     // Сохранение ответа в кэш
     void set(const std::string& key, const HttpResponse& response, int ttl) {
@@ -1991,20 +2772,27 @@ public:
         cached.ttl_seconds = ttl;
         
         cache[key] = cached;
+        entries.set(cache.size());
     }
     
     // Получение из кэша
-    std::optional<CachedResponse> get(const std::string& key) {
+    std::optional<CachedResponse> get(std::string_view key) {
         std::lock_guard lock(mutex);
         
         auto it = cache.find(key);
-        if (it == cache.end()) return std::nullopt;
+        if (it == cache.end()) {
+            misses.inc();
+            return std::nullopt;
+        }
         
         if (it->second.is_expired()) {
             cache.erase(it);
+            entries.set(cache.size());
+            misses.inc();
             return std::nullopt;
         }
         
+        hits.inc();
         return it->second;
     }
     
@@ -2012,6 +2800,7 @@ public:
     void clear() {
         std::lock_guard lock(mutex);
         cache.clear();
+        entries.set(0);
     }
 };
 
@@ -2021,7 +2810,9 @@ Middleware caching_middleware(std::shared_ptr<ResponseCache> cache, int ttl = 60
         // Кэшируем только GET запросы
         if (req.method() != "GET") return true;
         
-        std::string cache_key = req.method() + ":" + req.path();
+        // Временный ключ - в арене запроса
+        std::pmr::string cache_key(req.get_allocator());
+        cache_key.append(req.method()).append(":").append(req.path());
         
         // Проверка кэша
         auto cached = cache->get(cache_key);
@@ -2123,6 +2914,11 @@ private:
     std::unordered_map<int, Connection> connections;
     std::mutex mutex;
     
+    metrics::Gauge& open_connections = metrics::default_registry().gauge(
+        "http_keepalive_connections", "Keep-alive connections in the pool");
+    metrics::Counter& closed_connections = metrics::default_registry().counter(
+        "http_keepalive_closed_total", "Keep-alive connections closed as idle or exhausted");
+    
 public:
     void register_connection(int socket_fd) {
         std::lock_guard lock(mutex);
@@ -2131,6 +2927,7 @@ public:
         conn.socket_fd = socket_fd;
         conn.last_used = std::chrono::steady_clock::now();
         connections[socket_fd] = conn;
+        open_connections.set(connections.size());
     }
     
     bool should_keep_alive(int socket_fd) {
@@ -2152,10 +2949,12 @@ public:
             if (it->second.should_close()) {
                 close(it->second.socket_fd);
                 it = connections.erase(it);
+                closed_connections.inc();
             } else {
                 ++it;
             }
         }
+        open_connections.set(connections.size());
     }
 };
 
@@ -2253,46 +3052,50 @@ void add_health_check(HttpServer& app) {
 }
 
 // --- Metrics Endpoint (Prometheus format) ---
+// http_* метрики HttpServer пишет сам (см. Metrics Registry);
+// MetricsCollector - прикладные счётчики поверх того же реестра
+#include <shared_mutex>
+
 class MetricsCollector {
 private:
-    std::atomic<uint64_t> total_requests{0};
-    std::atomic<uint64_t> failed_requests{0};
-    std::unordered_map<std::string, std::atomic<uint64_t>> endpoint_requests;
-    std::mutex mutex;
+    metrics::Registry& registry;
+    metrics::Counter& total_requests;
+    metrics::Counter& failed_requests;
+    
+    // Кэш счётчиков по endpoint: поиск в Registry идёт под его мьютексом,
+    // здесь - shared_lock, писатели друг другу не мешают
+    std::unordered_map<std::string, metrics::Counter*> endpoint_requests;
+    std::shared_mutex mutex;
     
 public:
+    explicit MetricsCollector(metrics::Registry& registry = metrics::default_registry())
+        : registry(registry),
+          total_requests(registry.counter("app_requests_total", "Total application requests")),
+          failed_requests(registry.counter("app_requests_failed_total", "Failed application requests")) {}
+    
     void record_request(const std::string& endpoint, bool success) {
-        total_requests++;
-        if (!success) failed_requests++;
-        
-        std::lock_guard lock(mutex);
-        endpoint_requests[endpoint]++;
+        total_requests.inc();
+        if (!success) failed_requests.inc();
+        endpoint_counter(endpoint).inc();
     }
     
     std::string export_prometheus() {
-        std::ostringstream metrics;
-        
-        // Total requests counter
-        metrics << "# HELP http_requests_total Total HTTP requests\n";
-        metrics << "# TYPE http_requests_total counter\n";
-        metrics << "http_requests_total " << total_requests << "\n\n";
-        
-        // Failed requests
-        metrics << "# HELP http_requests_failed Total failed HTTP requests\n";
-        metrics << "# TYPE http_requests_failed counter\n";
-        metrics << "http_requests_failed " << failed_requests << "\n\n";
-        
-        // Per-endpoint requests
-        metrics << "# HELP http_requests_by_endpoint Requests by endpoint\n";
-        metrics << "# TYPE http_requests_by_endpoint counter\n";
-        
-        std::lock_guard lock(mutex);
-        for (const auto& [endpoint, count] : endpoint_requests) {
-            metrics << "http_requests_by_endpoint{endpoint=\"" << endpoint 
-                   << "\"} " << count << "\n";
+        return registry.render();
+    }
+    
+private:
+    metrics::Counter& endpoint_counter(const std::string& endpoint) {
+        {
+            std::shared_lock lock(mutex);
+            auto it = endpoint_requests.find(endpoint);
+            if (it != endpoint_requests.end()) return *it->second;
         }
         
-        return metrics.str();
+        std::unique_lock lock(mutex);
+        auto& counter = registry.counter("app_requests_by_endpoint_total", "Requests by endpoint",
+                                         {{"endpoint", endpoint}});
+        endpoint_requests[endpoint] = &counter;
+        return counter;
     }
 };
 
@@ -201,7 +201,7 @@ public:
 // ============================================
 // • Structured logging (JSON)
 // • Log aggregation
-// • Metrics (Prometheus)
+// • Metrics (Prometheus) - metrics::Registry и GET /metrics в http_server.cpp
 // • Alerts
 // • Health checks
 
@@ -396,6 +396,7 @@ void echo_server_multi_threaded() {
 }
 
 // Thread pool для обработки клиентов
+// (одна очередь под mutex - при высоком RPS см. WorkStealingExecutor в async_io.cpp)
 class ThreadPool {
     std::vector<std::thread> workers_;
     std::queue<int> tasks_;
@@ -659,6 +660,599 @@ public:
     }
 };
 
+// ============================================
+// 📌 Batched UDP: recvmmsg/sendmmsg, GSO/GRO, SO_REUSEPORT
+// ============================================
+
+// udp_server_example выше тратит по 2 syscall на КАЖДУЮ датаграмму
+// (recvfrom + sendto) и упирается в ~300k пакетов/сек на ядро.
+//
+// Что даёт прирост (в порядке убывания эффекта):
+// - recvmmsg/sendmmsg: до 64 датаграмм за один syscall
+// - UDP GRO (Linux 5.0+): ядро склеивает пакеты одного потока в один буфер
+// - UDP GSO (Linux 4.18+): один sendmsg → до 64 сегментов одинакового размера
+// - SO_REUSEPORT: N сокетов на один порт, ядро раскидывает потоки по хэшу 4-tuple
+// - буферы выделены один раз на батч, а не 64 KB на стеке на каждый вызов
+
+#include <sys/uio.h>
+#include <poll.h>
+#include <netinet/udp.h>
+#include <array>
+#include <deque>
+#include <span>
+#include <utility>
+
+// Не во всех glibc есть эти константы (они из linux/udp.h)
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+// Батч датаграмм: все массивы для recvmmsg/sendmmsg выделены заранее
+class UdpBatch {
+public:
+    static constexpr size_t MAX_MESSAGES = 64;
+
+private:
+    size_t slot_size_;
+    size_t count_ = 0;
+    std::vector<char> storage_;                        // MAX_MESSAGES слотов подряд
+    std::array<mmsghdr, MAX_MESSAGES> msgs_{};
+    std::array<iovec, MAX_MESSAGES> iovs_{};
+    std::array<sockaddr_storage, MAX_MESSAGES> addrs_{};
+    alignas(cmsghdr) char controls_[MAX_MESSAGES][64];
+
+public:
+    // С GRO один "пакет" может оказаться склейкой до 64 KB
+    explicit UdpBatch(size_t slot_size = 2048)
+        : slot_size_(slot_size), storage_(slot_size * MAX_MESSAGES) {}
+
+    size_t size() const { return count_; }
+
+    std::span<char> payload(size_t i) {
+        return {storage_.data() + i * slot_size_, msgs_[i].msg_len};
+    }
+
+    const sockaddr_storage& peer(size_t i) const { return addrs_[i]; }
+
+    // Размер сегмента, если ядро склеило несколько датаграмм (GRO), иначе 0
+    uint16_t gro_segment_size(size_t i) {
+        msghdr& hdr = msgs_[i].msg_hdr;
+        for (cmsghdr* c = CMSG_FIRSTHDR(&hdr); c; c = CMSG_NXTHDR(&hdr, c)) {
+            if (c->cmsg_level == SOL_UDP && c->cmsg_type == UDP_GRO) {
+                int segment;
+                std::memcpy(&segment, CMSG_DATA(c), sizeof(segment));
+                return uint16_t(segment);
+            }
+        }
+        return 0;
+    }
+
+    // Обход исходных датаграмм: склейки GRO режутся по размеру сегмента
+    template<typename F>
+    void for_each_datagram(F&& f) {
+        for (size_t i = 0; i < count_; ++i) {
+            std::span<char> data = payload(i);
+            size_t segment = gro_segment_size(i);
+            if (segment == 0) segment = data.size();
+
+            for (size_t off = 0; off < data.size(); off += segment) {
+                f(data.subspan(off, std::min(segment, data.size() - off)), addrs_[i]);
+            }
+        }
+    }
+
+    // Один syscall - до 64 датаграмм. MSG_WAITFORONE: ждём первую, остальные - что уже есть
+    int receive(int fd, int flags = MSG_WAITFORONE) {
+        for (size_t i = 0; i < MAX_MESSAGES; ++i) {
+            iovs_[i] = {storage_.data() + i * slot_size_, slot_size_};
+            msghdr& hdr = msgs_[i].msg_hdr;
+            hdr.msg_name = &addrs_[i];
+            hdr.msg_namelen = sizeof(sockaddr_storage);
+            hdr.msg_iov = &iovs_[i];
+            hdr.msg_iovlen = 1;
+            hdr.msg_control = controls_[i];
+            hdr.msg_controllen = sizeof(controls_[i]);
+            hdr.msg_flags = 0;
+        }
+
+        int n = recvmmsg(fd, msgs_.data(), MAX_MESSAGES, flags, nullptr);
+        count_ = n > 0 ? size_t(n) : 0;
+        return n;
+    }
+
+    // Ответить каждому отправителю его же буфером (echo) - без копирования.
+    // Сегменты, склеенные GRO, уходят обратно одним GSO-сообщением
+    int reply_all(int fd) {
+        for (size_t i = 0; i < count_; ++i) {
+            msghdr& hdr = msgs_[i].msg_hdr;
+            iovs_[i].iov_len = msgs_[i].msg_len;
+
+            uint16_t segment = gro_segment_size(i);
+            if (segment != 0 && segment < msgs_[i].msg_len) {
+                hdr.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+                cmsghdr* c = CMSG_FIRSTHDR(&hdr);
+                c->cmsg_level = SOL_UDP;
+                c->cmsg_type = UDP_SEGMENT;
+                c->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                std::memcpy(CMSG_DATA(c), &segment, sizeof(segment));
+            } else {
+                hdr.msg_control = nullptr;
+                hdr.msg_controllen = 0;
+            }
+        }
+        return send_all(fd, count_);
+    }
+
+private:
+    int send_all(int fd, size_t count) {
+        size_t sent = 0;
+        while (sent < count) {
+            int n = sendmmsg(fd, msgs_.data() + sent, unsigned(count - sent), 0);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;  // EAGAIN/ENOBUFS: UDP можно и потерять
+            }
+            sent += n;
+        }
+        return int(sent);
+    }
+};
+
+// UDP сокет для батчевого I/O
+int open_batched_udp_socket(uint16_t port, bool reuseport, bool enable_gro) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    int one = 1;
+    if (reuseport) {
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+    }
+
+    // Большой приёмный буфер сглаживает всплески, пока поток занят обработкой
+    int rcvbuf = 8 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    if (enable_gro) {
+        // На старых ядрах вернёт ENOPROTOOPT - работаем без склейки
+        setsockopt(fd, SOL_UDP, UDP_GRO, &one, sizeof(one));
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// GSO: один sendmsg, ядро (или NIC) режет буфер на датаграммы по segment байт
+ssize_t send_gso(int fd, const sockaddr_in& dest, std::span<const char> data,
+                 uint16_t segment) {
+    iovec iov{const_cast<char*>(data.data()), data.size()};
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+    msghdr hdr{};
+    hdr.msg_name = const_cast<sockaddr_in*>(&dest);
+    hdr.msg_namelen = sizeof(dest);
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = control;
+    hdr.msg_controllen = sizeof(control);
+
+    cmsghdr* c = CMSG_FIRSTHDR(&hdr);
+    c->cmsg_level = SOL_UDP;
+    c->cmsg_type = UDP_SEGMENT;
+    c->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    std::memcpy(CMSG_DATA(c), &segment, sizeof(segment));
+
+    // Не больше 64 сегментов и 64 KB за вызов
+    ssize_t n = sendmsg(fd, &hdr, 0);
+    if (n >= 0 || errno != EIO) return n;
+
+    // EIO - устройство не умеет GSO (нет checksum offload): те же сегменты
+    // отдельными датаграммами, по sendmmsg на пачку до 64
+    std::array<mmsghdr, UdpBatch::MAX_MESSAGES> msgs{};
+    std::array<iovec, UdpBatch::MAX_MESSAGES> iovs{};
+    size_t offset = 0;
+    ssize_t total = 0;
+    while (offset < data.size()) {
+        unsigned count = 0;
+        for (; count < msgs.size() && offset < data.size(); ++count) {
+            size_t len = std::min<size_t>(segment, data.size() - offset);
+            iovs[count] = {const_cast<char*>(data.data() + offset), len};
+            msgs[count].msg_hdr = {};
+            msgs[count].msg_hdr.msg_name = const_cast<sockaddr_in*>(&dest);
+            msgs[count].msg_hdr.msg_namelen = sizeof(dest);
+            msgs[count].msg_hdr.msg_iov = &iovs[count];
+            msgs[count].msg_hdr.msg_iovlen = 1;
+            offset += len;
+        }
+
+        unsigned sent = 0;
+        while (sent < count) {
+            int r = sendmmsg(fd, msgs.data() + sent, count - sent, 0);
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                return total > 0 ? total : -1;   // Часть уже ушла - сообщаем, сколько
+            }
+            for (int i = 0; i < r; ++i) total += msgs[sent + i].msg_len;
+            sent += unsigned(r);
+        }
+    }
+    return total;
+}
+
+// Батчевый echo-сервер: 2 syscall на пачку до 64 датаграмм
+void udp_batched_echo_server() {
+    int fd = open_batched_udp_socket(8080, false, true);
+    if (fd < 0) {
+        std::cerr << "socket/bind failed\n";
+        return;
+    }
+
+    UdpBatch batch(64 * 1024);  // 64 KB слот - под GRO-склейки
+
+    while (true) {
+        if (batch.receive(fd) <= 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        batch.reply_all(fd);
+    }
+    close(fd);
+}
+
+// SO_REUSEPORT fan-out: по сокету и потоку на ядро, без общего состояния.
+// Handler: void(std::span<char> datagram, const sockaddr_storage& from).
+// Каждый поток получает свою копию handler'а: состояние внутри него (счётчики, буферы)
+// не требует синхронизации. Общее состояние за пределами копии - забота вызывающего
+template<typename Handler>
+void udp_reuseport_ingest(uint16_t port, size_t threads, Handler handler) {
+    std::vector<std::thread> workers;
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());   // 0 = "неизвестно"
+
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([port, t, cores, handler]() mutable {
+            // Поток на своём ядре - пакеты потока (4-tuple) всегда приходят сюда же
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(t % cores, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+            int fd = open_batched_udp_socket(port, true, true);
+            if (fd < 0) return;
+
+            UdpBatch batch(64 * 1024);
+            while (batch.receive(fd) >= 0 || errno == EINTR) {
+                batch.for_each_datagram(handler);
+            }
+            close(fd);
+        });
+    }
+
+    for (auto& w : workers) w.join();
+}
+
+// Неблокирующий ARQ с окном: много датаграмм "в полёте" одновременно
+// (ReliableUdpSender выше ждёт ACK на каждую датаграмму до секунды)
+//
+// Формат: [seq: 4 байта BE][payload], ACK: [seq: 4 байта BE] (selective ACK)
+// Встраивается в event loop: fd(), on_readable(), on_timer(), next_timeout_ms()
+class WindowedUdpSender {
+    using Clock = std::chrono::steady_clock;
+
+    struct InFlight {
+        uint32_t seq;
+        std::vector<char> packet;   // Уже с заголовком
+        Clock::time_point sent_at;
+        Clock::time_point deadline;
+        int retries = 0;
+        bool acked = false;
+    };
+
+    int fd_ = -1;
+    size_t window_size_;
+    int max_retries_;
+    uint32_t next_seq_ = 0;
+    std::deque<InFlight> in_flight_;             // По возрастанию seq
+    std::deque<std::vector<char>> pending_;      // Ещё не отправленные
+    bool failed_ = false;
+
+    // RTO по RFC 6298 (упрощённо)
+    std::chrono::microseconds srtt_{0};
+    std::chrono::microseconds rttvar_{0};
+    std::chrono::microseconds rto_{200'000};
+
+public:
+    // dest - адрес получателя; сокет connect()-им, чтобы не передавать адрес в каждый вызов.
+    // Не удалось создать или connect()-ить сокет - std::system_error с errno
+    WindowedUdpSender(const sockaddr_in& dest, size_t window_size = 256, int max_retries = 8)
+        : window_size_(window_size), max_retries_(max_retries) {
+        fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::system_category(), "WindowedUdpSender: socket");
+        }
+        if (connect(fd_, (const sockaddr*)&dest, sizeof(dest)) < 0) {
+            int error = errno;
+            close(fd_);
+            throw std::system_error(error, std::system_category(), "WindowedUdpSender: connect");
+        }
+    }
+
+    ~WindowedUdpSender() {
+        if (fd_ >= 0) close(fd_);
+    }
+
+    // Владеет сокетом: копировать нельзя, перемещать можно
+    WindowedUdpSender(const WindowedUdpSender&) = delete;
+    WindowedUdpSender& operator=(const WindowedUdpSender&) = delete;
+
+    WindowedUdpSender(WindowedUdpSender&& other) noexcept
+        : fd_(std::exchange(other.fd_, -1)), window_size_(other.window_size_), max_retries_(other.max_retries_),
+          next_seq_(other.next_seq_), in_flight_(std::move(other.in_flight_)), pending_(std::move(other.pending_)),
+          failed_(other.failed_), srtt_(other.srtt_), rttvar_(other.rttvar_), rto_(other.rto_) {}
+
+    WindowedUdpSender& operator=(WindowedUdpSender&& other) noexcept {
+        if (this != &other) {
+            if (fd_ >= 0) close(fd_);
+            fd_ = std::exchange(other.fd_, -1);
+            window_size_ = other.window_size_;
+            max_retries_ = other.max_retries_;
+            next_seq_ = other.next_seq_;
+            in_flight_ = std::move(other.in_flight_);
+            pending_ = std::move(other.pending_);
+            failed_ = other.failed_;
+            srtt_ = other.srtt_;
+            rttvar_ = other.rttvar_;
+            rto_ = other.rto_;
+        }
+        return *this;
+    }
+
+    int fd() const { return fd_; }
+    bool done() const { return in_flight_.empty() && pending_.empty(); }
+    bool failed() const { return failed_; }
+
+    void enqueue(std::span<const char> payload) {
+        std::vector<char> packet(4 + payload.size());
+        uint32_t seq_be = htonl(next_seq_++);
+        std::memcpy(packet.data(), &seq_be, 4);
+        std::memcpy(packet.data() + 4, payload.data(), payload.size());
+        pending_.push_back(std::move(packet));
+    }
+
+    // Заполняем окно новыми пакетами: один sendmmsg на всё, что влезло
+    void pump() {
+        std::array<mmsghdr, UdpBatch::MAX_MESSAGES> msgs{};
+        std::array<iovec, UdpBatch::MAX_MESSAGES> iovs{};
+
+        while (!pending_.empty() && in_flight_.size() < window_size_) {
+            size_t batch = std::min({pending_.size(), window_size_ - in_flight_.size(),
+                                     UdpBatch::MAX_MESSAGES});
+            auto now = Clock::now();
+
+            for (size_t i = 0; i < batch; ++i) {
+                std::vector<char>& packet = pending_[i];
+                uint32_t seq_be;
+                std::memcpy(&seq_be, packet.data(), 4);
+                in_flight_.push_back({ntohl(seq_be), std::move(packet), now, now + rto_});
+
+                iovs[i] = {in_flight_.back().packet.data(), in_flight_.back().packet.size()};
+                msgs[i].msg_hdr.msg_iov = &iovs[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+            pending_.erase(pending_.begin(), pending_.begin() + batch);
+
+            // Частичная отправка не страшна: остальное дошлёт таймер
+            sendmmsg(fd_, msgs.data(), unsigned(batch), 0);
+        }
+    }
+
+    // Пришли ACK'и: забираем все разом
+    void on_readable() {
+        std::array<uint32_t, UdpBatch::MAX_MESSAGES> acks{};
+        std::array<mmsghdr, UdpBatch::MAX_MESSAGES> msgs{};
+        std::array<iovec, UdpBatch::MAX_MESSAGES> iovs{};
+
+        for (size_t i = 0; i < acks.size(); ++i) {
+            iovs[i] = {&acks[i], sizeof(uint32_t)};
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int n;
+        while ((n = recvmmsg(fd_, msgs.data(), unsigned(msgs.size()), MSG_DONTWAIT, nullptr)) > 0) {
+            auto now = Clock::now();
+            for (int i = 0; i < n; ++i) {
+                if (msgs[i].msg_len == sizeof(uint32_t)) mark_acked(ntohl(acks[i]), now);
+            }
+        }
+
+        // Сдвигаем окно: подтверждённый префикс больше не нужен
+        while (!in_flight_.empty() && in_flight_.front().acked) {
+            in_flight_.pop_front();
+        }
+        pump();
+    }
+
+    // Перепосылка просроченных (экспоненциальный backoff на каждый пакет)
+    void on_timer() {
+        auto now = Clock::now();
+        for (InFlight& f : in_flight_) {
+            if (f.acked || f.deadline > now) continue;
+
+            if (++f.retries > max_retries_) {
+                failed_ = true;
+                return;
+            }
+            send(fd_, f.packet.data(), f.packet.size(), 0);
+            f.sent_at = now;
+            f.deadline = now + rto_ * (1 << std::min(f.retries, 6));
+        }
+    }
+
+    int next_timeout_ms() const {
+        auto earliest = Clock::time_point::max();
+        for (const InFlight& f : in_flight_) {
+            if (!f.acked) earliest = std::min(earliest, f.deadline);
+        }
+        if (earliest == Clock::time_point::max()) return -1;
+
+        auto wait = std::chrono::ceil<std::chrono::milliseconds>(earliest - Clock::now());
+        return int(std::max<int64_t>(0, wait.count()));
+    }
+
+    // Самостоятельный режим (без внешнего event loop'а)
+    bool run(std::chrono::milliseconds limit) {
+        auto stop_at = Clock::now() + limit;
+        pump();
+
+        while (!done() && !failed_ && Clock::now() < stop_at) {
+            pollfd pfd{fd_, POLLIN, 0};
+            int timeout = next_timeout_ms();
+            if (poll(&pfd, 1, timeout < 0 ? 100 : timeout) > 0) on_readable();
+            on_timer();
+        }
+        return done();
+    }
+
+private:
+    void mark_acked(uint32_t seq, Clock::time_point now) {
+        if (in_flight_.empty()) return;
+
+        uint32_t base = in_flight_.front().seq;
+        uint32_t offset = seq - base;  // Беззнаковая арифметика переживает переполнение seq
+        if (offset >= in_flight_.size()) return;  // Дубликат или мусор
+
+        InFlight& f = in_flight_[offset];
+        if (f.acked) return;
+        f.acked = true;
+
+        // Алгоритм Карна: RTT меряем только по пакетам без перепосылок
+        if (f.retries == 0) update_rto(std::chrono::duration_cast<std::chrono::microseconds>(now - f.sent_at));
+    }
+
+    void update_rto(std::chrono::microseconds rtt) {
+        if (srtt_.count() == 0) {
+            srtt_ = rtt;
+            rttvar_ = rtt / 2;
+        } else {
+            auto delta = srtt_ > rtt ? srtt_ - rtt : rtt - srtt_;
+            rttvar_ = (rttvar_ * 3 + delta) / 4;
+            srtt_ = (srtt_ * 7 + rtt) / 8;
+        }
+        rto_ = std::clamp(srtt_ + rttvar_ * 4,
+                          std::chrono::microseconds(1'000), std::chrono::microseconds(2'000'000));
+    }
+};
+
+// Получатель для WindowedUdpSender: батч датаграмм → батч ACK'ов
+void windowed_udp_receiver(uint16_t port) {
+    int fd = open_batched_udp_socket(port, false, false);
+    UdpBatch batch;
+
+    while (batch.receive(fd) > 0) {
+        std::array<uint32_t, UdpBatch::MAX_MESSAGES> acks{};
+        std::array<mmsghdr, UdpBatch::MAX_MESSAGES> msgs{};
+        std::array<iovec, UdpBatch::MAX_MESSAGES> iovs{};
+        std::array<sockaddr_storage, UdpBatch::MAX_MESSAGES> peers{};
+        size_t n = 0;
+
+        for (size_t i = 0; i < batch.size(); ++i) {
+            auto data = batch.payload(i);
+            if (data.size() < 4) continue;
+
+            // ... обработка data.subspan(4) ...
+            std::memcpy(&acks[n], data.data(), 4);  // seq уже в network order
+            peers[n] = batch.peer(i);
+            iovs[n] = {&acks[n], sizeof(uint32_t)};
+            msgs[n].msg_hdr.msg_name = &peers[n];
+            msgs[n].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            msgs[n].msg_hdr.msg_iov = &iovs[n];
+            msgs[n].msg_hdr.msg_iovlen = 1;
+            ++n;
+        }
+        sendmmsg(fd, msgs.data(), unsigned(n), 0);
+    }
+    close(fd);
+}
+
+// Бенчмарк: стоимость приёма на одном ядре (recvfrom vs recvmmsg).
+// Пачка отправляется заранее и не входит в замер - меряется только сторона приёма
+void udp_batching_benchmark() {
+    constexpr size_t packet_size = 64;   // Типичная телеметрия
+    constexpr size_t burst = 256;        // Влезает в приёмный буфер сокета
+    constexpr size_t rounds = 4000;
+
+    auto run = [&](const char* name, auto&& drain) {
+        int rx = open_batched_udp_socket(0, false, false);
+        sockaddr_in addr{};
+        socklen_t len = sizeof(addr);
+        getsockname(rx, (sockaddr*)&addr, &len);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        int tx = socket(AF_INET, SOCK_DGRAM, 0);
+        connect(tx, (sockaddr*)&addr, sizeof(addr));
+
+        std::array<char, packet_size> payload{};
+        std::array<mmsghdr, UdpBatch::MAX_MESSAGES> msgs{};
+        iovec iov{payload.data(), payload.size()};
+        for (auto& m : msgs) {
+            m.msg_hdr.msg_iov = &iov;
+            m.msg_hdr.msg_iovlen = 1;
+        }
+
+        size_t received = 0;
+        std::chrono::nanoseconds receive_time{0};
+
+        for (size_t r = 0; r < rounds; ++r) {
+            for (size_t sent = 0; sent < burst; sent += msgs.size()) {
+                sendmmsg(tx, msgs.data(), unsigned(msgs.size()), 0);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            received += drain(rx);
+            receive_time += std::chrono::steady_clock::now() - start;
+        }
+
+        close(tx);
+        close(rx);
+
+        double seconds = std::chrono::duration<double>(receive_time).count();
+        std::cout << name << ": " << size_t(received / seconds) << " packets/sec, "
+                  << receive_time.count() / double(received) << " ns/packet\n";
+    };
+
+    run("recvfrom", [](int fd) {
+        char buffer[65536];
+        size_t count = 0;
+        while (recvfrom(fd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr) > 0) {
+            ++count;
+        }
+        return count;
+    });
+
+    UdpBatch batch(packet_size);
+    run("recvmmsg", [&batch](int fd) {
+        size_t count = 0;
+        int n;
+        while ((n = batch.receive(fd, MSG_DONTWAIT)) > 0) {
+            count += n;
+        }
+        return count;
+    });
+}
+
 // ============================================
 // 📌 Socket Operations
 // ============================================
@@ -1170,6 +1764,7 @@ Socket create_dual_stack_server(uint16_t port) {
 // ============================================
 
 // Сериализация примитивов с учётом endianness
+// (для структур целиком - codec::encode<std::endian::big> в serialization.cpp)
 class BinarySerializer {
     std::vector<uint8_t> buffer_;
     
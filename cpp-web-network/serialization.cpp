@@ -35,6 +35,8 @@ public:
     JSON(const Array& a) : value_(a) {}
     JSON(const Object& o) : value_(o) {}
     
+    const Value& value() const { return value_; }
+    
     // Доступ к объектам
     JSON& operator[](const std::string& key) {
         if (!std::holds_alternative<Object>(value_)) {
@@ -386,235 +388,2391 @@ void json_parsing_example() {
 }
 
 // ============================================
-// 📌 Popular Libraries - nlohmann/json
+// 📌 SIMD On-Demand JSON Parser
 // ============================================
 
-// #include <nlohmann/json.hpp>
-// using json = nlohmann::json;
+// Почему JSONParser выше медленный:
+// - посимвольный цикл с std::isspace/std::isdigit (locale-aware, не векторизуется)
+// - строки собираются через += по одному символу
+// - числа: копия в std::string + std::stod/std::stoll
+// - всегда строится полный DOM (unordered_map/vector) - даже если нужно 2 поля
+//
+// Двухстадийный подход (как в simdjson):
+// Stage 1: SIMD проходит по 64 байтам за итерацию и строит битовые маски
+//          кавычек, '\', структурных символов и пробелов. Из масок получаем
+//          индекс позиций всех структурных символов ВНЕ строк.
+// Stage 2: on-demand курсор ходит по индексу и разбирает только то, что
+//          запросил вызывающий; ненужные поддеревья перепрыгиваются по индексу.
 
-// Automatic serialization с nlohmann/json
-struct User {
-    std::string name;
-    int age;
-    std::vector<std::string> hobbies;
-    
-    // NLOHMANN_DEFINE_TYPE_INTRUSIVE(User, name, age, hobbies)
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <string_view>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ondemand {
+
+// Маски одного 64-байтного блока (бит i = байт i)
+struct BlockMasks {
+    uint64_t quote = 0;
+    uint64_t backslash = 0;
+    uint64_t op = 0;          // { } [ ] : ,
+    uint64_t whitespace = 0;
 };
 
-void nlohmann_json_example() {
-    // User user{"Alice", 25, {"reading", "coding"}};
-    
-    // // Сериализация
-    // json j = user;
-    // std::string serialized = j.dump(2);  // Pretty print с indent 2
-    
-    // // Десериализация
-    // User user2 = j.get<User>();
-    
-    // // JSON Pointers
-    // j["/address/city"_json_pointer] = "New York";
-    
-    std::cout << "nlohmann/json: высокоуровневая C++ библиотека\n";
-}
+#if defined(__SSE2__)
+inline BlockMasks classify_block(const char* p) {
+    BlockMasks m;
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    // '{'/'[' и '}'/']' отличаются только битом 0x20: одно сравнение на пару
+    const __m128i bit20 = _mm_set1_epi8(0x20);
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
 
-// ============================================
-// 📌 Protocol Buffers
-// ============================================
+    for (int i = 0; i < 4; ++i) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 16));
+        __m128i folded = _mm_or_si128(v, bit20);
 
-// Proto Definition (.proto файл):
-//
-// syntax = "proto3";
-//
-// message Person {
-//   string name = 1;
-//   int32 id = 2;
-//   string email = 3;
-//   
-//   enum PhoneType {
-//     MOBILE = 0;
-//     HOME = 1;
-//     WORK = 2;
-//   }
-//   
-//   message PhoneNumber {
-//     string number = 1;
-//     PhoneType type = 2;
-//   }
-//   
-//   repeated PhoneNumber phones = 4;
-//   
-//   google.protobuf.Timestamp last_updated = 5;
-// }
-//
-// message AddressBook {
-//   repeated Person people = 1;
-// }
+        __m128i ops = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)));
+        __m128i ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
 
-void protobuf_example() {
-    // После компиляции .proto -> person.pb.h / person.pb.cc
-    
-    // Person person;
-    // person.set_name("John Doe");
-    // person.set_id(1234);
-    // person.set_email("john@example.com");
-    
-    // // Добавление телефона
-    // Person::PhoneNumber* phone = person.add_phones();
-    // phone->set_number("+1-555-0100");
-    // phone->set_type(Person::MOBILE);
-    
-    // // Сериализация в бинарный формат
-    // std::string serialized;
-    // person.SerializeToString(&serialized);
-    
-    // // Десериализация
-    // Person person2;
-    // person2.ParseFromString(serialized);
-    
-    // std::cout << "Name: " << person2.name() << '\n';
-    // std::cout << "Phones: " << person2.phones_size() << '\n';
-    
-    std::cout << "Protocol Buffers: компактный бинарный формат от Google\n";
+        int shift = i * 16;
+        m.quote |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)))) << shift;
+        m.backslash |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, backslash)))) << shift;
+        m.op |= uint64_t(uint16_t(_mm_movemask_epi8(ops))) << shift;
+        m.whitespace |= uint64_t(uint16_t(_mm_movemask_epi8(ws))) << shift;
+    }
+    return m;
 }
+#else
+// Переносимый вариант (ARM без NEON-кода, другие платформы)
+inline BlockMasks classify_block(const char* p) {
+    BlockMasks m;
+    for (int i = 0; i < 64; ++i) {
+        uint64_t bit = uint64_t(1) << i;
+        switch (p[i]) {
+            case '"': m.quote |= bit; break;
+            case '\\': m.backslash |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',': m.op |= bit; break;
+            case ' ': case '\t': case '\n': case '\r': m.whitespace |= bit; break;
+            default: break;
+        }
+    }
+    return m;
+}
+#endif
 
-// Varint encoding в Protobuf
-// Пример: число 300 кодируется как [0xAC, 0x02]
-// - Первый байт: 10101100 (младшие 7 бит: 0101100, MSB=1 продолжение)
-// - Второй байт: 00000010 (младшие 7 бит: 0000010, MSB=0 конец)
-// - Результат: 0000010 0101100 = 300
-
-// Wire types в Protobuf:
-// 0: Varint (int32, int64, bool, enum)
-// 1: 64-bit (fixed64, double)
-// 2: Length-delimited (string, bytes, embedded messages, repeated)
-// 5: 32-bit (fixed32, float)
+// Префиксный XOR: бит i = XOR битов 0..i. Кавычки → маска "внутри строки".
+// (simdjson делает это одной инструкцией PCLMULQDQ; 6 сдвигов почти так же быстры)
+inline uint64_t prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
 
-// ============================================
-// 📌 MessagePack
-// ============================================
+// Stage 1: индекс структурных позиций
+class StructuralIndexer {
+    // Состояние между блоками
+    uint64_t prev_escaped_ = 0;     // Первый байт следующего блока экранирован
+    uint64_t prev_in_string_ = 0;   // Все единицы, если блок начинается внутри строки
+    uint64_t prev_scalar_ = 0;      // Последний байт блока - часть скаляра
 
-#include <cstdint>
+    // Какие символы экранированы нечётной цепочкой '\' (алгоритм simdjson)
+    uint64_t find_escaped(uint64_t backslash) {
+        backslash &= ~prev_escaped_;
+        uint64_t follows_escape = (backslash << 1) | prev_escaped_;
+        const uint64_t even_bits = 0x5555555555555555ULL;
+        uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+        uint64_t sequences_starting_on_even_bits;
+        prev_escaped_ = __builtin_add_overflow(odd_sequence_starts, backslash,
+                                               &sequences_starting_on_even_bits);
+        uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+        return (even_bits ^ invert_mask) & follows_escape;
+    }
 
-// MessagePack - бинарная альтернатива JSON
-class MessagePack {
 public:
-    // Сериализация целого числа
-    static std::vector<uint8_t> pack_int(int64_t value) {
-        std::vector<uint8_t> result;
-        
-        if (value >= 0 && value <= 127) {
-            // positive fixint
-            result.push_back(static_cast<uint8_t>(value));
-        }
-        else if (value >= -32 && value < 0) {
-            // negative fixint
-            result.push_back(static_cast<uint8_t>(value));
-        }
-        else if (value >= 0 && value <= UINT8_MAX) {
-            result.push_back(0xcc);  // uint 8
-            result.push_back(static_cast<uint8_t>(value));
-        }
-        else if (value >= INT8_MIN && value <= INT8_MAX) {
-            result.push_back(0xd0);  // int 8
-            result.push_back(static_cast<uint8_t>(value));
+    // Возвращает false, если строка не закрыта
+    bool index(std::string_view json, std::vector<uint32_t>& out) {
+        out.clear();
+        out.reserve(json.size() / 4);
+        prev_escaped_ = prev_in_string_ = prev_scalar_ = 0;
+
+        alignas(64) char tail[64];
+        for (size_t offset = 0; offset < json.size(); offset += 64) {
+            const char* block = json.data() + offset;
+            size_t len = std::min<size_t>(64, json.size() - offset);
+            if (len < 64) {
+                // Последний неполный блок дополняем пробелами
+                std::memset(tail, ' ', sizeof(tail));
+                std::memcpy(tail, block, len);
+                block = tail;
+            }
+
+            BlockMasks m = classify_block(block);
+
+            uint64_t escaped = find_escaped(m.backslash);
+            uint64_t quotes = m.quote & ~escaped;
+
+            // Внутри строки: от открывающей кавычки (включительно) до закрывающей (исключая)
+            uint64_t in_string = prefix_xor(quotes) ^ prev_in_string_;
+            prev_in_string_ = uint64_t(int64_t(in_string) >> 63);
+
+            uint64_t op = m.op & ~in_string;
+            uint64_t ws = m.whitespace & ~in_string;
+
+            // Начала скаляров (числа, true/false/null): не пробел, не оператор, не строка,
+            // и перед ними пробел/оператор
+            uint64_t scalar = ~(op | ws | quotes | in_string);
+            uint64_t scalar_starts = scalar & ~((scalar << 1) | prev_scalar_);
+            prev_scalar_ = scalar >> 63;
+
+            uint64_t structurals = op | (quotes & in_string) | scalar_starts;
+            if (len < 64) structurals &= (uint64_t(1) << len) - 1;
+
+            // Выгрузка индексов установленных битов
+            while (structurals) {
+                out.push_back(uint32_t(offset + std::countr_zero(structurals)));
+                structurals &= structurals - 1;
+            }
         }
-        // ... другие размеры (16, 32, 64 bit)
-        
-        return result;
+
+        return prev_in_string_ == 0;
     }
-    
-    // Сериализация строки
-    static std::vector<uint8_t> pack_string(const std::string& str) {
-        std::vector<uint8_t> result;
-        
-        if (str.size() <= 31) {
-            // fixstr
-            result.push_back(0xa0 | static_cast<uint8_t>(str.size()));
-        }
-        else if (str.size() <= UINT8_MAX) {
-            // str 8
-            result.push_back(0xd9);
-            result.push_back(static_cast<uint8_t>(str.size()));
-        }
-        else if (str.size() <= UINT16_MAX) {
-            // str 16
-            result.push_back(0xda);
-            result.push_back(static_cast<uint8_t>(str.size() >> 8));
-            result.push_back(static_cast<uint8_t>(str.size() & 0xFF));
+};
+
+class Document;
+
+enum class Type { Object, Array, String, Number, Bool, Null, Invalid };
+
+// Лёгкий handle на значение: документ + позиция в структурном индексе
+class Value {
+    const Document* doc_ = nullptr;
+    uint32_t pos_ = 0;
+
+public:
+    Value() = default;
+    Value(const Document* doc, uint32_t pos) : doc_(doc), pos_(pos) {}
+
+    explicit operator bool() const { return doc_ != nullptr; }
+    inline Type type() const;
+
+    // Поле объекта: линейный проход по ключам, вложенные значения перепрыгиваются
+    inline Value operator[](std::string_view key) const;
+    inline Value at(size_t index) const;
+
+    // Итерация массива без материализации
+    template<typename F> void for_each(F&& f) const;
+
+    inline std::optional<int64_t> get_int64() const;
+    inline std::optional<double> get_double() const;
+    inline std::optional<bool> get_bool() const;
+    inline bool is_null() const;
+
+    // Строка как есть (без обработки escape) - zero-copy
+    inline std::optional<std::string_view> get_raw_string() const;
+    // Строка с обработкой escape (\n, \uXXXX...) в буфер вызывающего
+    inline bool get_string(std::string& out) const;
+};
+
+class Document {
+    std::string_view json_;
+    std::vector<uint32_t> index_;
+    StructuralIndexer indexer_;
+
+    friend class Value;
+
+public:
+    // Парсер переиспользует буфер индекса между документами - без аллокаций в steady state
+    bool parse(std::string_view json) {
+        json_ = json;
+        if (!indexer_.index(json, index_) || index_.empty()) {
+            index_.clear();
+            return false;
         }
-        
-        result.insert(result.end(), str.begin(), str.end());
-        return result;
+        // Сторож: перепрыгивание за конец всегда упирается в него
+        index_.push_back(uint32_t(json.size()));
+        return true;
     }
-    
-    // Сериализация массива
-    static std::vector<uint8_t> pack_array_header(size_t size) {
-        std::vector<uint8_t> result;
-        
-        if (size <= 15) {
-            // fixarray
-            result.push_back(0x90 | static_cast<uint8_t>(size));
+
+    Value root() const { return index_.empty() ? Value{} : Value{this, 0}; }
+
+private:
+    // '\0' - сторож: конец документа (и всё, что за ним) на битом вводе вроде {"a"}
+    char at(uint32_t pos) const {
+        if (pos >= index_.size()) return '\0';
+        uint32_t offset = index_[pos];
+        return offset < json_.size() ? json_[offset] : '\0';
+    }
+
+    // Позиция значения, следующего за текущим; дальше сторожа не уходит
+    uint32_t skip(uint32_t pos) const {
+        char c = at(pos);
+        if (c == '\0') return pos;
+        if (c != '{' && c != '[') return pos + 1;
+
+        int depth = 0;
+        do {
+            c = at(pos++);
+            if (c == '{' || c == '[') ++depth;
+            else if (c == '}' || c == ']') --depth;
+            else if (c == '\0') return pos - 1;
+        } while (depth > 0);
+        return pos;
+    }
+
+    // Текст скаляра: от его начала до следующего структурного символа
+    std::string_view scalar_text(uint32_t pos) const {
+        uint32_t begin = index_[pos];
+        uint32_t end = index_[pos + 1];
+        std::string_view text = json_.substr(begin, end - begin);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\n' ||
+                                 text.back() == '\r' || text.back() == '\t')) {
+            text.remove_suffix(1);
         }
-        else if (size <= UINT16_MAX) {
-            // array 16
-            result.push_back(0xdc);
-            result.push_back(static_cast<uint8_t>(size >> 8));
-            result.push_back(static_cast<uint8_t>(size & 0xFF));
+        return text;
+    }
+
+    // Содержимое строки между кавычками (закрывающая кавычка - не структурный символ,
+    // ищем её с учётом экранирования)
+    std::string_view raw_string(uint32_t pos) const {
+        size_t begin = index_[pos] + 1;
+        size_t i = begin;
+        while (i < json_.size()) {
+            size_t q = json_.find('"', i);
+            if (q == std::string_view::npos) break;
+
+            size_t slashes = 0;
+            while (q - slashes > begin && json_[q - slashes - 1] == '\\') ++slashes;
+            if (slashes % 2 == 0) return json_.substr(begin, q - begin);
+            i = q + 1;
         }
-        
-        return result;
+        return {};
     }
 };
 
-void messagepack_example() {
-    // Пример: ["hello", 42, true]
-    std::vector<uint8_t> packed;
-    
-    // Заголовок массива (3 элемента)
-    auto header = MessagePack::pack_array_header(3);
-    packed.insert(packed.end(), header.begin(), header.end());
-    
-    // Строка "hello"
-    auto str = MessagePack::pack_string("hello");
-    packed.insert(packed.end(), str.begin(), str.end());
-    
-    // Число 42
-    auto num = MessagePack::pack_int(42);
-    packed.insert(packed.end(), num.begin(), num.end());
-    
-    // Bool true
-    packed.push_back(0xc3);
-    
-    std::cout << "MessagePack размер: " << packed.size() << " bytes\n";
-    
-    // MessagePack более компактен чем JSON:
-    // JSON: ["hello", 42, true] = 20 bytes
-    // MessagePack: [0x93, 0xa5, 'h','e','l','l','o', 0x2a, 0xc3] = 9 bytes
+inline Type Value::type() const {
+    switch (doc_->at(pos_)) {
+        case '{': return Type::Object;
+        case '[': return Type::Array;
+        case '"': return Type::String;
+        case 't': case 'f': return Type::Bool;
+        case 'n': return Type::Null;
+        case '-': case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9': return Type::Number;
+        default: return Type::Invalid;
+    }
 }
 
-// ============================================
-// 📌 Binary Serialization (custom)
-// ============================================
+inline Value Value::operator[](std::string_view key) const {
+    if (!doc_ || doc_->at(pos_) != '{') return {};
 
-#include <cstring>
+    uint32_t pos = pos_ + 1;
+    while (doc_->at(pos) == '"') {
+        // pos - ключ, pos+1 - ':', pos+2 - значение. Нет ':' (или упёрлись в сторож) -
+        // документ битый: пустой Value, как и для отсутствующего ключа
+        if (doc_->at(pos + 1) != ':') return {};
+        if (doc_->raw_string(pos) == key) return Value{doc_, pos + 2};
 
-class BinarySerializer {
-    std::vector<uint8_t> buffer_;
-    
-public:
-    // Запись с учётом endianness (little-endian)
-    void write_uint32(uint32_t value) {
-        buffer_.push_back(static_cast<uint8_t>(value & 0xFF));
-        buffer_.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
-        buffer_.push_back(static_cast<uint8_t>((value >> 16) & 0xFF));
-        buffer_.push_back(static_cast<uint8_t>((value >> 24) & 0xFF));
+        pos = doc_->skip(pos + 2);
+        if (doc_->at(pos) != ',') break;
+        ++pos;
     }
-    
-    void write_string(const std::string& str) {
-        write_uint32(static_cast<uint32_t>(str.size()));
-        buffer_.insert(buffer_.end(), str.begin(), str.end());
+    return {};
+}
+
+inline Value Value::at(size_t index) const {
+    Value found;
+    size_t i = 0;
+    for_each([&](Value v) {
+        if (i++ == index) found = v;
+    });
+    return found;
+}
+
+template<typename F>
+void Value::for_each(F&& f) const {
+    if (!doc_ || doc_->at(pos_) != '[') return;
+
+    uint32_t pos = pos_ + 1;
+    if (doc_->at(pos) == ']') return;
+
+    while (true) {
+        f(Value{doc_, pos});
+        pos = doc_->skip(pos);
+        if (doc_->at(pos) != ',') break;
+        ++pos;
     }
-    
+}
+
+inline std::optional<int64_t> Value::get_int64() const {
+    if (!doc_ || type() != Type::Number) return std::nullopt;
+
+    std::string_view text = doc_->scalar_text(pos_);
+    int64_t value;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr != text.data() + text.size()) return std::nullopt;
+    return value;
+}
+
+inline std::optional<double> Value::get_double() const {
+    if (!doc_ || type() != Type::Number) return std::nullopt;
+
+    // from_chars для double: без локали, без копии, точное округление
+    std::string_view text = doc_->scalar_text(pos_);
+    double value;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{}) return std::nullopt;
+    return value;
+}
+
+inline std::optional<bool> Value::get_bool() const {
+    if (!doc_) return std::nullopt;
+    std::string_view text = doc_->scalar_text(pos_);
+    if (text == "true") return true;
+    if (text == "false") return false;
+    return std::nullopt;
+}
+
+inline bool Value::is_null() const {
+    return doc_ && doc_->scalar_text(pos_) == "null";
+}
+
+inline std::optional<std::string_view> Value::get_raw_string() const {
+    if (!doc_ || doc_->at(pos_) != '"') return std::nullopt;
+    return doc_->raw_string(pos_);
+}
+
+inline bool Value::get_string(std::string& out) const {
+    auto raw = get_raw_string();
+    if (!raw) return false;
+
+    out.clear();
+    std::string_view s = *raw;
+
+    while (!s.empty()) {
+        // Чистые участки копируются целиком, а не по символу
+        size_t slash = s.find('\\');
+        out.append(s.substr(0, slash));
+        if (slash == std::string_view::npos) break;
+
+        if (slash + 1 >= s.size()) return false;
+        char e = s[slash + 1];
+        s.remove_prefix(slash + 2);
+
+        switch (e) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                auto hex4 = [&](uint32_t& cp) {
+                    if (s.size() < 4) return false;
+                    auto [p, ec] = std::from_chars(s.data(), s.data() + 4, cp, 16);
+                    s.remove_prefix(4);
+                    return ec == std::errc{} && p == s.data();
+                };
+
+                uint32_t cp;
+                if (!hex4(cp)) return false;
+
+                // Суррогатная пара → один code point
+                if (cp >= 0xD800 && cp <= 0xDBFF && s.size() >= 6 && s[0] == '\\' && s[1] == 'u') {
+                    s.remove_prefix(2);
+                    uint32_t low;
+                    if (!hex4(low)) return false;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+
+                // UTF-8
+                if (cp < 0x80) {
+                    out += char(cp);
+                } else if (cp < 0x800) {
+                    out += char(0xC0 | (cp >> 6));
+                    out += char(0x80 | (cp & 0x3F));
+                } else if (cp < 0x10000) {
+                    out += char(0xE0 | (cp >> 12));
+                    out += char(0x80 | ((cp >> 6) & 0x3F));
+                    out += char(0x80 | (cp & 0x3F));
+                } else {
+                    out += char(0xF0 | (cp >> 18));
+                    out += char(0x80 | ((cp >> 12) & 0x3F));
+                    out += char(0x80 | ((cp >> 6) & 0x3F));
+                    out += char(0x80 | (cp & 0x3F));
+                }
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+} // namespace ondemand
+
+// On-demand: достаём только нужные поля, DOM не строится
+void ondemand_json_example() {
+    std::string json_str = R"({
+        "name": "John",
+        "age": 30,
+        "city": "New \"York\"",
+        "hobbies": ["reading", "gaming"],
+        "active": true
+    })";
+
+    ondemand::Document doc;
+    if (!doc.parse(json_str)) {
+        std::cerr << "Unterminated string\n";
+        return;
+    }
+
+    auto root = doc.root();
+    std::cout << "age: " << root["age"].get_int64().value_or(0) << '\n';
+
+    std::string city;
+    if (root["city"].get_string(city)) {
+        std::cout << "city: " << city << '\n';
+    }
+
+    root["hobbies"].for_each([](ondemand::Value v) {
+        std::cout << "hobby: " << v.get_raw_string().value_or("?") << '\n';
+    });
+
+    // Битый ввод: индекс проходит, но обход не должен выходить за сторож
+    for (std::string_view bad : {R"({"a"})", R"({"a":1,"b"})", R"({"a":[1,{"b":)", R"({"a":1,)"}) {
+        ondemand::Document broken;
+        if (!broken.parse(bad)) continue;
+        auto r = broken.root();
+        std::cout << bad << " -> b: " << (r["b"] ? "found" : "missing")
+                  << ", z: " << (r["z"] ? "found" : "missing") << '\n';
+    }
+}
+
+// Синтетические корпуса в духе twitter.json и citm_catalog.json из simdjson.
+// Настоящие файлы можно подставить через path (https://github.com/simdjson/simdjson/tree/master/jsonexamples)
+std::string make_twitter_like_corpus(size_t statuses) {
+    std::string out = R"({"statuses":[)";
+    for (size_t i = 0; i < statuses; ++i) {
+        if (i) out += ',';
+        out += R"({"id":)" + std::to_string(505874924095815700 + i) +
+               R"(,"text":"RT @user: こんにちは \"quoted\" text #tag)" +
+               std::to_string(i) + R"(","user":{"id":)" + std::to_string(1186275104 + i) +
+               R"(,"screen_name":"user_)" + std::to_string(i) +
+               R"(","followers_count":)" + std::to_string(i * 37 % 10007) +
+               R"(,"verified":false,"profile_background_color":"C0DEED"},)"
+               R"("retweet_count":)" + std::to_string(i % 100) +
+               R"(,"favorited":false,"lang":"ja","entities":{"hashtags":[{"text":"tag",)"
+               R"("indices":[23,27]}],"urls":[],"user_mentions":[]}})";
+    }
+    out += R"(],"search_metadata":{"count":)" + std::to_string(statuses) + "}}";
+    return out;
+}
+
+std::string make_citm_like_corpus(size_t events) {
+    std::string out = R"({"events":{)";
+    for (size_t i = 0; i < events; ++i) {
+        if (i) out += ',';
+        out += '"' + std::to_string(138586341 + i) + R"(":{"description":null,"id":)" +
+               std::to_string(138586341 + i) + R"(,"logo":null,"name":"Event )" + std::to_string(i) +
+               R"(","subTopicIds":[337184269,337184283],"topicIds":[324846099,107888604]})";
+    }
+    out += R"(},"performances":[)";
+    for (size_t i = 0; i < events; ++i) {
+        if (i) out += ',';
+        out += R"({"eventId":)" + std::to_string(138586341 + i) + R"(,"prices":[)";
+        for (int p = 0; p < 8; ++p) {
+            if (p) out += ',';
+            out += R"({"amount":)" + std::to_string(90250 + p * 1000) + R"(,"seatCategoryId":)" +
+                   std::to_string(338937295 + p) + '}';
+        }
+        out += R"(],"start":1372701600000,"venueCode":"PLEYEL_PLEYEL"})";
+    }
+    out += "]}";
+    return out;
+}
+
+// Бенчмарк: GB/s (JSONParser с полным DOM vs on-demand с выборкой полей)
+void json_parser_benchmark() {
+    auto measure = [](const char* name, const std::string& json, int iterations, auto&& fn) {
+        uint64_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) checksum += fn(json);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double gbps = double(json.size()) * iterations / seconds / 1e9;
+        std::cout << name << ": " << gbps << " GB/s (checksum " << checksum << ")\n";
+    };
+
+    std::string twitter = make_twitter_like_corpus(2000);
+    std::string citm = make_citm_like_corpus(2000);
+    std::cout << "twitter-like: " << twitter.size() / 1024 << " KB, citm-like: "
+              << citm.size() / 1024 << " KB\n";
+
+    ondemand::Document doc;
+
+    // twitter: сумма followers_count всех пользователей
+    measure("twitter JSONParser (DOM)", twitter, 5, [](const std::string& json) {
+        JSONParser parser(json);
+        JSON dom = parser.parse();  // Меряем только разбор; DOM строится целиком в любом случае
+        return uint64_t(1);
+    });
+    measure("twitter on-demand       ", twitter, 50, [&doc](const std::string& json) {
+        doc.parse(json);
+        uint64_t sum = 0;
+        doc.root()["statuses"].for_each([&](ondemand::Value status) {
+            sum += status["user"]["followers_count"].get_int64().value_or(0);
+        });
+        return sum;
+    });
+
+    // citm: сумма всех цен
+    measure("citm JSONParser (DOM)   ", citm, 5, [](const std::string& json) {
+        JSONParser parser(json);
+        JSON dom = parser.parse();
+        return uint64_t(1);
+    });
+    measure("citm on-demand          ", citm, 50, [&doc](const std::string& json) {
+        doc.parse(json);
+        uint64_t sum = 0;
+        doc.root()["performances"].for_each([&](ondemand::Value perf) {
+            perf["prices"].for_each([&](ondemand::Value price) {
+                sum += price["amount"].get_int64().value_or(0);
+            });
+        });
+        return sum;
+    });
+
+    // Stage 1 отдельно: чистая скорость SIMD-индексации
+    std::vector<uint32_t> index;
+    ondemand::StructuralIndexer indexer;
+    measure("twitter stage 1 only    ", twitter, 50, [&](const std::string& json) {
+        indexer.index(json, index);
+        return uint64_t(index.size());
+    });
+}
+
+// ============================================
+// 📌 Compact JSON DOM (arena + flat objects)
+// ============================================
+
+// Почему JSON (std::variant выше) дорогой как DOM:
+// - каждый узел: string/vector/unordered_map → несколько аллокаций на узел
+// - unordered_map теряет порядок ключей (а он часто важен: подписи, diff'ы, логи)
+// - sizeof(JSON) ~ 56+ байт, узлы разбросаны по куче → промахи кэша
+// - operator[](index) молча растит массив, operator[](key) молча создаёт ключ
+//
+// Compact DOM:
+// - все узлы и строки - из одного std::pmr::monotonic_buffer_resource на документ;
+//   освобождение документа = освобождение нескольких больших блоков
+// - узел 24 байта, дети массива/объекта лежат подряд
+// - объект - плоский вектор (key, value) в порядке вставки; для больших объектов
+//   хэш-индекс строится лениво при первом поиске
+// - строки без escape-последовательностей - string_view прямо в исходный текст
+
+#include <cstring>
+#include <memory_resource>
+#include <bit>
+#include <span>
+#include <malloc.h>
+
+namespace compact {
+
+enum class Kind : uint8_t { Null, Bool, Int, Double, String, Array, Object };
+
+struct Member;
+
+struct Node {
+    Kind kind = Kind::Null;
+    bool boolean = false;
+    uint32_t size = 0;                    // Длина строки / число элементов
+    union {
+        int64_t integer;
+        double number;
+        const char* string;               // В исходник (zero-copy) или в арену
+        Node* items;                      // Массив: size узлов подряд
+        Member* members;                  // Объект: size пар подряд
+    };
+    mutable uint32_t* hash_index = nullptr;  // Только у больших объектов, строится лениво
+
+    Node() : integer(0) {}
+};
+
+struct Member {
+    std::string_view key;
+    Node value;
+};
+
+static_assert(sizeof(Node) <= 32);
+
+// Счётчик обращений к upstream: сколько раз арена ходила в malloc и сколько взяла
+class CountingResource : public std::pmr::memory_resource {
+    std::pmr::memory_resource* upstream_;
+
+public:
+    size_t allocations = 0;
+    size_t bytes = 0;
+
+    explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_(upstream) {}
+
+private:
+    void* do_allocate(size_t n, size_t align) override {
+        ++allocations;
+        bytes += n;
+        return upstream_->allocate(n, align);
+    }
+    void do_deallocate(void* p, size_t n, size_t align) override {
+        upstream_->deallocate(p, n, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+class Document;
+
+// Handle для навигации: {документ, узел}. Отсутствующее значение - пустой Ref
+class Ref {
+    const Document* doc_ = nullptr;
+    const Node* node_ = nullptr;
+
+public:
+    Ref() = default;
+    Ref(const Document* doc, const Node* node) : doc_(doc), node_(node) {}
+
+    explicit operator bool() const { return node_ != nullptr; }
+    Kind kind() const { return node_ ? node_->kind : Kind::Null; }
+    size_t size() const {
+        return node_ && (node_->kind == Kind::Array || node_->kind == Kind::Object) ? node_->size : 0;
+    }
+
+    // Без скрытых вставок и resize: нет значения - пустой Ref
+    Ref operator[](size_t index) const {
+        if (!node_ || node_->kind != Kind::Array || index >= node_->size) return {};
+        return {doc_, &node_->items[index]};
+    }
+
+    inline Ref operator[](std::string_view key) const;
+
+    std::optional<int64_t> as_int() const {
+        if (!node_ || node_->kind != Kind::Int) return std::nullopt;
+        return node_->integer;
+    }
+    std::optional<double> as_double() const {
+        if (!node_) return std::nullopt;
+        if (node_->kind == Kind::Double) return node_->number;
+        if (node_->kind == Kind::Int) return double(node_->integer);
+        return std::nullopt;
+    }
+    std::optional<bool> as_bool() const {
+        if (!node_ || node_->kind != Kind::Bool) return std::nullopt;
+        return node_->boolean;
+    }
+    std::optional<std::string_view> as_string() const {
+        if (!node_ || node_->kind != Kind::String) return std::nullopt;
+        return std::string_view(node_->string, node_->size);
+    }
+
+    // Ключи в порядке из исходного документа
+    std::span<const Member> members() const {
+        if (!node_ || node_->kind != Kind::Object) return {};
+        return {node_->members, node_->size};
+    }
+    std::span<const Node> items() const {
+        if (!node_ || node_->kind != Kind::Array) return {};
+        return {node_->items, node_->size};
+    }
+
+    const Node* node() const { return node_; }
+};
+
+class Document {
+public:
+    static constexpr uint32_t HASH_THRESHOLD = 16;  // До 16 ключей линейный поиск быстрее
+    static constexpr int MAX_DEPTH = 512;
+
+private:
+    CountingResource counter_;
+    std::pmr::monotonic_buffer_resource arena_;
+    Node root_;
+    std::string error_;
+    const char* p_ = nullptr;
+    const char* end_ = nullptr;
+    int depth_ = 0;
+
+    // Стеки для сборки детей: детей заранее не посчитать, поэтому копим здесь
+    // и одним куском переносим в арену, когда контейнер закрылся
+    std::vector<Node> item_stack_;
+    std::vector<Member> member_stack_;
+
+    friend class Ref;
+
+public:
+    // initial_block - первый блок арены (например, 64 KB на стеке соединения)
+    explicit Document(size_t initial_block = 64 * 1024)
+        : arena_(initial_block, &counter_) {}
+
+    Document(const Document&) = delete;
+    Document& operator=(const Document&) = delete;
+
+    // json должен жить дольше документа: строки без escape указывают прямо в него.
+    // Повторный parse() освобождает арену - Ref'ы на прошлый документ невалидны
+    bool parse(std::string_view json) {
+        arena_.release();
+        counter_.allocations = 0;
+        counter_.bytes = 0;
+        root_ = Node{};
+        error_.clear();
+        item_stack_.clear();
+        member_stack_.clear();
+
+        p_ = json.data();
+        end_ = json.data() + json.size();
+        depth_ = 0;
+
+        try {
+            root_ = parse_value();
+            skip_ws();
+            if (p_ != end_) fail("Trailing characters");
+        } catch (const std::runtime_error& e) {
+            error_ = std::string(e.what()) + " at offset " + std::to_string(p_ - json.data());
+            root_ = Node{};
+            return false;
+        }
+        return true;
+    }
+
+    const std::string& error() const { return error_; }
+    Ref root() const { return {this, &root_}; }
+
+    size_t upstream_allocations() const { return counter_.allocations; }
+    size_t arena_bytes() const { return counter_.bytes; }
+    // Стеки сборки живут в куче рядом с ареной (ёмкость сохраняется между parse())
+    size_t stack_bytes() const {
+        return item_stack_.capacity() * sizeof(Node) + member_stack_.capacity() * sizeof(Member);
+    }
+
+private:
+    [[noreturn]] static void fail(const char* what) { throw std::runtime_error(what); }
+
+    void* allocate(size_t bytes, size_t align) { return arena_.allocate(bytes, align); }
+
+    void skip_ws() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) ++p_;
+    }
+
+    Node parse_value() {
+        skip_ws();
+        if (p_ >= end_) fail("Unexpected end of input");
+
+        switch (*p_) {
+            case '{': return parse_object();
+            case '[': return parse_array();
+            case '"': return parse_string();
+            case 't': return parse_literal("true", Kind::Bool, true);
+            case 'f': return parse_literal("false", Kind::Bool, false);
+            case 'n': return parse_literal("null", Kind::Null, false);
+            default: return parse_number();
+        }
+    }
+
+    Node parse_literal(std::string_view word, Kind kind, bool value) {
+        if (std::string_view(p_, std::min<size_t>(word.size(), end_ - p_)) != word) {
+            fail("Invalid literal");
+        }
+        p_ += word.size();
+        Node n;
+        n.kind = kind;
+        n.boolean = value;
+        return n;
+    }
+
+    Node parse_number() {
+        const char* start = p_;
+        bool is_double = false;
+
+        if (p_ < end_ && *p_ == '-') ++p_;
+        while (p_ < end_ && ((*p_ >= '0' && *p_ <= '9') || *p_ == '.' ||
+                              *p_ == 'e' || *p_ == 'E' || *p_ == '+' || *p_ == '-')) {
+            is_double |= (*p_ == '.' || *p_ == 'e' || *p_ == 'E');
+            ++p_;
+        }
+
+        Node n;
+        if (!is_double) {
+            n.kind = Kind::Int;
+            auto [ptr, ec] = std::from_chars(start, p_, n.integer);
+            if (ec == std::errc{} && ptr == p_) return n;
+            // Не влезло в int64 - пусть будет double
+        }
+
+        n.kind = Kind::Double;
+        auto [ptr, ec] = std::from_chars(start, p_, n.number);
+        if (ec != std::errc{} || ptr != p_) fail("Invalid number");
+        return n;
+    }
+
+    // Строка: если escape-последовательностей нет, узел указывает прямо в исходник
+    std::string_view parse_raw_string() {
+        ++p_;  // '"'
+        const char* start = p_;
+
+        const char* q = static_cast<const char*>(std::memchr(p_, '"', end_ - p_));
+        const char* bs = static_cast<const char*>(std::memchr(p_, '\\', q ? q - p_ : end_ - p_));
+        if (!q) fail("Unterminated string");
+
+        if (!bs) {
+            p_ = q + 1;
+            return {start, size_t(q - start)};  // Zero-copy
+        }
+
+        // Есть escape: ищем настоящий конец строки и раскодируем в арену
+        // (результат не длиннее исходного участка)
+        const char* close = bs;
+        while (close < end_ && *close != '"') close += (*close == '\\') ? 2 : 1;
+        if (close >= end_) fail("Unterminated string");
+
+        char* out = static_cast<char*>(allocate(close - start, 1));
+        char* w = out;
+        while (true) {
+            const char* quote = static_cast<const char*>(std::memchr(p_, '"', end_ - p_));
+            const char* slash = static_cast<const char*>(
+                std::memchr(p_, '\\', (quote ? quote : end_) - p_));
+            if (!quote) fail("Unterminated string");
+
+            const char* stop = slash ? slash : quote;
+            std::memcpy(w, p_, stop - p_);  // Чистый участок - одним memcpy
+            w += stop - p_;
+            p_ = stop;
+            if (!slash) break;
+
+            if (p_ + 1 >= end_) fail("Unterminated string");
+            char e = p_[1];
+            p_ += 2;
+            switch (e) {
+                case '"': *w++ = '"'; break;
+                case '\\': *w++ = '\\'; break;
+                case '/': *w++ = '/'; break;
+                case 'b': *w++ = '\b'; break;
+                case 'f': *w++ = '\f'; break;
+                case 'n': *w++ = '\n'; break;
+                case 'r': *w++ = '\r'; break;
+                case 't': *w++ = '\t'; break;
+                case 'u': {
+                    uint32_t cp;
+                    if (end_ - p_ < 4 || std::from_chars(p_, p_ + 4, cp, 16).ptr != p_ + 4) {
+                        fail("Invalid \\u escape");
+                    }
+                    p_ += 4;
+                    if (cp >= 0xD800 && cp <= 0xDBFF && end_ - p_ >= 6 && p_[0] == '\\' && p_[1] == 'u') {
+                        uint32_t low;
+                        if (std::from_chars(p_ + 2, p_ + 6, low, 16).ptr != p_ + 6) fail("Invalid surrogate");
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        p_ += 6;
+                    }
+                    if (cp < 0x80) {
+                        *w++ = char(cp);
+                    } else if (cp < 0x800) {
+                        *w++ = char(0xC0 | (cp >> 6));
+                        *w++ = char(0x80 | (cp & 0x3F));
+                    } else if (cp < 0x10000) {
+                        *w++ = char(0xE0 | (cp >> 12));
+                        *w++ = char(0x80 | ((cp >> 6) & 0x3F));
+                        *w++ = char(0x80 | (cp & 0x3F));
+                    } else {
+                        *w++ = char(0xF0 | (cp >> 18));
+                        *w++ = char(0x80 | ((cp >> 12) & 0x3F));
+                        *w++ = char(0x80 | ((cp >> 6) & 0x3F));
+                        *w++ = char(0x80 | (cp & 0x3F));
+                    }
+                    break;
+                }
+                default:
+                    fail("Invalid escape");
+            }
+        }
+        ++p_;  // Закрывающая '"'
+        return {out, size_t(w - out)};
+    }
+
+    Node parse_string() {
+        std::string_view s = parse_raw_string();
+        Node n;
+        n.kind = Kind::String;
+        n.string = s.data();
+        n.size = uint32_t(s.size());
+        return n;
+    }
+
+    Node parse_array() {
+        if (++depth_ > MAX_DEPTH) fail("Too deep");
+        ++p_;  // '['
+        size_t base = item_stack_.size();
+
+        skip_ws();
+        if (p_ < end_ && *p_ == ']') {
+            ++p_;
+        } else {
+            while (true) {
+                Node child = parse_value();
+                item_stack_.push_back(child);
+                skip_ws();
+                if (p_ < end_ && *p_ == ',') { ++p_; continue; }
+                if (p_ < end_ && *p_ == ']') { ++p_; break; }
+                fail("Expected ',' or ']'");
+            }
+        }
+
+        Node n;
+        n.kind = Kind::Array;
+        n.size = uint32_t(item_stack_.size() - base);
+        n.items = static_cast<Node*>(allocate(sizeof(Node) * n.size, alignof(Node)));
+        std::uninitialized_copy(item_stack_.begin() + base, item_stack_.end(), n.items);
+        item_stack_.resize(base);
+        --depth_;
+        return n;
+    }
+
+    Node parse_object() {
+        if (++depth_ > MAX_DEPTH) fail("Too deep");
+        ++p_;  // '{'
+        size_t base = member_stack_.size();
+
+        skip_ws();
+        if (p_ < end_ && *p_ == '}') {
+            ++p_;
+        } else {
+            while (true) {
+                skip_ws();
+                if (p_ >= end_ || *p_ != '"') fail("Expected key");
+                std::string_view key = parse_raw_string();
+
+                skip_ws();
+                if (p_ >= end_ || *p_ != ':') fail("Expected ':'");
+                ++p_;
+
+                Node value = parse_value();
+                member_stack_.push_back({key, value});
+
+                skip_ws();
+                if (p_ < end_ && *p_ == ',') { ++p_; continue; }
+                if (p_ < end_ && *p_ == '}') { ++p_; break; }
+                fail("Expected ',' or '}'");
+            }
+        }
+
+        Node n;
+        n.kind = Kind::Object;
+        n.size = uint32_t(member_stack_.size() - base);
+        n.members = static_cast<Member*>(allocate(sizeof(Member) * n.size, alignof(Member)));
+        std::uninitialized_copy(member_stack_.begin() + base, member_stack_.end(), n.members);
+        member_stack_.resize(base);
+        --depth_;
+        return n;
+    }
+
+    static uint32_t hash(std::string_view s) {
+        uint32_t h = 2166136261u;  // FNV-1a
+        for (unsigned char c : s) h = (h ^ c) * 16777619u;
+        return h;
+    }
+
+    // Открытая адресация: индексы members + 1, 0 - пусто. Дубликаты ключей: побеждает первый
+    const uint32_t* build_index(const Node& obj) const {
+        uint32_t capacity = std::bit_ceil(obj.size * 2);
+        auto* table = static_cast<uint32_t*>(
+            const_cast<std::pmr::monotonic_buffer_resource&>(arena_).allocate(
+                sizeof(uint32_t) * capacity, alignof(uint32_t)));
+        std::fill_n(table, capacity, 0u);
+
+        for (uint32_t i = 0; i < obj.size; ++i) {
+            uint32_t slot = hash(obj.members[i].key) & (capacity - 1);
+            while (table[slot] != 0) {
+                if (obj.members[table[slot] - 1].key == obj.members[i].key) break;
+                slot = (slot + 1) & (capacity - 1);
+            }
+            if (table[slot] == 0) table[slot] = i + 1;
+        }
+        obj.hash_index = table;
+        return table;
+    }
+
+    const Node* find(const Node& obj, std::string_view key) const {
+        if (obj.size <= HASH_THRESHOLD) {
+            for (uint32_t i = 0; i < obj.size; ++i) {
+                if (obj.members[i].key == key) return &obj.members[i].value;
+            }
+            return nullptr;
+        }
+
+        // Ленивый индекс: не нужен, если объект не ищут по ключу (не потокобезопасно)
+        const uint32_t* table = obj.hash_index ? obj.hash_index : build_index(obj);
+        uint32_t capacity = std::bit_ceil(obj.size * 2);
+        for (uint32_t slot = hash(key) & (capacity - 1); table[slot] != 0;
+             slot = (slot + 1) & (capacity - 1)) {
+            const Member& m = obj.members[table[slot] - 1];
+            if (m.key == key) return &m.value;
+        }
+        return nullptr;
+    }
+};
+
+inline Ref Ref::operator[](std::string_view key) const {
+    if (!node_ || node_->kind != Kind::Object) return {};
+    const Node* found = doc_->find(*node_, key);
+    return found ? Ref{doc_, found} : Ref{};
+}
+
+} // namespace compact
+
+void compact_dom_example() {
+    std::string json_str = R"({"id": 7, "name": "Alice", "tags": ["a", "b\n"], "address": {"city": "NY"}})";
+
+    compact::Document doc;
+    if (!doc.parse(json_str)) {
+        std::cerr << "Parse error: " << doc.error() << '\n';
+        return;
+    }
+    compact::Ref root = doc.root();
+
+    // Порядок ключей сохранён
+    for (const auto& m : root.members()) std::cout << m.key << ' ';
+    std::cout << '\n';
+
+    std::cout << root["address"]["city"].as_string().value_or("?") << '\n';
+    std::cout << "tags[5] exists: " << bool(root["tags"][5]) << '\n';  // false, без resize
+}
+
+// Подсчёт аллокаций глобальной кучи для сравнения с JSON (variant DOM).
+// Включается -DCOUNT_ALLOCATIONS, т.к. подменяет глобальный operator new.
+// Aligned-формы тоже: через них new_delete_resource отдаёт блоки арены compact::Document
+#ifdef COUNT_ALLOCATIONS
+namespace alloc_stats {
+    inline size_t count = 0;
+    inline size_t current = 0;
+    inline size_t peak = 0;
+}
+
+void* operator new(size_t n) {
+    void* p = std::malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    ++alloc_stats::count;
+    alloc_stats::current += malloc_usable_size(p);
+    alloc_stats::peak = std::max(alloc_stats::peak, alloc_stats::current);
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    if (p) alloc_stats::current -= malloc_usable_size(p);
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+
+void* operator new(size_t n, std::align_val_t align) {
+    size_t alignment = std::max(size_t(align), sizeof(void*));
+    void* p = std::aligned_alloc(alignment, (std::max<size_t>(n, 1) + alignment - 1) / alignment * alignment);
+    if (!p) throw std::bad_alloc();
+    ++alloc_stats::count;
+    alloc_stats::current += malloc_usable_size(p);
+    alloc_stats::peak = std::max(alloc_stats::peak, alloc_stats::current);
+    return p;
+}
+
+void operator delete(void* p, std::align_val_t) noexcept { operator delete(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { operator delete(p); }
+#endif
+
+// Аллокации и пиковая память на большом payload (JSON vs compact::Document)
+void compact_dom_benchmark() {
+    std::string payload = make_twitter_like_corpus(20000);  // ~7 MB
+    std::cout << "Payload: " << payload.size() / 1024 << " KB\n";
+
+    auto time_it = [](auto&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+#ifdef COUNT_ALLOCATIONS
+    auto count_before = alloc_stats::count;
+    alloc_stats::peak = alloc_stats::current;
+    auto base = alloc_stats::current;
+#endif
+
+    double dom_ms = time_it([&] {
+        JSONParser parser(payload);
+        JSON dom = parser.parse();
+    });
+    std::cout << "JSON (variant DOM): " << dom_ms << " ms";
+#ifdef COUNT_ALLOCATIONS
+    std::cout << ", allocations: " << alloc_stats::count - count_before
+              << ", peak: " << (alloc_stats::peak - base) / 1024 << " KB";
+#endif
+    std::cout << '\n';
+
+    // Те же счётчики alloc_stats: блоки арены и стеки item_stack_/member_stack_
+    // тоже берутся из глобальной кучи - сравнение с variant DOM честное
+#ifdef COUNT_ALLOCATIONS
+    count_before = alloc_stats::count;
+    alloc_stats::peak = alloc_stats::current;
+    base = alloc_stats::current;
+#endif
+
+    size_t arena_allocs = 0, arena_bytes = 0, stack_bytes = 0;
+    double compact_ms = time_it([&] {
+        compact::Document doc;
+        doc.parse(payload);
+        arena_allocs = doc.upstream_allocations();
+        arena_bytes = doc.arena_bytes();
+        stack_bytes = doc.stack_bytes();
+    });
+    std::cout << "compact::Document: " << compact_ms << " ms";
+#ifdef COUNT_ALLOCATIONS
+    std::cout << ", allocations: " << alloc_stats::count - count_before
+              << ", peak: " << (alloc_stats::peak - base) / 1024 << " KB";
+#endif
+    std::cout << " (arena blocks: " << arena_allocs << ", arena: " << arena_bytes / 1024
+              << " KB, stacks: " << stack_bytes / 1024 << " KB)\n";
+
+    // Поиск по большому объекту: первый вызов строит хэш-индекс, дальше O(1)
+    std::string wide = "{";
+    for (int i = 0; i < 1000; ++i) {
+        if (i) wide += ',';
+        wide += "\"key" + std::to_string(i) + "\":" + std::to_string(i);
+    }
+    wide += '}';
+
+    compact::Document doc;
+    doc.parse(wide);
+    compact::Ref root = doc.root();
+    int64_t sum = 0;
+    double lookup_ms = time_it([&] {
+        for (int round = 0; round < 100; ++round) {
+            for (int i = 0; i < 1000; i += 7) {
+                sum += root["key" + std::to_string(i)].as_int().value_or(0);
+            }
+        }
+    });
+    std::cout << "Wide object lookups: " << lookup_ms << " ms (sum " << sum << ")\n";
+}
+
+// ============================================
+// 📌 Streaming JSON Writer
+// ============================================
+
+// JSON::to_string выше:
+// - новый std::ostringstream на КАЖДЫЙ вложенный узел + копирование результата наверх
+// - escape_string собирает строку посимвольно
+// - double через oss << v: 6 значащих цифр, 0.1 + 0.2 превращается в 0.3 - не round-trip
+//
+// JsonWriter:
+// - пишет в Sink с интерфейсом prepare(n) → std::span<char> / commit(n):
+//   JsonBuffer (переиспользуемый растущий буфер) или сразу выходное кольцо
+//   соединения (MirroredRingBuffer из async_io.cpp имеет тот же интерфейс)
+// - целые и double через std::to_chars (double - кратчайшее round-trip представление)
+// - строки: SIMD ищет байты, требующие экранирования; чистые участки копируются memcpy
+// - write(T) для отражённых структур без промежуточного DOM
+
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <concepts>
+#include <ranges>
+#include <cmath>
+
+// Минимальная compile-time рефлексия: структура перечисляет свои поля
+//   static constexpr auto fields() { return std::make_tuple(reflect::field("id", &T::id), ...); }
+namespace reflect {
+
+// Как поле кодируется в бинарных форматах (JSON это игнорирует)
+enum class Encoding : uint8_t { Fixed, Varint };
+
+template <typename Class, typename T, Encoding E = Encoding::Fixed>
+struct Field {
+    using class_type = Class;
+    using value_type = T;
+    static constexpr Encoding encoding = E;
+
+    std::string_view name;
+    T Class::* member;
+    uint16_t since = 1;  // Версия схемы, в которой поле появилось
+};
+
+template <typename Class, typename T>
+constexpr Field<Class, T> field(std::string_view name, T Class::* member, uint16_t since = 1) {
+    return {name, member, since};
+}
+
+template <typename T>
+concept Reflected = requires { T::fields(); };
+
+// f(name, value) для каждого поля в порядке объявления
+template <Reflected T, typename F>
+constexpr void for_each_field(T& obj, F&& f) {
+    std::apply([&](const auto&... fld) { (f(fld.name, obj.*fld.member), ...); }, T::fields());
+}
+
+} // namespace reflect
+
+// Переиспользуемый буфер: clear() не освобождает память, steady state - без аллокаций
+class JsonBuffer {
+    std::unique_ptr<char[]> data_;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+
+public:
+    explicit JsonBuffer(size_t initial = 4096)
+        : data_(std::make_unique_for_overwrite<char[]>(initial)), capacity_(initial) {}
+
+    // Свободное место целиком (не меньше n) - писатель сам решает, сколько занять
+    std::span<char> prepare(size_t n) {
+        if (capacity_ - size_ < n) {
+            size_t new_capacity = std::max(capacity_ * 2, size_ + n);
+            auto grown = std::make_unique_for_overwrite<char[]>(new_capacity);
+            std::memcpy(grown.get(), data_.get(), size_);
+            data_ = std::move(grown);
+            capacity_ = new_capacity;
+        }
+        return {data_.get() + size_, capacity_ - size_};
+    }
+
+    void commit(size_t n) { size_ += n; }
+    void clear() { size_ = 0; }
+
+    std::string_view view() const { return {data_.get(), size_}; }
+    size_t size() const { return size_; }
+};
+
+template <typename S>
+concept JsonSink = requires(S& s, size_t n) {
+    { s.prepare(n) } -> std::convertible_to<std::span<char>>;
+    s.commit(n);
+};
+
+// Позиция первого байта, который надо экранировать: '"', '\\' или < 0x20
+inline const char* find_json_escape(const char* p, const char* end) {
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));  // unsigned <= 0x1F
+        if (int mask = _mm_movemask_epi8(special)) {
+            return p + std::countr_zero(static_cast<unsigned>(mask));
+        }
+    }
+#endif
+    for (; p < end; ++p) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\' || c < 0x20) return p;
+    }
+    return end;
+}
+
+template <JsonSink Sink>
+class JsonWriter {
+    Sink& sink_;
+    char* cur_ = nullptr;        // Текущая позиция в регионе от sink.prepare()
+    char* begin_ = nullptr;
+    char* end_ = nullptr;
+    bool need_comma_ = false;
+    bool ok_ = true;
+
+    static constexpr size_t CHUNK = 4096;
+
+public:
+    explicit JsonWriter(Sink& sink) : sink_(sink) {}
+    ~JsonWriter() { flush(); }
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    // false - кольцо переполнилось, вывод оборван (буфер JsonBuffer не переполняется)
+    bool ok() const { return ok_; }
+
+    void flush() {
+        if (cur_ != begin_) sink_.commit(cur_ - begin_);
+        begin_ = cur_;
+    }
+
+    // ---------- Потоковый API ----------
+
+    void begin_object() { separator(); put('{'); need_comma_ = false; }
+    void end_object() { put('}'); need_comma_ = true; }
+    void begin_array() { separator(); put('['); need_comma_ = false; }
+    void end_array() { put(']'); need_comma_ = true; }
+
+    void key(std::string_view k) {
+        separator();
+        string_literal(k);
+        put(':');
+        need_comma_ = false;
+    }
+
+    // ---------- Значения ----------
+
+    void write(std::nullptr_t) { separator(); raw("null"); }
+    void write(bool b) { separator(); raw(b ? "true" : "false"); }
+
+    template <typename T>
+        requires(std::integral<T> && !std::same_as<T, bool> && !std::same_as<T, char>)
+    void write(T v) {
+        separator();
+        if (char* out = reserve(24)) {
+            cur_ = std::to_chars(out, out + 24, v).ptr;
+        }
+    }
+
+    void write(double v) {
+        separator();
+        if (!std::isfinite(v)) {  // В JSON нет NaN/Infinity
+            raw("null");
+            return;
+        }
+        if (char* out = reserve(32)) {
+            char* stop = std::to_chars(out, out + 32, v).ptr;  // Кратчайшее round-trip
+            // "1" → "1.0": при обратном разборе число останется double
+            if (std::find_if(out, stop, [](char c) { return c == '.' || c == 'e'; }) == stop) {
+                *stop++ = '.';
+                *stop++ = '0';
+            }
+            cur_ = stop;
+        }
+    }
+
+    void write(float v) { write(static_cast<double>(v)); }
+
+    void write(std::string_view s) { separator(); string_literal(s); }
+    void write(const char* s) { write(std::string_view(s)); }
+    void write(const std::string& s) { write(std::string_view(s)); }
+
+    template <typename T>
+    void write(const std::optional<T>& v) {
+        if (v) write(*v);
+        else write(nullptr);
+    }
+
+    // Любой диапазон (vector, span, array) - JSON-массив
+    template <std::ranges::input_range R>
+        requires(!std::convertible_to<const R&, std::string_view>)
+    void write(const R& range) {
+        begin_array();
+        for (const auto& item : range) write(item);
+        end_array();
+    }
+
+    // Отражённая структура - JSON-объект, поля в порядке объявления
+    template <reflect::Reflected T>
+    void write(const T& obj) {
+        begin_object();
+        reflect::for_each_field(obj, [&](std::string_view name, const auto& value) {
+            key(name);
+            write(value);
+        });
+        end_object();
+    }
+
+    // Существующий DOM - та же разметка, что и JSON::to_string()
+    void write(const JSON& json) {
+        std::visit([&](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, JSON::Array>) {
+                begin_array();
+                for (const auto& item : v) write(item);
+                end_array();
+            } else if constexpr (std::is_same_v<T, JSON::Object>) {
+                begin_object();
+                for (const auto& [k, item] : v) {
+                    key(k);
+                    write(item);
+                }
+                end_object();
+            } else {
+                write(v);
+            }
+        }, json.value());
+    }
+
+private:
+    void separator() {
+        if (need_comma_) put(',');
+        need_comma_ = true;
+    }
+
+    // Гарантирует n байт в текущем регионе; при нехватке - commit и новый prepare
+    char* reserve(size_t n) {
+        if (static_cast<size_t>(end_ - cur_) >= n) return cur_;
+        if (!ok_) return nullptr;
+
+        flush();
+        std::span<char> region = sink_.prepare(std::max(n, CHUNK));
+        if (region.size() < n) {
+            ok_ = false;
+            begin_ = cur_ = end_ = nullptr;
+            return nullptr;
+        }
+        begin_ = cur_ = region.data();
+        end_ = region.data() + region.size();
+        return cur_;
+    }
+
+    void put(char c) {
+        if (char* out = reserve(1)) {
+            *out = c;
+            cur_ = out + 1;
+        }
+    }
+
+    void raw(std::string_view s) {
+        if (char* out = reserve(s.size())) {
+            std::memcpy(out, s.data(), s.size());
+            cur_ = out + s.size();
+        }
+    }
+
+    void string_literal(std::string_view s) {
+        put('"');
+        const char* p = s.data();
+        const char* end = p + s.size();
+
+        while (p < end) {
+            const char* special = find_json_escape(p, end);
+            size_t run = special - p;
+
+            // Чистый участок + место под одно экранирование (\u00XX)
+            char* out = reserve(run + 6);
+            if (!out) return;
+            std::memcpy(out, p, run);
+            out += run;
+            p = special;
+
+            if (p < end) {
+                unsigned char c = static_cast<unsigned char>(*p++);
+                *out++ = '\\';
+                switch (c) {
+                    case '"': *out++ = '"'; break;
+                    case '\\': *out++ = '\\'; break;
+                    case '\b': *out++ = 'b'; break;
+                    case '\f': *out++ = 'f'; break;
+                    case '\n': *out++ = 'n'; break;
+                    case '\r': *out++ = 'r'; break;
+                    case '\t': *out++ = 't'; break;
+                    default:
+                        static constexpr char hex[] = "0123456789abcdef";
+                        *out++ = 'u';
+                        *out++ = '0';
+                        *out++ = '0';
+                        *out++ = hex[c >> 4];
+                        *out++ = hex[c & 0xF];
+                }
+            }
+            cur_ = out;
+        }
+        put('"');
+    }
+};
+
+struct OrderLine {
+    std::string sku;
+    int32_t quantity = 0;
+    double price = 0;
+
+    static constexpr auto fields() {
+        return std::make_tuple(reflect::field("sku", &OrderLine::sku),
+                               reflect::field("quantity", &OrderLine::quantity),
+                               reflect::field("price", &OrderLine::price));
+    }
+};
+
+struct Order {
+    uint64_t id = 0;
+    std::string customer;
+    std::vector<OrderLine> lines;
+    std::optional<std::string> note;
+    bool paid = false;
+
+    static constexpr auto fields() {
+        return std::make_tuple(reflect::field("id", &Order::id),
+                               reflect::field("customer", &Order::customer),
+                               reflect::field("lines", &Order::lines),
+                               reflect::field("note", &Order::note),
+                               reflect::field("paid", &Order::paid));
+    }
+};
+
+void json_writer_example() {
+    JsonBuffer buffer;  // Живёт вместе с соединением/потоком
+
+    Order order{42, "Alice \"A.\" Smith", {{"SKU-1", 2, 0.1 + 0.2}, {"SKU-2", 1, 19.0}}, std::nullopt, true};
+    {
+        JsonWriter writer(buffer);
+        writer.write(order);
+    }
+    std::cout << buffer.view() << '\n';
+    // {"id":42,"customer":"Alice \"A.\" Smith","lines":[{"sku":"SKU-1","quantity":2,
+    //  "price":0.30000000000000004},{"sku":"SKU-2","quantity":1,"price":19.0}],"note":null,"paid":true}
+
+    // Потоковый API - ответ собирается без DOM
+    buffer.clear();
+    {
+        JsonWriter writer(buffer);
+        writer.begin_object();
+        writer.key("status");
+        writer.write("ok");
+        writer.key("ids");
+        writer.write(std::vector<int>{1, 2, 3});
+        writer.end_object();
+    }
+    std::cout << buffer.view() << '\n';
+
+    // В кольцо соединения (async_io.cpp) - без промежуточного буфера:
+    // JsonWriter writer(conn.out);   // MirroredRingBuffer: prepare()/commit()
+    // writer.write(order);
+    // writer.flush();
+    // if (!writer.ok()) { /* кольцо переполнено - закрыть соединение */ }
+}
+
+// Пропускная способность: JSON::to_string против JsonWriter (DOM и отражённые структуры)
+void json_writer_benchmark() {
+    constexpr int ORDERS = 2000;
+    constexpr int ROUNDS = 20;
+
+    std::vector<Order> orders;
+    JSON::Array dom_orders;
+    for (int i = 0; i < ORDERS; ++i) {
+        Order o{uint64_t(i), "customer \"" + std::to_string(i) + "\"\n", {}, std::nullopt, i % 2 == 0};
+        JSON::Array dom_lines;
+        for (int j = 0; j < 5; ++j) {
+            o.lines.push_back({"SKU-" + std::to_string(j), j + 1, 9.99 * (j + 1)});
+
+            JSON line;
+            line["sku"] = o.lines.back().sku;
+            line["quantity"] = o.lines.back().quantity;
+            line["price"] = o.lines.back().price;
+            dom_lines.push_back(line);
+        }
+        JSON dom;
+        dom["id"] = i;
+        dom["customer"] = o.customer;
+        dom["lines"] = dom_lines;
+        dom["note"] = nullptr;
+        dom["paid"] = o.paid;
+        dom_orders.push_back(dom);
+        orders.push_back(std::move(o));
+    }
+    JSON dom(dom_orders);
+
+    auto run = [&](const char* name, auto&& serialize) {
+        size_t bytes = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < ROUNDS; ++r) bytes += serialize();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << bytes / seconds / (1 << 20) << " MB/s\n";
+    };
+
+    run("JSON::to_string", [&] { return dom.to_string().size(); });
+
+    JsonBuffer buffer;
+    run("JsonWriter(JSON)", [&] {
+        buffer.clear();
+        JsonWriter writer(buffer);
+        writer.write(dom);
+        writer.flush();
+        return buffer.size();
+    });
+
+    run("JsonWriter(Order)", [&] {
+        buffer.clear();
+        JsonWriter writer(buffer);
+        writer.write(orders);
+        writer.flush();
+        return buffer.size();
+    });
+}
+
+// ============================================
+// 📌 Popular Libraries - nlohmann/json
+// ============================================
+
+// #include <nlohmann/json.hpp>
+// using json = nlohmann::json;
+
+// Automatic serialization с nlohmann/json
+struct User {
+    std::string name;
+    int age;
+    std::vector<std::string> hobbies;
+    
+    // NLOHMANN_DEFINE_TYPE_INTRUSIVE(User, name, age, hobbies)
+};
+
+void nlohmann_json_example() {
+    // User user{"Alice", 25, {"reading", "coding"}};
+    
+    // // Сериализация
+    // json j = user;
+    // std::string serialized = j.dump(2);  // Pretty print с indent 2
+    
+    // // Десериализация
+    // User user2 = j.get<User>();
+    
+    // // JSON Pointers
+    // j["/address/city"_json_pointer] = "New York";
+    
+    std::cout << "nlohmann/json: высокоуровневая C++ библиотека\n";
+}
+
+// ============================================
+// 📌 Protocol Buffers
+// ============================================
+
+// Proto Definition (.proto файл):
+//
+// syntax = "proto3";
+//
+// message Person {
+//   string name = 1;
+//   int32 id = 2;
+//   string email = 3;
+//   
+//   enum PhoneType {
+//     MOBILE = 0;
+//     HOME = 1;
+//     WORK = 2;
+//   }
+//   
+//   message PhoneNumber {
+//     string number = 1;
+//     PhoneType type = 2;
+//   }
+//   
+//   repeated PhoneNumber phones = 4;
+//   
+//   google.protobuf.Timestamp last_updated = 5;
+// }
+//
+// message AddressBook {
+//   repeated Person people = 1;
+// }
+
+void protobuf_example() {
+    // После компиляции .proto -> person.pb.h / person.pb.cc
+    
+    // Person person;
+    // person.set_name("John Doe");
+    // person.set_id(1234);
+    // person.set_email("john@example.com");
+    
+    // // Добавление телефона
+    // Person::PhoneNumber* phone = person.add_phones();
+    // phone->set_number("+1-555-0100");
+    // phone->set_type(Person::MOBILE);
+    
+    // // Сериализация в бинарный формат
+    // std::string serialized;
+    // person.SerializeToString(&serialized);
+    
+    // // Десериализация
+    // Person person2;
+    // person2.ParseFromString(serialized);
+    
+    // std::cout << "Name: " << person2.name() << '\n';
+    // std::cout << "Phones: " << person2.phones_size() << '\n';
+    
+    std::cout << "Protocol Buffers: компактный бинарный формат от Google\n";
+}
+
+// Varint encoding в Protobuf
+// Пример: число 300 кодируется как [0xAC, 0x02]
+// - Первый байт: 10101100 (младшие 7 бит: 0101100, MSB=1 продолжение)
+// - Второй байт: 00000010 (младшие 7 бит: 0000010, MSB=0 конец)
+// - Результат: 0000010 0101100 = 300
+
+// Wire types в Protobuf:
+// 0: Varint (int32, int64, bool, enum)
+// 1: 64-bit (fixed64, double)
+// 2: Length-delimited (string, bytes, embedded messages, repeated)
+// 5: 32-bit (fixed32, float)
+
+// ============================================
+// 📌 MessagePack
+// ============================================
+
+#include <cstdint>
+
+// MessagePack - бинарная альтернатива JSON
+class MessagePack {
+public:
+    // Сериализация целого числа
+    static std::vector<uint8_t> pack_int(int64_t value) {
+        std::vector<uint8_t> result;
+        
+        if (value >= 0 && value <= 127) {
+            // positive fixint
+            result.push_back(static_cast<uint8_t>(value));
+        }
+        else if (value >= -32 && value < 0) {
+            // negative fixint
+            result.push_back(static_cast<uint8_t>(value));
+        }
+        else if (value >= 0 && value <= UINT8_MAX) {
+            result.push_back(0xcc);  // uint 8
+            result.push_back(static_cast<uint8_t>(value));
+        }
+        else if (value >= INT8_MIN && value <= INT8_MAX) {
+            result.push_back(0xd0);  // int 8
+            result.push_back(static_cast<uint8_t>(value));
+        }
+        // ... другие размеры (16, 32, 64 bit)
+        
+        return result;
+    }
+    
+    // Сериализация строки
+    static std::vector<uint8_t> pack_string(const std::string& str) {
+        std::vector<uint8_t> result;
+        
+        if (str.size() <= 31) {
+            // fixstr
+            result.push_back(0xa0 | static_cast<uint8_t>(str.size()));
+        }
+        else if (str.size() <= UINT8_MAX) {
+            // str 8
+            result.push_back(0xd9);
+            result.push_back(static_cast<uint8_t>(str.size()));
+        }
+        else if (str.size() <= UINT16_MAX) {
+            // str 16
+            result.push_back(0xda);
+            result.push_back(static_cast<uint8_t>(str.size() >> 8));
+            result.push_back(static_cast<uint8_t>(str.size() & 0xFF));
+        }
+        
+        result.insert(result.end(), str.begin(), str.end());
+        return result;
+    }
+    
+    // Сериализация массива
+    static std::vector<uint8_t> pack_array_header(size_t size) {
+        std::vector<uint8_t> result;
+        
+        if (size <= 15) {
+            // fixarray
+            result.push_back(0x90 | static_cast<uint8_t>(size));
+        }
+        else if (size <= UINT16_MAX) {
+            // array 16
+            result.push_back(0xdc);
+            result.push_back(static_cast<uint8_t>(size >> 8));
+            result.push_back(static_cast<uint8_t>(size & 0xFF));
+        }
+        
+        return result;
+    }
+};
+
+void messagepack_example() {
+    // Пример: ["hello", 42, true]
+    std::vector<uint8_t> packed;
+    
+    // Заголовок массива (3 элемента)
+    auto header = MessagePack::pack_array_header(3);
+    packed.insert(packed.end(), header.begin(), header.end());
+    
+    // Строка "hello"
+    auto str = MessagePack::pack_string("hello");
+    packed.insert(packed.end(), str.begin(), str.end());
+    
+    // Число 42
+    auto num = MessagePack::pack_int(42);
+    packed.insert(packed.end(), num.begin(), num.end());
+    
+    // Bool true
+    packed.push_back(0xc3);
+    
+    std::cout << "MessagePack размер: " << packed.size() << " bytes\n";
+    
+    // MessagePack более компактен чем JSON:
+    // JSON: ["hello", 42, true] = 20 bytes
+    // MessagePack: [0x93, 0xa5, 'h','e','l','l','o', 0x2a, 0xc3] = 9 bytes
+}
+
+// ============================================
+// 📌 MessagePack: полная спецификация
+// ============================================
+
+// Класс выше - иллюстрация формата: часть размеров целых не реализована,
+// а каждый pack_* возвращает новый std::vector, который потом копируется в итоговый.
+//
+// msgpack::Packer - вся спецификация (nil/bool/int/uint/float/str/bin/array/map/ext/
+// timestamp), запись в ОДИН растущий буфер, переиспользуемый между сообщениями.
+// msgpack::Reader - потоковый разбор на месте: строки и bin - view в исходный буфер,
+// массивы/карты отдают только количество элементов, дети идут следом.
+
+#include <utility>
+
+namespace msgpack {
+
+inline void store_be(uint8_t* p, uint64_t v, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) p[i] = static_cast<uint8_t>(v >> (8 * (bytes - 1 - i)));
+}
+
+inline uint64_t load_be(const uint8_t* p, size_t bytes) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < bytes; ++i) v = (v << 8) | p[i];
+    return v;
+}
+
+constexpr int8_t TIMESTAMP_EXT = -1;
+
+class Packer {
+    std::vector<uint8_t> buf_;
+
+public:
+    explicit Packer(size_t reserve = 4096) { buf_.reserve(reserve); }
+
+    void clear() { buf_.clear(); }  // Ёмкость сохраняется
+    std::span<const uint8_t> data() const { return buf_; }
+
+    void pack_nil() { byte(0xc0); }
+    void pack_bool(bool v) { byte(v ? 0xc3 : 0xc2); }
+
+    void pack_uint(uint64_t v) {
+        if (v <= 0x7f) byte(static_cast<uint8_t>(v));          // positive fixint
+        else if (v <= UINT8_MAX) head(0xcc, v, 1);
+        else if (v <= UINT16_MAX) head(0xcd, v, 2);
+        else if (v <= UINT32_MAX) head(0xce, v, 4);
+        else head(0xcf, v, 8);
+    }
+
+    void pack_int(int64_t v) {
+        if (v >= 0) return pack_uint(static_cast<uint64_t>(v));  // Кратчайшая форма
+        if (v >= -32) byte(static_cast<uint8_t>(v));             // negative fixint
+        else if (v >= INT8_MIN) head(0xd0, static_cast<uint64_t>(v), 1);
+        else if (v >= INT16_MIN) head(0xd1, static_cast<uint64_t>(v), 2);
+        else if (v >= INT32_MIN) head(0xd2, static_cast<uint64_t>(v), 4);
+        else head(0xd3, static_cast<uint64_t>(v), 8);
+    }
+
+    void pack_float(float v) { head(0xca, std::bit_cast<uint32_t>(v), 4); }
+    void pack_double(double v) { head(0xcb, std::bit_cast<uint64_t>(v), 8); }
+
+    void pack_str(std::string_view s) {
+        size_t n = s.size();
+        if (n <= 31) byte(static_cast<uint8_t>(0xa0 | n));
+        else if (n <= UINT8_MAX) head(0xd9, n, 1);
+        else if (n <= UINT16_MAX) head(0xda, n, 2);
+        else head(0xdb, n, 4);
+        append(s.data(), n);
+    }
+
+    void pack_bin(std::span<const uint8_t> b) {
+        size_t n = b.size();
+        if (n <= UINT8_MAX) head(0xc4, n, 1);
+        else if (n <= UINT16_MAX) head(0xc5, n, 2);
+        else head(0xc6, n, 4);
+        append(b.data(), n);
+    }
+
+    void pack_array(uint32_t n) {
+        if (n <= 15) byte(static_cast<uint8_t>(0x90 | n));
+        else if (n <= UINT16_MAX) head(0xdc, n, 2);
+        else head(0xdd, n, 4);
+    }
+
+    void pack_map(uint32_t n) {
+        if (n <= 15) byte(static_cast<uint8_t>(0x80 | n));
+        else if (n <= UINT16_MAX) head(0xde, n, 2);
+        else head(0xdf, n, 4);
+    }
+
+    void pack_ext(int8_t type, std::span<const uint8_t> payload) {
+        size_t n = payload.size();
+        switch (n) {
+            case 1: byte(0xd4); break;   // fixext 1
+            case 2: byte(0xd5); break;
+            case 4: byte(0xd6); break;
+            case 8: byte(0xd7); break;
+            case 16: byte(0xd8); break;
+            default:
+                if (n <= UINT8_MAX) head(0xc7, n, 1);
+                else if (n <= UINT16_MAX) head(0xc8, n, 2);
+                else head(0xc9, n, 4);
+        }
+        byte(static_cast<uint8_t>(type));
+        append(payload.data(), n);
+    }
+
+    // Timestamp extension (type -1): 32/64/96-битная форма - самая короткая подходящая
+    void pack_timestamp(int64_t seconds, uint32_t nanoseconds = 0) {
+        uint8_t payload[12];
+        if ((seconds >> 34) == 0) {
+            uint64_t data64 = (uint64_t(nanoseconds) << 34) | uint64_t(seconds);
+            if ((data64 & 0xffffffff00000000ull) == 0) {
+                store_be(payload, data64, 4);
+                return pack_ext(TIMESTAMP_EXT, {payload, 4});
+            }
+            store_be(payload, data64, 8);
+            return pack_ext(TIMESTAMP_EXT, {payload, 8});
+        }
+        store_be(payload, nanoseconds, 4);
+        store_be(payload + 4, static_cast<uint64_t>(seconds), 8);
+        pack_ext(TIMESTAMP_EXT, {payload, 12});
+    }
+
+    // ---------- Типизированный pack ----------
+
+    void pack(std::nullptr_t) { pack_nil(); }
+    void pack(bool v) { pack_bool(v); }
+    void pack(float v) { pack_float(v); }
+    void pack(double v) { pack_double(v); }
+    void pack(std::string_view s) { pack_str(s); }
+    void pack(const char* s) { pack_str(s); }
+    void pack(const std::string& s) { pack_str(s); }
+
+    template <typename T>
+        requires(std::integral<T> && !std::same_as<T, bool>)
+    void pack(T v) {
+        if constexpr (std::is_signed_v<T>) pack_int(v);
+        else pack_uint(v);
+    }
+
+    template <typename T>
+    void pack(const std::optional<T>& v) {
+        if (v) pack(*v);
+        else pack_nil();
+    }
+
+    void pack(const std::vector<uint8_t>& bytes) { pack_bin(bytes); }
+
+    template <std::ranges::sized_range R>
+        requires(!std::convertible_to<const R&, std::string_view>)
+    void pack(const R& range) {
+        pack_array(static_cast<uint32_t>(std::ranges::size(range)));
+        for (const auto& item : range) pack(item);
+    }
+
+    // Отражённая структура - карта {имя поля: значение}, как в JSON
+    template <reflect::Reflected T>
+    void pack(const T& obj) {
+        pack_map(static_cast<uint32_t>(std::tuple_size_v<decltype(T::fields())>));
+        reflect::for_each_field(obj, [&](std::string_view name, const auto& value) {
+            pack_str(name);
+            pack(value);
+        });
+    }
+
+    void pack(const JSON& json) {
+        std::visit([&](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, JSON::Object>) {
+                pack_map(static_cast<uint32_t>(v.size()));
+                for (const auto& [k, item] : v) {
+                    pack_str(k);
+                    pack(item);
+                }
+            } else {
+                pack(v);
+            }
+        }, json.value());
+    }
+
+private:
+    // Одна проверка ёмкости на значение, а не на каждый байт
+    uint8_t* grow(size_t n) {
+        size_t old = buf_.size();
+        buf_.resize(old + n);
+        return buf_.data() + old;
+    }
+
+    void byte(uint8_t b) { buf_.push_back(b); }
+
+    void head(uint8_t marker, uint64_t v, size_t bytes) {
+        uint8_t* p = grow(1 + bytes);
+        p[0] = marker;
+        store_be(p + 1, v, bytes);
+    }
+
+    void append(const void* data, size_t n) {
+        if (n) std::memcpy(grow(n), data, n);
+    }
+};
+
+enum class Type : uint8_t { Nil, Bool, Int, Uint, Float, Double, Str, Bin, Array, Map, Ext, Timestamp };
+
+// Один элемент потока. Для Str/Bin/Ext - view в исходный буфер
+struct Item {
+    Type type = Type::Nil;
+    bool boolean = false;
+    int64_t i = 0;
+    uint64_t u = 0;
+    double f = 0;
+    uint32_t count = 0;                 // Array / Map: число элементов (пар)
+    int8_t ext_type = 0;
+    std::string_view str;
+    std::span<const uint8_t> bin;       // Bin / Ext payload
+    int64_t seconds = 0;                // Timestamp
+    uint32_t nanoseconds = 0;
+};
+
+class Reader {
+    const uint8_t* p_;
+    const uint8_t* end_;
+    bool error_ = false;
+
+public:
+    explicit Reader(std::span<const uint8_t> data) : p_(data.data()), end_(data.data() + data.size()) {}
+
+    bool at_end() const { return p_ == end_; }
+    bool error() const { return error_; }
+    size_t remaining() const { return end_ - p_; }
+
+    // Следующий элемент; false - конец данных или ошибка (см. error())
+    bool next(Item& it) {
+        if (p_ >= end_ || error_) return false;
+        uint8_t m = *p_++;
+
+        if (m <= 0x7f) { it.type = Type::Uint; it.u = m; it.i = m; return true; }
+        if (m >= 0xe0) { it.type = Type::Int; it.i = static_cast<int8_t>(m); return true; }
+        if ((m & 0xe0) == 0xa0) return str(it, m & 0x1f);
+        if ((m & 0xf0) == 0x90) { it.type = Type::Array; it.count = m & 0x0f; return true; }
+        if ((m & 0xf0) == 0x80) { it.type = Type::Map; it.count = m & 0x0f; return true; }
+
+        uint64_t v;
+        switch (m) {
+            case 0xc0: it.type = Type::Nil; return true;
+            case 0xc2: case 0xc3: it.type = Type::Bool; it.boolean = (m == 0xc3); return true;
+
+            case 0xcc: case 0xcd: case 0xce: case 0xcf:
+                if (!load(v, size_t(1) << (m - 0xcc))) return false;
+                it.type = Type::Uint;
+                it.u = v;
+                it.i = static_cast<int64_t>(v);
+                return true;
+
+            case 0xd0: case 0xd1: case 0xd2: case 0xd3: {
+                size_t n = size_t(1) << (m - 0xd0);
+                if (!load(v, n)) return false;
+                int shift = 64 - int(n * 8);  // Знаковое расширение
+                it.type = Type::Int;
+                it.i = shift ? static_cast<int64_t>(v << shift) >> shift : static_cast<int64_t>(v);
+                return true;
+            }
+
+            case 0xca:
+                if (!load(v, 4)) return false;
+                it.type = Type::Float;
+                it.f = std::bit_cast<float>(static_cast<uint32_t>(v));
+                return true;
+            case 0xcb:
+                if (!load(v, 8)) return false;
+                it.type = Type::Double;
+                it.f = std::bit_cast<double>(v);
+                return true;
+
+            case 0xd9: case 0xda: case 0xdb:
+                if (!load(v, size_t(1) << (m - 0xd9))) return false;
+                return str(it, v);
+
+            case 0xc4: case 0xc5: case 0xc6:
+                if (!load(v, size_t(1) << (m - 0xc4))) return false;
+                if (!take(it.bin, v)) return false;
+                it.type = Type::Bin;
+                return true;
+
+            case 0xdc: case 0xdd:
+                if (!load(v, m == 0xdc ? 2 : 4)) return false;
+                it.type = Type::Array;
+                it.count = static_cast<uint32_t>(v);
+                return true;
+            case 0xde: case 0xdf:
+                if (!load(v, m == 0xde ? 2 : 4)) return false;
+                it.type = Type::Map;
+                it.count = static_cast<uint32_t>(v);
+                return true;
+
+            case 0xd4: case 0xd5: case 0xd6: case 0xd7: case 0xd8:
+                return ext(it, size_t(1) << (m - 0xd4));
+            case 0xc7: case 0xc8: case 0xc9:
+                if (!load(v, size_t(1) << (m - 0xc7))) return false;
+                return ext(it, v);
+
+            default:  // 0xc1 - never used
+                return fail();
+        }
+    }
+
+    // Пропуск значения вместе со всеми детьми (без рекурсии)
+    bool skip() {
+        uint64_t pending = 1;
+        Item it;
+        while (pending > 0) {
+            if (!next(it)) return fail();
+            --pending;
+            if (it.type == Type::Array) pending += it.count;
+            else if (it.type == Type::Map) pending += uint64_t(it.count) * 2;
+        }
+        return true;
+    }
+
+    // ---------- Типизированный unpack ----------
+
+    bool unpack(bool& v) {
+        Item it;
+        if (!next(it) || it.type != Type::Bool) return fail();
+        v = it.boolean;
+        return true;
+    }
+
+    template <typename T>
+        requires(std::integral<T> && !std::same_as<T, bool>)
+    bool unpack(T& v) {
+        Item it;
+        if (!next(it) || (it.type != Type::Int && it.type != Type::Uint)) return fail();
+        if (it.type == Type::Uint ? !std::in_range<T>(it.u) : !std::in_range<T>(it.i)) return fail();
+        v = it.type == Type::Uint ? static_cast<T>(it.u) : static_cast<T>(it.i);
+        return true;
+    }
+
+    template <std::floating_point T>
+    bool unpack(T& v) {
+        Item it;
+        if (!next(it)) return fail();
+        switch (it.type) {
+            case Type::Float: case Type::Double: v = static_cast<T>(it.f); return true;
+            case Type::Int: v = static_cast<T>(it.i); return true;
+            case Type::Uint: v = static_cast<T>(it.u); return true;
+            default: return fail();
+        }
+    }
+
+    // Zero-copy: view живёт, пока жив исходный буфер
+    bool unpack(std::string_view& v) {
+        Item it;
+        if (!next(it) || it.type != Type::Str) return fail();
+        v = it.str;
+        return true;
+    }
+
+    bool unpack(std::string& v) {
+        std::string_view view;
+        if (!unpack(view)) return false;
+        v.assign(view);
+        return true;
+    }
+
+    template <typename T>
+    bool unpack(std::optional<T>& v) {
+        if (p_ < end_ && *p_ == 0xc0) {
+            ++p_;
+            v.reset();
+            return true;
+        }
+        return unpack(v.emplace());
+    }
+
+    bool unpack(std::vector<uint8_t>& v) {
+        Item it;
+        if (!next(it) || it.type != Type::Bin) return fail();
+        v.assign(it.bin.begin(), it.bin.end());
+        return true;
+    }
+
+    template <typename T>
+    bool unpack(std::vector<T>& v) {
+        Item it;
+        if (!next(it) || it.type != Type::Array || it.count > remaining()) return fail();
+        v.resize(it.count);
+        for (auto& item : v) {
+            if (!unpack(item)) return false;
+        }
+        return true;
+    }
+
+    // Карта → поля по имени; незнакомые ключи пропускаются (эволюция схемы)
+    template <reflect::Reflected T>
+    bool unpack(T& obj) {
+        Item it;
+        if (!next(it) || it.type != Type::Map) return fail();
+
+        for (uint32_t i = 0; i < it.count; ++i) {
+            std::string_view key;
+            if (!unpack(key)) return false;
+
+            bool matched = false;
+            bool ok = true;
+            reflect::for_each_field(obj, [&](std::string_view name, auto& value) {
+                if (!matched && name == key) {
+                    matched = true;
+                    ok = unpack(value);
+                }
+            });
+            if (!ok) return false;
+            if (!matched && !skip()) return false;
+        }
+        return true;
+    }
+
+private:
+    bool fail() {
+        error_ = true;
+        return false;
+    }
+
+    bool load(uint64_t& v, size_t bytes) {
+        if (static_cast<size_t>(end_ - p_) < bytes) return fail();
+        v = load_be(p_, bytes);
+        p_ += bytes;
+        return true;
+    }
+
+    bool take(std::span<const uint8_t>& out, uint64_t n) {
+        if (static_cast<uint64_t>(end_ - p_) < n) return fail();
+        out = {p_, static_cast<size_t>(n)};
+        p_ += n;
+        return true;
+    }
+
+    bool str(Item& it, uint64_t n) {
+        std::span<const uint8_t> bytes;
+        if (!take(bytes, n)) return false;
+        it.type = Type::Str;
+        it.str = {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+        return true;
+    }
+
+    bool ext(Item& it, uint64_t n) {
+        if (p_ >= end_) return fail();
+        it.ext_type = static_cast<int8_t>(*p_++);
+        if (!take(it.bin, n)) return false;
+        it.type = Type::Ext;
+
+        if (it.ext_type == TIMESTAMP_EXT) {
+            const uint8_t* d = it.bin.data();
+            if (n == 4) {
+                it.seconds = static_cast<int64_t>(load_be(d, 4));
+                it.nanoseconds = 0;
+            } else if (n == 8) {
+                uint64_t data64 = load_be(d, 8);
+                it.nanoseconds = static_cast<uint32_t>(data64 >> 34);
+                it.seconds = static_cast<int64_t>(data64 & 0x3ffffffffull);
+            } else if (n == 12) {
+                it.nanoseconds = static_cast<uint32_t>(load_be(d, 4));
+                it.seconds = static_cast<int64_t>(load_be(d + 4, 8));
+            } else {
+                return fail();
+            }
+            it.type = Type::Timestamp;
+        }
+        return true;
+    }
+};
+
+} // namespace msgpack
+
+void messagepack_full_example() {
+    msgpack::Packer packer;
+
+    // {"id": 7, "name": "sensor", "raw": <bin>, "at": <timestamp>, "values": [-1, 70000, 3.5]}
+    packer.pack_map(5);
+    packer.pack_str("id");
+    packer.pack_uint(7);
+    packer.pack_str("name");
+    packer.pack_str("sensor");
+    packer.pack_str("raw");
+    const uint8_t raw[] = {0xde, 0xad, 0xbe, 0xef};
+    packer.pack_bin(raw);
+    packer.pack_str("at");
+    packer.pack_timestamp(1'700'000'000, 123'000'000);
+    packer.pack_str("values");
+    packer.pack_array(3);
+    packer.pack_int(-1);
+    packer.pack_int(70000);
+    packer.pack_double(3.5);
+
+    std::cout << "MessagePack: " << packer.data().size() << " bytes\n";
+
+    // Потоковый обход на месте
+    msgpack::Reader reader(packer.data());
+    msgpack::Item it;
+    while (reader.next(it)) {
+        switch (it.type) {
+            case msgpack::Type::Str: std::cout << "str " << it.str << '\n'; break;
+            case msgpack::Type::Int: std::cout << "int " << it.i << '\n'; break;
+            case msgpack::Type::Uint: std::cout << "uint " << it.u << '\n'; break;
+            case msgpack::Type::Double: std::cout << "double " << it.f << '\n'; break;
+            case msgpack::Type::Bin: std::cout << "bin " << it.bin.size() << " bytes\n"; break;
+            case msgpack::Type::Timestamp:
+                std::cout << "timestamp " << it.seconds << '.' << it.nanoseconds << '\n';
+                break;
+            case msgpack::Type::Map: std::cout << "map " << it.count << '\n'; break;
+            case msgpack::Type::Array: std::cout << "array " << it.count << '\n'; break;
+            default: break;
+        }
+    }
+
+    // Отражённые структуры (Order из JsonWriter) - туда и обратно
+    Order order{42, "Alice", {{"SKU-1", 2, 9.5}}, std::nullopt, true};
+    packer.clear();
+    packer.pack(order);
+
+    Order decoded;
+    msgpack::Reader order_reader(packer.data());
+    if (order_reader.unpack(decoded)) {
+        std::cout << decoded.customer << ": " << decoded.lines.size() << " line(s), "
+                  << packer.data().size() << " bytes\n";
+    }
+}
+
+// ============================================
+// 📌 Binary Serialization (custom)
+// ============================================
+
+#include <cstring>
+
+class BinarySerializer {
+    std::vector<uint8_t> buffer_;
+    
+public:
+    // Запись с учётом endianness (little-endian)
+    void write_uint32(uint32_t value) {
+        buffer_.push_back(static_cast<uint8_t>(value & 0xFF));
+        buffer_.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+        buffer_.push_back(static_cast<uint8_t>((value >> 16) & 0xFF));
+        buffer_.push_back(static_cast<uint8_t>((value >> 24) & 0xFF));
+    }
+    
+    void write_string(const std::string& str) {
+        write_uint32(static_cast<uint32_t>(str.size()));
+        buffer_.insert(buffer_.end(), str.begin(), str.end());
+    }
+    
     // Запись struct с padding awareness
     template<typename T>
     void write_struct(const T& data) {
@@ -676,6 +2834,13 @@ struct MessageHeader {
     uint16_t version;    // Версия протокола
     uint16_t type;       // Тип сообщения
     uint32_t length;     // Длина payload
+
+    static constexpr auto fields() {
+        return std::make_tuple(reflect::field("magic", &MessageHeader::magic),
+                               reflect::field("version", &MessageHeader::version),
+                               reflect::field("type", &MessageHeader::type),
+                               reflect::field("length", &MessageHeader::length));
+    }
 };
 
 void binary_serialization_example() {
@@ -700,10 +2865,926 @@ void binary_serialization_example() {
     std::cout << "Version: " << h.version << '\n';
 }
 
+// ============================================
+// 📌 Reflected Binary Codec
+// ============================================
+
+// BinarySerializer выше (и сетевой вариант в network_basics.cpp):
+// - push_back/insert в std::vector на каждое поле → проверка ёмкости и рост на каждом шаге
+// - структуру приходится сериализовать руками поле за полем, симметрично в двух местах
+//
+// codec:
+// - список полей берётся из T::fields() (reflect::field / codec::varint)
+// - размер фиксированных структур вычисляется при компиляции; для остальных -
+//   одним проходом по переменным полям
+// - encode пишет прямо в span вызывающего: ОДНА проверка размера, дальше запись без проверок
+// - varint (LEB128, знаковые через zigzag) для счётчиков и id, которые обычно малы
+// - версия схемы в MessageHeader: поля с since > версии сообщения остаются по умолчанию,
+//   хвост неизвестных новых полей пропускается по length
+
+#include <algorithm>
+#include <limits>
+
+namespace codec {
+
+using reflect::Encoding;
+
+constexpr uint32_t MAGIC = 0xDEADBEEF;
+
+// Поле, кодируемое varint
+template <typename Class, typename T>
+constexpr reflect::Field<Class, T, Encoding::Varint> varint(std::string_view name, T Class::* member,
+                                                            uint16_t since = 1) {
+    static_assert(std::is_integral_v<T>, "varint only for integers");
+    return {name, member, since};
+}
+
+template <typename T> struct is_vector : std::false_type {};
+template <typename T, typename A> struct is_vector<std::vector<T, A>> : std::true_type {};
+template <typename T> struct is_array : std::false_type {};
+template <typename T, size_t N> struct is_array<std::array<T, N>> : std::true_type {};
+template <typename T> struct is_optional : std::false_type {};
+template <typename T> struct is_optional<std::optional<T>> : std::true_type {};
+
+// ---------- Compile-time layout ----------
+
+template <typename T, Encoding E = Encoding::Fixed>
+struct Layout;
+
+template <typename Fields>
+struct FieldsLayout;
+
+template <typename... F>
+struct FieldsLayout<std::tuple<F...>> {
+    static constexpr bool fixed =
+        (Layout<typename F::value_type, F::encoding>::fixed && ...);
+    static constexpr size_t size = fixed ? (Layout<typename F::value_type, F::encoding>::size + ... + 0) : 0;
+};
+
+template <typename T, Encoding E>
+struct Layout {
+    static constexpr bool fixed = [] {
+        if constexpr (E == Encoding::Varint) return false;
+        else if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>) return true;
+        else if constexpr (is_array<T>::value) return Layout<typename T::value_type>::fixed;
+        else if constexpr (reflect::Reflected<T>) return FieldsLayout<decltype(T::fields())>::fixed;
+        else return false;
+    }();
+
+    static constexpr size_t size = [] {
+        if constexpr (!fixed) return size_t{0};
+        else if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>) return sizeof(T);
+        else if constexpr (is_array<T>::value) {
+            return Layout<typename T::value_type>::size * std::tuple_size_v<T>;
+        }
+        else return FieldsLayout<decltype(T::fields())>::size;
+    }();
+};
+
+// Самая новая версия схемы среди полей
+template <reflect::Reflected T>
+constexpr uint16_t max_since() {
+    return std::apply([](const auto&... fld) { return std::max({uint16_t(1), fld.since...}); },
+                      T::fields());
+}
+
+template <typename T>
+inline constexpr bool is_fixed_v = Layout<T>::fixed;
+
+template <typename T>
+inline constexpr size_t fixed_size_v = Layout<T>::size;
+
+// ---------- Примитивы ----------
+
+template <std::endian Order, typename U>
+inline U to_wire(U v) {
+    if constexpr (sizeof(U) == 1 || Order == std::endian::native) return v;
+    else if constexpr (sizeof(U) == 2) return __builtin_bswap16(v);
+    else if constexpr (sizeof(U) == 4) return __builtin_bswap32(v);
+    else return __builtin_bswap64(v);
+}
+
+template <typename T>
+inline auto as_bits(T v) {
+    using U = std::conditional_t<sizeof(T) == 1, uint8_t,
+              std::conditional_t<sizeof(T) == 2, uint16_t,
+              std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+    if constexpr (std::is_enum_v<T>) {
+        return static_cast<U>(static_cast<std::underlying_type_t<T>>(v));
+    } else {
+        return std::bit_cast<U>(v);
+    }
+}
+
+template <typename T>
+inline uint64_t zigzag(T v) {
+    if constexpr (std::is_signed_v<T>) {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(int64_t(v) >> 63);
+    } else {
+        return static_cast<uint64_t>(v);
+    }
+}
+
+template <typename T>
+inline T unzigzag(uint64_t v) {
+    if constexpr (std::is_signed_v<T>) {
+        return static_cast<T>(static_cast<int64_t>((v >> 1) ^ (~(v & 1) + 1)));
+    } else {
+        return static_cast<T>(v);
+    }
+}
+
+inline size_t varint_size(uint64_t v) {
+    // 7 бит на байт: 1 + floor(log2(v) / 7)
+    return 1 + (63 - std::countl_zero(v | 1)) / 7;
+}
+
+inline uint8_t* put_varint(uint8_t* p, uint64_t v) {
+    while (v >= 0x80) {
+        *p++ = static_cast<uint8_t>(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = static_cast<uint8_t>(v);
+    return p;
+}
+
+inline const uint8_t* get_varint(const uint8_t* p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        v |= uint64_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return p;
+    }
+    return nullptr;  // Обрыв или больше 10 байт
+}
+
+// ---------- Размер ----------
+
+template <typename T, Encoding E = Encoding::Fixed>
+size_t encoded_size(const T& v) {
+    if constexpr (Layout<T, E>::fixed) {
+        return Layout<T, E>::size;
+    } else if constexpr (E == Encoding::Varint) {
+        return varint_size(zigzag(v));
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return varint_size(v.size()) + v.size();
+    } else if constexpr (is_optional<T>::value) {
+        return 1 + (v ? encoded_size(*v) : 0);  // Байт присутствия + значение
+    } else if constexpr (is_vector<T>::value || is_array<T>::value) {
+        using Elem = typename T::value_type;
+        size_t total = is_vector<T>::value ? varint_size(v.size()) : 0;
+        if constexpr (Layout<Elem>::fixed) {
+            return total + v.size() * Layout<Elem>::size;
+        } else {
+            for (const auto& item : v) total += encoded_size(item);
+            return total;
+        }
+    } else {
+        static_assert(reflect::Reflected<T>, "Unsupported field type");
+        return std::apply([&](const auto&... fld) {
+            return (encoded_size<typename std::decay_t<decltype(fld)>::value_type,
+                                 std::decay_t<decltype(fld)>::encoding>(v.*fld.member) + ... + 0);
+        }, T::fields());
+    }
+}
+
+// ---------- Запись без проверок (место уже проверено) ----------
+
+template <std::endian Order, Encoding E = Encoding::Fixed, typename T>
+uint8_t* put(uint8_t* p, const T& v) {
+    if constexpr (E == Encoding::Varint) {
+        return put_varint(p, zigzag(v));
+    } else if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>) {
+        auto bits = to_wire<Order>(as_bits(v));
+        std::memcpy(p, &bits, sizeof(bits));
+        return p + sizeof(bits);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        p = put_varint(p, v.size());
+        if (!v.empty()) std::memcpy(p, v.data(), v.size());
+        return p + v.size();
+    } else if constexpr (is_optional<T>::value) {
+        *p++ = v ? 1 : 0;
+        return v ? put<Order>(p, *v) : p;
+    } else if constexpr (is_vector<T>::value || is_array<T>::value) {
+        using Elem = typename T::value_type;
+        if constexpr (is_vector<T>::value) p = put_varint(p, v.size());
+        if constexpr (std::is_arithmetic_v<Elem> && Order == std::endian::native) {
+            // Массив чисел - одним куском (у пустого vector data() может быть nullptr)
+            if (!v.empty()) std::memcpy(p, v.data(), v.size() * sizeof(Elem));
+            return p + v.size() * sizeof(Elem);
+        } else {
+            for (const auto& item : v) p = put<Order>(p, item);
+            return p;
+        }
+    } else {
+        std::apply([&](const auto&... fld) {
+            ((p = put<Order, std::decay_t<decltype(fld)>::encoding>(p, v.*fld.member)), ...);
+        }, T::fields());
+        return p;
+    }
+}
+
+// ---------- Чтение ----------
+// Фиксированные структуры проверяются один раз целиком; переменные части
+// (строки, векторы, varint) - каждая по своей длине. nullptr - ошибка
+
+template <std::endian Order, Encoding E = Encoding::Fixed, typename T>
+const uint8_t* get(const uint8_t* p, const uint8_t* end, T& v, uint16_t version);
+
+template <std::endian Order, typename T>
+const uint8_t* get_fixed(const uint8_t* p, T& v) {
+    if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>) {
+        decltype(as_bits(v)) bits;
+        std::memcpy(&bits, p, sizeof(bits));
+        bits = to_wire<Order>(bits);
+        if constexpr (std::is_enum_v<T>) v = static_cast<T>(bits);
+        else v = std::bit_cast<T>(bits);
+        return p + sizeof(bits);
+    } else if constexpr (is_array<T>::value) {
+        for (auto& item : v) p = get_fixed<Order>(p, item);
+        return p;
+    } else {
+        std::apply([&](const auto&... fld) {
+            ((p = get_fixed<Order>(p, v.*fld.member)), ...);
+        }, T::fields());
+        return p;
+    }
+}
+
+template <std::endian Order, Encoding E, typename T>
+const uint8_t* get(const uint8_t* p, const uint8_t* end, T& v, uint16_t version) {
+    if constexpr (E == Encoding::Varint) {
+        uint64_t raw;
+        if (!(p = get_varint(p, end, raw))) return nullptr;
+        // Не влезает в T (поток от другой схемы или повреждён) - ошибка, а не усечение
+        if constexpr (std::is_signed_v<T>) {
+            int64_t value = unzigzag<int64_t>(raw);
+            if (value < int64_t(std::numeric_limits<T>::min()) || value > int64_t(std::numeric_limits<T>::max())) {
+                return nullptr;
+            }
+            v = static_cast<T>(value);
+        } else {
+            if (raw > uint64_t(std::numeric_limits<T>::max())) return nullptr;
+            v = static_cast<T>(raw);
+        }
+        return p;
+    } else if constexpr (Layout<T>::fixed && !reflect::Reflected<T>) {
+        if (static_cast<size_t>(end - p) < Layout<T>::size) return nullptr;
+        return get_fixed<Order>(p, v);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        uint64_t len;
+        if (!(p = get_varint(p, end, len)) || len > static_cast<size_t>(end - p)) return nullptr;
+        v.assign(reinterpret_cast<const char*>(p), len);
+        return p + len;
+    } else if constexpr (is_optional<T>::value) {
+        if (p >= end || *p > 1) return nullptr;
+        if (*p++ == 0) {
+            v.reset();
+            return p;
+        }
+        return get<Order>(p, end, v.emplace(), version);
+    } else if constexpr (is_vector<T>::value || is_array<T>::value) {
+        using Elem = typename T::value_type;
+        if constexpr (is_vector<T>::value) {
+            uint64_t count;
+            if (!(p = get_varint(p, end, count))) return nullptr;
+            // Каждый элемент занимает хотя бы байт - защита от resize(2^60)
+            if (count > static_cast<size_t>(end - p)) return nullptr;
+            v.resize(count);
+        }
+        if constexpr (std::is_arithmetic_v<Elem> && Order == std::endian::native) {
+            size_t bytes = v.size() * sizeof(Elem);
+            if (bytes > static_cast<size_t>(end - p)) return nullptr;
+            if (bytes) std::memcpy(v.data(), p, bytes);
+            return p + bytes;
+        } else {
+            for (auto& item : v) {
+                if (!(p = get<Order>(p, end, item, version))) return nullptr;
+            }
+            return p;
+        }
+    } else {
+        static_assert(reflect::Reflected<T>, "Unsupported field type");
+        if constexpr (Layout<T>::fixed) {
+            // Все поля есть в потоке - фиксированный layout, одна проверка на всю структуру
+            if (version >= max_since<T>()) {
+                if (static_cast<size_t>(end - p) < Layout<T>::size) return nullptr;
+                return get_fixed<Order>(p, v);
+            }
+        }
+        std::apply([&](const auto&... fld) {
+            auto one = [&](const auto& f) {
+                using F = std::decay_t<decltype(f)>;
+                // Поле новее, чем версия отправителя, - его нет в потоке
+                if (!p || f.since > version) return;
+                p = get<Order, F::encoding>(p, end, v.*f.member, version);
+            };
+            (one(fld), ...);
+        }, T::fields());
+        return p;
+    }
+}
+
+// ---------- API ----------
+
+// Возвращает число записанных байт; 0 - не хватило места (ничего не записано)
+template <std::endian Order = std::endian::little, typename T>
+size_t encode(std::span<uint8_t> out, const T& value) {
+    size_t need = encoded_size(value);
+    if (need > out.size()) return 0;
+    return put<Order>(out.data(), value) - out.data();
+}
+
+template <std::endian Order = std::endian::little, typename T>
+bool decode(std::span<const uint8_t> in, T& value, uint16_t version = T::schema_version) {
+    return get<Order>(in.data(), in.data() + in.size(), value, version) != nullptr;
+}
+
+// Сообщение = MessageHeader{MAGIC, T::schema_version, T::message_type, length} + payload
+template <std::endian Order = std::endian::little, typename T>
+size_t encode_message(std::span<uint8_t> out, const T& msg) {
+    size_t payload = encoded_size(msg);
+    size_t need = fixed_size_v<MessageHeader> + payload;
+    if (need > out.size()) return 0;
+
+    MessageHeader header{MAGIC, T::schema_version, T::message_type, static_cast<uint32_t>(payload)};
+    uint8_t* p = put<Order>(out.data(), header);
+    p = put<Order>(p, msg);
+    return p - out.data();
+}
+
+// Заголовок без разбора тела - роутер решает по type, куда отдать сообщение
+template <std::endian Order = std::endian::little>
+std::optional<MessageHeader> peek_header(std::span<const uint8_t> in) {
+    MessageHeader header;
+    if (!get<Order>(in.data(), in.data() + in.size(), header, 1)) return std::nullopt;
+    if (header.magic != MAGIC) return std::nullopt;
+    if (header.length > in.size() - fixed_size_v<MessageHeader>) return std::nullopt;
+    return header;
+}
+
+// Возвращает полный размер сообщения (можно сдвинуть буфер), 0 - ошибка
+template <std::endian Order = std::endian::little, typename T>
+size_t decode_message(std::span<const uint8_t> in, T& msg) {
+    auto header = peek_header<Order>(in);
+    if (!header || header->type != T::message_type) return 0;
+
+    const uint8_t* body = in.data() + fixed_size_v<MessageHeader>;
+    // Поля новее нашей версии (отправитель новее) лежат в хвосте - просто не читаем их
+    if (!get<Order>(body, body + header->length, msg, header->version)) return 0;
+    return fixed_size_v<MessageHeader> + header->length;
+}
+
+} // namespace codec
+
+static_assert(codec::is_fixed_v<MessageHeader> && codec::fixed_size_v<MessageHeader> == 12);
+
+struct Quote {
+    static constexpr uint16_t schema_version = 2;
+    static constexpr uint16_t message_type = 7;
+
+    uint64_t instrument_id = 0;
+    double bid = 0;
+    double ask = 0;
+    uint32_t bid_size = 0;
+    uint32_t ask_size = 0;
+    int64_t sequence = 0;           // varint: дельты/счётчики обычно малы
+    std::string venue;
+    std::vector<uint32_t> flags;
+    uint8_t condition = 0;          // Добавлено в версии 2
+
+    static constexpr auto fields() {
+        return std::make_tuple(reflect::field("instrument_id", &Quote::instrument_id),
+                               reflect::field("bid", &Quote::bid),
+                               reflect::field("ask", &Quote::ask),
+                               reflect::field("bid_size", &Quote::bid_size),
+                               reflect::field("ask_size", &Quote::ask_size),
+                               codec::varint("sequence", &Quote::sequence),
+                               reflect::field("venue", &Quote::venue),
+                               reflect::field("flags", &Quote::flags),
+                               reflect::field("condition", &Quote::condition, 2));
+    }
+};
+
+void reflected_codec_example() {
+    Quote quote{42, 101.25, 101.5, 300, 500, 123456, "XNAS", {1, 4}, 3};
+
+    std::array<uint8_t, 256> buffer;  // Например, prepare() выходного кольца
+    size_t n = codec::encode_message(buffer, quote);
+    std::cout << "Quote: " << n << " bytes (header " << codec::fixed_size_v<MessageHeader> << ")\n";
+
+    // Роутер смотрит только в заголовок
+    if (auto header = codec::peek_header(std::span<const uint8_t>(buffer.data(), n))) {
+        std::cout << "type=" << header->type << " version=" << header->version << '\n';
+    }
+
+    Quote decoded;
+    if (codec::decode_message(std::span<const uint8_t>(buffer.data(), n), decoded)) {
+        std::cout << decoded.venue << ' ' << decoded.bid << '/' << decoded.ask
+                  << " seq=" << decoded.sequence << '\n';
+    }
+
+    // Тот же формат в сетевом порядке байт (как BinarySerializer в network_basics.cpp)
+    size_t be = codec::encode_message<std::endian::big>(buffer, quote);
+    std::cout << "Big-endian: " << be << " bytes\n";
+}
+
+// ns на сообщение: BinarySerializer/BinaryDeserializer против codec
+void reflected_codec_benchmark() {
+    constexpr int N = 1'000'000;
+    Quote quote{42, 101.25, 101.5, 300, 500, 123456, "XNAS", {1, 4}, 3};
+
+    auto ns_per_op = [](auto&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < N; ++i) fn(i);
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / N;
+    };
+
+    size_t sink = 0;
+
+    // Существующий путь: новый vector на сообщение, push_back на каждое поле
+    std::vector<uint8_t> legacy_bytes;
+    double legacy_encode = ns_per_op([&](int i) {
+        BinarySerializer ser;
+        ser.write_struct(MessageHeader{codec::MAGIC, 2, 7, 0});
+        ser.write_struct(quote.instrument_id + i);
+        ser.write_struct(quote.bid);
+        ser.write_struct(quote.ask);
+        ser.write_uint32(quote.bid_size);
+        ser.write_uint32(quote.ask_size);
+        ser.write_struct(quote.sequence);
+        ser.write_string(quote.venue);
+        ser.write_uint32(static_cast<uint32_t>(quote.flags.size()));
+        for (uint32_t f : quote.flags) ser.write_uint32(f);
+        ser.write_struct(quote.condition);
+        sink += ser.data().size();
+        if (i == 0) legacy_bytes = ser.data();
+    });
+
+    double legacy_decode = ns_per_op([&](int) {
+        BinaryDeserializer des(legacy_bytes.data(), legacy_bytes.size());
+        Quote q;
+        des.read_struct<MessageHeader>();
+        q.instrument_id = des.read_struct<uint64_t>();
+        q.bid = des.read_struct<double>();
+        q.ask = des.read_struct<double>();
+        q.bid_size = des.read_uint32();
+        q.ask_size = des.read_uint32();
+        q.sequence = des.read_struct<int64_t>();
+        q.venue = des.read_string();
+        q.flags.resize(des.read_uint32());
+        for (auto& f : q.flags) f = des.read_uint32();
+        q.condition = des.read_struct<uint8_t>();
+        sink += q.flags.size();
+    });
+
+    // codec: буфер вызывающего, одна проверка размера
+    std::array<uint8_t, 256> buffer;
+    size_t codec_size = 0;
+    double codec_encode = ns_per_op([&](int i) {
+        quote.instrument_id = 42 + i;
+        codec_size = codec::encode_message(buffer, quote);
+        sink += codec_size;
+    });
+
+    Quote decoded;  // Переиспользуем: строка и вектор не перевыделяются
+    double codec_decode = ns_per_op([&](int) {
+        sink += codec::decode_message(std::span<const uint8_t>(buffer.data(), codec_size), decoded);
+    });
+
+    std::cout << "BinarySerializer: " << legacy_bytes.size() << " bytes, encode "
+              << legacy_encode << " ns, decode " << legacy_decode << " ns\n";
+    std::cout << "codec:            " << codec_size << " bytes, encode "
+              << codec_encode << " ns, decode " << codec_decode << " ns\n";
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// ============================================
+// 📌 Zero-Copy Flat Format (offset tables + vtables)
+// ============================================
+
+// BinaryDeserializer::read_string/read_struct и codec::decode всегда копируют
+// сообщение в собственные объекты. Роутеру, которому из ~40 полей нужны 2,
+// это чистые потери. Формат в духе FlatBuffers:
+//
+// [u32 root] ... [table: u32 vtable_pos | поля inline] ... [vtable: u16 size | u16 table_size | u16 offset[slot]...]
+//
+// - ссылки (строки, векторы, вложенные таблицы) - абсолютные u32-смещения от начала буфера
+// - vtable: смещение каждого поля внутри таблицы; 0 - поля нет (значение по умолчанию),
+//   поэтому новые поля добавляются в конец схемы без поломки старых читателей
+// - одинаковые vtable дедуплицируются
+// - читатель работает прямо по mmap-файлу или буферу recv(); каждая ссылка
+//   проверяется на границы при обращении, поле читается memcpy (без требований к выравниванию)
+// - Builder пишет снизу вверх в один буфер: сначала дети (строки, векторы), потом таблица
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace flat {
+
+static_assert(std::endian::native == std::endian::little, "flat format is little-endian on the wire");
+
+template <typename T>
+inline T load(const uint8_t* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+// Ссылка на объект внутри буфера (результат create_*/end_table)
+struct Ref {
+    uint32_t pos = 0;
+};
+
+template <typename T>
+class VectorView {
+    const uint8_t* data_ = nullptr;
+    uint32_t size_ = 0;
+
+public:
+    VectorView() = default;
+    VectorView(const uint8_t* data, uint32_t size) : data_(data), size_(size) {}
+
+    uint32_t size() const { return size_; }
+    T operator[](uint32_t i) const { return load<T>(data_ + size_t(i) * sizeof(T)); }
+};
+
+class Table {
+    std::span<const uint8_t> buf_;
+    uint32_t pos_ = 0;
+    uint32_t vtable_ = 0;
+    uint16_t vtable_size_ = 0;
+    uint16_t table_size_ = 0;
+
+public:
+    Table() = default;
+
+    // Проверка таблицы и её vtable; дальше чтение inline-полей проверяет только table_size
+    static std::optional<Table> at(std::span<const uint8_t> buf, uint32_t pos) {
+        size_t size = buf.size();
+        if (size < 4 || pos > size - 4) return std::nullopt;
+
+        Table t;
+        t.buf_ = buf;
+        t.pos_ = pos;
+        t.vtable_ = load<uint32_t>(buf.data() + pos);
+        if (t.vtable_ > size - 4 || t.vtable_ % 2 != 0) return std::nullopt;
+
+        t.vtable_size_ = load<uint16_t>(buf.data() + t.vtable_);
+        t.table_size_ = load<uint16_t>(buf.data() + t.vtable_ + 2);
+        if (t.vtable_size_ < 4 || t.vtable_size_ % 2 != 0 || t.vtable_size_ > size - t.vtable_) {
+            return std::nullopt;
+        }
+        if (t.table_size_ < 4 || t.table_size_ > size - pos) return std::nullopt;
+        return t;
+    }
+
+    // Смещение поля внутри таблицы; 0 - поля нет
+    uint16_t field_offset(uint16_t slot) const {
+        uint32_t entry = 4 + 2u * slot;
+        if (entry + 2 > vtable_size_) return 0;  // Поле новее, чем схема писателя
+        return load<uint16_t>(buf_.data() + vtable_ + entry);
+    }
+
+    template <typename T>
+    T get(uint16_t slot, T default_value = T{}) const {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+        uint16_t off = field_offset(slot);
+        if (off == 0 || off + sizeof(T) > table_size_) return default_value;
+        return load<T>(buf_.data() + pos_ + off);
+    }
+
+    std::optional<std::string_view> get_string(uint16_t slot) const {
+        auto ref = reference(slot);
+        if (!ref) return std::nullopt;
+        uint32_t len = load<uint32_t>(buf_.data() + *ref);
+        if (len > buf_.size() - *ref - 4) return std::nullopt;
+        return std::string_view(reinterpret_cast<const char*>(buf_.data() + *ref + 4), len);
+    }
+
+    template <typename T>
+    std::optional<VectorView<T>> get_vector(uint16_t slot) const {
+        auto ref = reference(slot);
+        if (!ref) return std::nullopt;
+        uint32_t count = load<uint32_t>(buf_.data() + *ref);
+        if (count > (buf_.size() - *ref - 4) / sizeof(T)) return std::nullopt;
+        return VectorView<T>(buf_.data() + *ref + 4, count);
+    }
+
+    std::optional<Table> get_table(uint16_t slot) const {
+        uint16_t off = field_offset(slot);
+        if (off == 0 || off + 4u > table_size_) return std::nullopt;
+        return at(buf_, load<uint32_t>(buf_.data() + pos_ + off));
+    }
+
+private:
+    // Позиция объекта с u32-длиной в начале; проверено, что длина помещается в буфер
+    std::optional<uint32_t> reference(uint16_t slot) const {
+        uint16_t off = field_offset(slot);
+        if (off == 0 || off + 4u > table_size_) return std::nullopt;
+        uint32_t ref = load<uint32_t>(buf_.data() + pos_ + off);
+        if (buf_.size() < 4 || ref > buf_.size() - 4) return std::nullopt;
+        return ref;
+    }
+};
+
+inline std::optional<Table> root(std::span<const uint8_t> buf) {
+    if (buf.size() < 4) return std::nullopt;
+    return Table::at(buf, load<uint32_t>(buf.data()));
+}
+
+class Builder {
+    std::vector<uint8_t> buf_;
+    std::vector<std::pair<uint16_t, uint16_t>> fields_;  // slot → смещение в таблице
+    std::vector<uint32_t> vtables_;                      // Для дедупликации
+    std::vector<uint16_t> vtable_scratch_;
+    uint32_t table_start_ = 0;
+    bool in_table_ = false;
+
+public:
+    explicit Builder(size_t reserve = 1024) {
+        buf_.reserve(reserve);
+        buf_.resize(4);  // Место под root
+    }
+
+    // Переиспользование между сообщениями без освобождения памяти
+    void clear() {
+        buf_.resize(4);
+        vtables_.clear();
+        in_table_ = false;
+    }
+
+    Ref create_string(std::string_view s) {
+        check_not_in_table();
+        align(4);
+        Ref ref{size()};
+        append<uint32_t>(static_cast<uint32_t>(s.size()));
+        append_bytes(s.data(), s.size());
+        buf_.push_back(0);  // Можно отдавать в C API как const char*
+        return ref;
+    }
+
+    template <typename T>
+    Ref create_vector(std::span<const T> items) {
+        static_assert(std::is_arithmetic_v<T>);
+        check_not_in_table();
+        align(std::max<size_t>(4, alignof(T)));
+        if (sizeof(T) > 4) {
+            // Данные после u32-счётчика должны оказаться выровненными
+            while ((size() + 4) % alignof(T) != 0) buf_.push_back(0);
+        }
+        Ref ref{size()};
+        append<uint32_t>(static_cast<uint32_t>(items.size()));
+        append_bytes(items.data(), items.size_bytes());
+        return ref;
+    }
+
+    void start_table() {
+        check_not_in_table();
+        in_table_ = true;
+        fields_.clear();
+        align(4);
+        table_start_ = size();
+        append<uint32_t>(0);  // vtable_pos - дописывается в end_table
+    }
+
+    // Значение по умолчанию не пишем вовсе: vtable скажет "поля нет"
+    template <typename T>
+    void add(uint16_t slot, T value, T default_value = T{}) {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+        if (value == default_value) return;
+        align(alignof(T));
+        fields_.emplace_back(slot, static_cast<uint16_t>(size() - table_start_));
+        append<T>(value);
+    }
+
+    void add(uint16_t slot, Ref ref) {
+        align(4);
+        fields_.emplace_back(slot, static_cast<uint16_t>(size() - table_start_));
+        append<uint32_t>(ref.pos);
+    }
+
+    Ref end_table() {
+        if (!in_table_) throw std::logic_error("end_table without start_table");
+        in_table_ = false;
+
+        size_t table_size = size() - table_start_;
+        if (table_size > UINT16_MAX) throw std::length_error("flat table too large");
+
+        uint16_t max_slot = 0;
+        for (auto [slot, off] : fields_) max_slot = std::max<uint16_t>(max_slot, slot + 1);
+
+        std::vector<uint16_t>& vtable = vtable_scratch_;
+        vtable.assign(2 + max_slot, 0);
+        vtable[0] = static_cast<uint16_t>(vtable.size() * 2);
+        vtable[1] = static_cast<uint16_t>(table_size);
+        for (auto [slot, off] : fields_) vtable[2 + slot] = off;
+
+        uint32_t vtable_pos = 0;
+        for (uint32_t existing : vtables_) {
+            if (load<uint16_t>(buf_.data() + existing) == vtable[0] &&
+                std::memcmp(buf_.data() + existing, vtable.data(), vtable[0]) == 0) {
+                vtable_pos = existing;
+                break;
+            }
+        }
+        if (vtable_pos == 0) {
+            align(2);
+            vtable_pos = size();
+            append_bytes(vtable.data(), vtable[0]);
+            vtables_.push_back(vtable_pos);
+        }
+
+        std::memcpy(buf_.data() + table_start_, &vtable_pos, 4);
+        return Ref{table_start_};
+    }
+
+    std::span<const uint8_t> finish(Ref root_table) {
+        check_not_in_table();
+        std::memcpy(buf_.data(), &root_table.pos, 4);
+        return buf_;
+    }
+
+private:
+    uint32_t size() const { return static_cast<uint32_t>(buf_.size()); }
+
+    void check_not_in_table() const {
+        // Как и во FlatBuffers: дочерние объекты создаются ДО start_table
+        if (in_table_) throw std::logic_error("nested object inside an open table");
+    }
+
+    void align(size_t alignment) {
+        while (buf_.size() % alignment != 0) buf_.push_back(0);
+    }
+
+    template <typename T>
+    void append(T value) {
+        append_bytes(&value, sizeof(T));
+    }
+
+    void append_bytes(const void* data, size_t n) {
+        size_t old = buf_.size();
+        buf_.resize(old + n);
+        if (n) std::memcpy(buf_.data() + old, data, n);
+    }
+};
+
+} // namespace flat
+
+// Схема маршрутизируемого сообщения (то, что сгенерировал бы flatc):
+// 40 полей, роутеру нужны type и destination
+namespace routed {
+
+enum Slot : uint16_t {
+    TYPE = 0,
+    DESTINATION = 1,
+    METRIC_FIRST = 2,    // 30 x int64
+    LABEL_FIRST = 32,    // 8 x string
+    SLOT_COUNT = 40,
+};
+
+constexpr size_t METRICS = LABEL_FIRST - METRIC_FIRST;
+constexpr size_t LABELS = SLOT_COUNT - LABEL_FIRST;
+
+// Тот же набор полей как обычная структура - для полной десериализации
+struct Message {
+    uint16_t type = 0;
+    std::string destination;
+    std::array<int64_t, METRICS> metrics{};
+    std::array<std::string, LABELS> labels;
+
+    static constexpr auto fields() {
+        return std::make_tuple(reflect::field("type", &Message::type),
+                               reflect::field("destination", &Message::destination),
+                               reflect::field("metrics", &Message::metrics),
+                               reflect::field("labels", &Message::labels));
+    }
+};
+
+class View {
+    flat::Table table_;
+
+    explicit View(flat::Table table) : table_(table) {}
+
+public:
+    static std::optional<View> from(std::span<const uint8_t> buf) {
+        auto t = flat::root(buf);
+        if (!t) return std::nullopt;
+        return View(*t);
+    }
+
+    uint16_t type() const { return table_.get<uint16_t>(TYPE); }
+    std::string_view destination() const { return table_.get_string(DESTINATION).value_or(""); }
+    int64_t metric(size_t i) const { return table_.get<int64_t>(static_cast<uint16_t>(METRIC_FIRST + i)); }
+    std::string_view label(size_t i) const {
+        return table_.get_string(static_cast<uint16_t>(LABEL_FIRST + i)).value_or("");
+    }
+};
+
+inline std::span<const uint8_t> build(flat::Builder& b, const Message& m) {
+    b.clear();
+
+    // Снизу вверх: сначала строки, потом таблица, которая на них ссылается
+    flat::Ref destination = b.create_string(m.destination);
+    std::array<flat::Ref, LABELS> labels;
+    for (size_t i = 0; i < LABELS; ++i) labels[i] = b.create_string(m.labels[i]);
+
+    b.start_table();
+    b.add<uint16_t>(TYPE, m.type);
+    b.add(DESTINATION, destination);
+    for (size_t i = 0; i < METRICS; ++i) b.add<int64_t>(static_cast<uint16_t>(METRIC_FIRST + i), m.metrics[i]);
+    for (size_t i = 0; i < LABELS; ++i) b.add(static_cast<uint16_t>(LABEL_FIRST + i), labels[i]);
+    return b.finish(b.end_table());
+}
+
+} // namespace routed
+
+routed::Message make_routed_message() {
+    routed::Message m;
+    m.type = 12;
+    m.destination = "billing.eu-west";
+    for (size_t i = 0; i < routed::METRICS; ++i) m.metrics[i] = int64_t(i * 1000 + 7);
+    for (size_t i = 0; i < routed::LABELS; ++i) m.labels[i] = "label-value-" + std::to_string(i);
+    return m;
+}
+
+void flat_format_example() {
+    flat::Builder builder;
+    auto bytes = routed::build(builder, make_routed_message());
+    std::cout << "Flat message: " << bytes.size() << " bytes\n";
+
+    // Читаем прямо из mmap-файла, ничего не копируя
+    const char* path = "/tmp/routed.bin";
+    int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return;
+    if (::write(fd, bytes.data(), bytes.size()) != static_cast<ssize_t>(bytes.size())) {
+        ::close(fd);
+        return;
+    }
+
+    void* map = ::mmap(nullptr, bytes.size(), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return;
+
+    std::span<const uint8_t> mapped(static_cast<const uint8_t*>(map), bytes.size());
+    if (auto view = routed::View::from(mapped)) {
+        std::cout << "type=" << view->type() << " destination=" << view->destination()
+                  << " label[3]=" << view->label(3) << '\n';
+    }
+
+    // Повреждённый/обрезанный буфер: отказ, а не чтение за границей
+    auto truncated = routed::View::from(mapped.first(16));
+    std::cout << "Truncated valid: " << truncated.has_value() << '\n';
+
+    ::munmap(map, bytes.size());
+    ::unlink(path);
+}
+
+// Роутер: 2 поля из 40 - flat view против полной десериализации codec
+void flat_router_benchmark() {
+    constexpr int N = 1'000'000;
+    routed::Message message = make_routed_message();
+
+    flat::Builder builder;
+    auto flat_bytes = routed::build(builder, message);
+
+    std::vector<uint8_t> codec_bytes(codec::encoded_size(message));
+    codec::encode(codec_bytes, message);
+
+    auto ns_per_op = [](auto&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < N; ++i) fn();
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / N;
+    };
+
+    size_t routed_count = 0;
+    double flat_ns = ns_per_op([&] {
+        auto view = routed::View::from(flat_bytes);
+        if (view && view->type() == 12 && view->destination().starts_with("billing")) ++routed_count;
+    });
+
+    routed::Message decoded;
+    double decode_ns = ns_per_op([&] {
+        if (codec::decode(std::span<const uint8_t>(codec_bytes), decoded, 1) &&
+            decoded.type == 12 && decoded.destination.starts_with("billing")) {
+            ++routed_count;
+        }
+    });
+
+    double build_ns = ns_per_op([&] { routed::build(builder, message); });
+
+    std::cout << "Flat view (2 of 40 fields): " << flat_ns << " ns, " << flat_bytes.size() << " bytes\n";
+    std::cout << "codec::decode (all fields): " << decode_ns << " ns, " << codec_bytes.size() << " bytes\n";
+    std::cout << "Flat build:                 " << build_ns << " ns (routed " << routed_count << ")\n";
+}
+
 // ============================================
 // 📌 Performance Comparison
 // ============================================
 
+#include <iomanip>
+
 void serialization_performance_comparison() {
     // Сравнение различных форматов:
     
@@ -741,6 +3822,77 @@ void serialization_performance_comparison() {
     // + Максимальная производительность
     // - Менее популярен
     
+    // Замер на одном наборе данных: 1000 заказов (Order из JsonWriter)
+    std::vector<Order> orders;
+    for (int i = 0; i < 1000; ++i) {
+        Order o{uint64_t(100000 + i), "customer " + std::to_string(i), {}, std::nullopt, i % 2 == 0};
+        for (int j = 0; j < 3; ++j) o.lines.push_back({"SKU-" + std::to_string(i * 3 + j), j + 1, 4.99 * (j + 1)});
+        if (i % 3 == 0) o.note = "leave at the door";
+        orders.push_back(std::move(o));
+    }
+
+    constexpr int ROUNDS = 50;
+    auto us_per_round = [](auto&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < ROUNDS; ++r) fn();
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / ROUNDS;
+    };
+    auto row = [](const char* name, size_t bytes, double encode_us, double decode_us) {
+        std::cout << std::left << std::setw(34) << name << std::right << std::setw(9) << bytes
+                  << std::setw(12) << encode_us << std::setw(12) << decode_us << '\n';
+    };
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::left << std::setw(34) << "format (encode / decode)" << std::right
+              << std::setw(9) << "bytes" << std::setw(12) << "enc us" << std::setw(12) << "dec us" << '\n';
+
+    // JSON: DOM + to_string / JSONParser
+    JsonBuffer json;
+    {
+        JsonWriter writer(json);
+        writer.write(orders);
+    }
+    std::string json_text(json.view());
+    JSON dom = JSONParser(json_text).parse();
+    size_t dom_bytes = 0;
+    double dom_encode = us_per_round([&] { dom_bytes = dom.to_string().size(); });
+    double dom_decode = us_per_round([&] { JSON parsed = JSONParser(json_text).parse(); });
+    row("JSON to_string / JSONParser", dom_bytes, dom_encode, dom_decode);
+
+    // JSON: JsonWriter / compact::Document
+    double writer_encode = us_per_round([&] {
+        json.clear();
+        JsonWriter writer(json);
+        writer.write(orders);
+    });
+    compact::Document compact_doc;
+    double compact_decode = us_per_round([&] { compact_doc.parse(json_text); });
+    row("JSON JsonWriter / compact DOM", json.size(), writer_encode, compact_decode);
+
+    // MessagePack: Packer / Reader::unpack в структуры
+    msgpack::Packer packer;
+    double mp_encode = us_per_round([&] {
+        packer.clear();
+        packer.pack(orders);
+    });
+    std::vector<Order> mp_orders;
+    double mp_decode = us_per_round([&] {
+        msgpack::Reader reader(packer.data());
+        reader.unpack(mp_orders);
+    });
+    row("MessagePack Packer / unpack", packer.data().size(), mp_encode, mp_decode);
+
+    // Бинарный: codec (схема в коде, имён полей в потоке нет)
+    std::vector<uint8_t> binary(codec::encoded_size(orders));
+    size_t binary_bytes = 0;
+    double bin_encode = us_per_round([&] { binary_bytes = codec::encode(binary, orders); });
+    std::vector<Order> bin_orders;
+    double bin_decode = us_per_round([&] { codec::decode(std::span<const uint8_t>(binary), bin_orders, 1); });
+    row("Binary codec encode / decode", binary_bytes, bin_encode, bin_decode);
+
+    std::cout << std::defaultfloat << std::setprecision(6);
+    // JSON-декодеры строят DOM, MessagePack и codec заполняют сами структуры Order
+    
     std::cout << "Выбор формата зависит от требований:\n";
     std::cout << "- REST API: JSON\n";
     std::cout << "- Микросервисы: Protocol Buffers\n";